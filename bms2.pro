@@ -17,10 +17,12 @@ TEMPLATE = app
 
 SOURCES += \
     src/bms2.cpp \
-    src/mpeg2/MPEG2Payload.cpp \
     src/mpeg2/MPEG2Packet.cpp \
     src/mpeg2/MPEG2Header.cpp \
     src/mpeg2/MPEG2AdaptationField.cpp \
+    src/mpeg2/MPEG2ClockRecovery.cpp \
+    src/mpeg2/MPEG2BitrateStatistics.cpp \
+    src/mpeg2/MPEG2StreamStatistics.cpp \
     src/mpeg2/PSI/ProgramAssociationTable.cpp \
     src/mpeg2/PSI/ProgramMapTable.cpp \
     src/mpeg2/PSI/NetworkInformationTable.cpp \
@@ -29,8 +31,14 @@ SOURCES += \
     src/mpeg2/PSI/EventInformationTable.cpp \
     src/mpeg2/PSI/Descriptors.cpp \
     src/mpeg2/PSI/TimeOffsetTable.cpp \
+    src/mpeg2/PSI/CRC32.cpp \
+    src/mpeg2/PSI/SectionCache.cpp \
+    src/mpeg2/PSI/TableAssembler.cpp \
+    src/mpeg2/PSI/Arena.cpp \
+    src/mpeg2/PSI/EPGStore.cpp \
     src/mpeg2/PES/PacketElementaryStreamFragment.cpp \
     src/mpeg2/PES/PacketElementaryStream.cpp \
+    src/mpeg2/PES/PacketElementaryStreamAssembler.cpp \
     src/mpeg2/MPEG2PacketStreams.cpp \
     src/mpeg2/MPEG2FileInputIterator.cpp \
     src/mpeg2/MPEG2FileInputStream.cpp \
@@ -40,14 +48,28 @@ SOURCES += \
     src/mpeg2/streams/MPEG2PacketStream.cpp \
     src/mpeg2/streams/MPEG2FileInputStream.cpp \
     src/mpeg2/streams/MPEG2FileInputIterator.cpp \
+    src/mpeg2/streams/MPEG2BlockReader.cpp \
+    src/mpeg2/streams/MPEG2PacketSync.cpp \
+    src/mpeg2/streams/MPEG2MappedInputIterator.cpp \
+    src/mpeg2/streams/MPEG2MappedInputStream.cpp \
     src/mpeg2/streams/MPEG2VideoFileStream.cpp \
-    src/mpeg2/streams/MPEG2AudioFileStream.cpp
+    src/mpeg2/streams/MPEG2AudioFileStream.cpp \
+    src/mpeg2/streams/MPEG2SectionStream.cpp \
+    src/mpeg2/streams/MPEG2Demultiplexer.cpp \
+    src/mpeg2/streams/MPEG2ParallelDemultiplexer.cpp \
+    src/mpeg2/audio/WaveFileWriter.cpp \
+    src/mpeg2/audio/PolyphaseSynthesis.cpp \
+    src/mpeg2/audio/MP2Decoder.cpp \
+    src/threads/ThreadPool.cpp
 
 HEADERS += \
-    src/mpeg2/MPEG2Payload.h \
+    src/mpeg2/MPEG2PacketView.h \
     src/mpeg2/MPEG2Packet.h \
     src/mpeg2/MPEG2Header.h \
     src/mpeg2/MPEG2AdaptationField.h \
+    src/mpeg2/MPEG2ClockRecovery.h \
+    src/mpeg2/MPEG2BitrateStatistics.h \
+    src/mpeg2/MPEG2StreamStatistics.h \
     src/mpeg2/PSI/ProgramAssociationTable.h \
     src/mpeg2/PSI/ProgramMapTable.h \
     src/mpeg2/PSI/NetworkInformationTable.h \
@@ -56,8 +78,14 @@ HEADERS += \
     src/mpeg2/PSI/EventInformationTable.h \
     src/mpeg2/PSI/Descriptors.h \
     src/mpeg2/PSI/TimeOffsetTable.h \
+    src/mpeg2/PSI/CRC32.h \
+    src/mpeg2/PSI/SectionCache.h \
+    src/mpeg2/PSI/TableAssembler.h \
+    src/mpeg2/PSI/Arena.h \
+    src/mpeg2/PSI/EPGStore.h \
     src/mpeg2/PES/PacketElementaryStreamFragment.h \
     src/mpeg2/PES/PacketElementaryStream.h \
+    src/mpeg2/PES/PacketElementaryStreamAssembler.h \
     src/mpeg2/MPEG2PacketStreams.h \
     src/mpeg2/MPEG2InputStream.h \
     src/miscellaneous.h \
@@ -72,6 +100,18 @@ HEADERS += \
     src/mpeg2/streams/MPEG2InputIterator.h \
     src/mpeg2/streams/MPEG2FileInputStream.h \
     src/mpeg2/streams/MPEG2FileInputIterator.h \
+    src/mpeg2/streams/MPEG2BlockReader.h \
+    src/mpeg2/streams/MPEG2PacketSync.h \
+    src/mpeg2/streams/MPEG2MappedInputIterator.h \
+    src/mpeg2/streams/MPEG2MappedInputStream.h \
     src/mpeg2/streams/MPEG2DefaultInputStream.h \
     src/mpeg2/streams/MPEG2VideoFileStream.h \
-    src/mpeg2/streams/MPEG2AudioFileStream.h
+    src/mpeg2/streams/MPEG2AudioFileStream.h \
+    src/mpeg2/streams/MPEG2SectionStream.h \
+    src/mpeg2/streams/MPEG2Demultiplexer.h \
+    src/mpeg2/streams/MPEG2ParallelDemultiplexer.h \
+    src/mpeg2/audio/WaveFileWriter.h \
+    src/mpeg2/audio/PolyphaseSynthesis.h \
+    src/mpeg2/audio/MP2Decoder.h \
+    src/threads/SPSCQueue.h \
+    src/threads/ThreadPool.h
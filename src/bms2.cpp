@@ -35,6 +35,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <set>
+#include <chrono>
 
 #include "mpeg2/PSI/ProgramAssociationTable.h"
 #include "mpeg2/PSI/NetworkInformationTable.h"
@@ -42,103 +43,26 @@
 #include "mpeg2/PSI/TimeOffsetTable.h"
 #include "mpeg2/PSI/EventInformationTable.h"
 #include "mpeg2/PSI/ProgramMapTable.h"
+#include "mpeg2/PSI/TableAssembler.h"
+#include "mpeg2/PSI/EPGStore.h"
 #include "mpeg2/PES/PacketElementaryStream.h"
 #include "mpeg2/streams/MPEG2VideoFileStream.h"
 #include "mpeg2/streams/MPEG2AudioFileStream.h"
 #include "mpeg2/streams/MPEG2FileInputStream.h"
+#include "mpeg2/streams/MPEG2MappedInputStream.h"
+#include "mpeg2/streams/MPEG2SectionStream.h"
+#include "mpeg2/streams/MPEG2Demultiplexer.h"
+#include "mpeg2/streams/MPEG2ParallelDemultiplexer.h"
+#include "threads/ThreadPool.h"
 #include "miscellaneous.h"
 
 using namespace std;
 
-/*
- * Initializes macro which tries to read from the stream PSI table repeatly.
- *
- * @param name Unique name for macro statement.
- * @param is Input stream from which to read.
- * @param limit Maximum number of reading from the stream, if -1 is passed then it is tried to read until end of stream is reached.
- * @param reset_flag When true, then stream is firstly reseted, otherwise continues from the current position.
- */
-#define RECOVERABLE_MPEG2IS_READ_INIT(name, is, limit, reset_flag)                \
-    long _ ## name ## _tries = limit;                                                     \
-    bool _ ## name ## _reset = reset_flag;                                                 \
-    if (reset_flag) {                                                             \
-        is.reset();                                                              \
-    }
-
-/*
- * Body of macro which tries to read from the stream PSI table repeatly.
- *
- * @param name Unique name for macro statement, the same as in the initialization.
- * @param table Table to which to store the PSI table.
- * @param is Input stream from which to read.
- */
-#define RECOVERABLE_MPEG2IS_READ_BEGIN2(name, table, is)                                \
-    try {                                                                        \
-        while (is.current() != is.end()) {                                       \
-            is.readPSITable(table, _ ## name ## _reset);                                   \
-            _ ## name ## _reset = false;                                                  \
-            if (!table) {                                                         \
-                _ ## name ## _tries = (_ ## name ## _tries >= 0)? _ ## name ## _tries - 1 : _ ## name ## _tries;     \
-            } else {                                                             \
-                break;                                                           \
-            }                                                                    \
-        }
-
-/*
- * Body of macro which tries to read from the stream PSI table repeatly.
- *
- * @param name Unique name for macro statement, the same as in the initialization.
- * @param table Table to which to store the PSI table.
- * @param is Input stream from which to read.
- * @param PID PID of the transport stream with the PSI table.
- */
-#define RECOVERABLE_MPEG2IS_READ_BEGIN3(name, table, is, PID)                           \
-    try {                                                                        \
-        while (is.current() != is.end()) {                                       \
-            is.readPSITable(table, PID, _ ## name ## _reset);                              \
-            _ ## name ## _reset = false;                                                  \
-            if (!table) {                                                         \
-                _ ## name ## _tries = (_ ## name ## _tries >= 0)? _ ## name ## _tries - 1 : _ ## name ## _tries;     \
-            } else {                                                             \
-                break;                                                           \
-            }                                                                    \
-        }
-
-/*
- * Finalization of macro which tries to read from the stream PSI table repeatly.
- *
- * @param name Unique name for macro statement, the same as in the initialization.
- * @param table Table to which to store the PSI table.
- * @param is Input stream from which to read.
- * @param err_msg Error message which is printed to stderr, when reading of table fails.
- */
-#define RECOVERABLE_MPEG2IS_READ_END(name, table, is, err_msg)                          \
-    } catch (const exception& error) {                                       \
-        table.reset();                                                            \
-        cerr << "Packet " << is.currentFrameNo() << ": " << err_msg << endl;                                                 \
-        cerr << "Reason: " << error.what() << endl;                              \
-                                                                                 \
-        /* skipping current packet - it may cause this error */                  \
-        if (is.current() != is.end()) {                                          \
-           is.current()++;                                                       \
-        }                                                                        \
-        _ ## name ## _tries = (_ ## name ## _tries >= 0)? _ ## name ## _tries - 1 : _ ## name ## _tries;             \
-        /* limit of maximum number of tries has been reached */                  \
-        if (_ ## name ## _tries == 0) {                                                   \
-            throw runtime_error("Reached maximum number of exception failures"); \
-        }                                                                        \
-    }
-
 /**
  * Size of the auxilary buffer.
  */
 const static int BUFFER_SIZE = 80;
 
-/**
- * Auxilary buffer.
- */
-static char BUFFER[BUFFER_SIZE];
-
 /**
  * Gathers all necessary tables of the stream used for this application
  */
@@ -148,7 +72,7 @@ struct PSITables {
     shared_ptr<ServiceDescriptionTable> SDT;
     shared_ptr<TimeOffsetTable> TOT;
     vector<ProgramMapTable> PMTs;
-    vector<EventInformationTable> EITs;
+    EPGStore EPG;
 };
 
 /**
@@ -166,19 +90,9 @@ struct EventInfo {
     uint16_t id;
     struct tm dateTime;
     struct tm duration;
+    int64_t timestamp;      // start in seconds since 1970, local time
     string eventName;
     string eventText;
-
-    /**
-     * Compares two event structures by its ID and time
-     * @param rhs Second event used for the comparison
-     * @return True if this event is lesser than the passed event
-     */
-    bool operator< (const EventInfo& rhs) const {
-        time_t t1 = mktime(const_cast<tm *>(&dateTime));
-        time_t t2 = mktime(const_cast<tm *>(&rhs.dateTime));
-        return id < rhs.id && t1 < t2;
-    }
 };
 
 /**
@@ -186,6 +100,8 @@ struct EventInfo {
  */
 struct ProgramInfo {
     int PID;
+    uint16_t programNumber;
+    string folder;
     string serviceProvider;
     string serviceName;
     vector<ServiceInfo> services;
@@ -212,111 +128,37 @@ struct MultiplexInfo {
     int networkID;
     shared_ptr<TerrestialDeliveryInfo> delivery;
     vector<ProgramInfo> programs;
+    long processedPackets;
 
     MultiplexInfo() :
-        networkName("(unknown)"), networkID(-1)
+        networkName("(unknown)"), networkID(-1), processedPackets(0)
     {}
 };
 
 /**
- * Reads PSI tables from the stream.
- * @param is Input stream with the MPEG2 packets.
- * @param tables Tables which were read.
- * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ * Options of the application passed on the command line
  */
-int readPSITables(MPEG2FileInputStream &is, PSITables &tables) {
-    static const int MAXNUMBER_OF_FAILURES = 100;
-
-    /* Read PAT */
-    RECOVERABLE_MPEG2IS_READ_INIT(PAT, is, MAXNUMBER_OF_FAILURES, true);
-    RECOVERABLE_MPEG2IS_READ_BEGIN2(PAT, tables.PAT, is);
-        if (!tables.PAT) {
-            cerr << "Unable to locate mandatory PAT table in the transport stream!" << endl;
-            cerr << "Terminating application now due to previous error!" << endl;
-            return EXIT_FAILURE;
-        }
-    RECOVERABLE_MPEG2IS_READ_END(PAT, tables.PAT, is, "Failed to read PAT table due to some internal error!");
-
-    /* Retrieve PID of NIT */
-    uint16_t pidNIT = NetworkInformationTable::NIT_DEFAULT_PID;
-    for (const Program &program : tables.PAT->programs) {
-        if (program.programNum == Program::NIT_PROG_NUM) {
-            pidNIT = program.programPID;
-            break;
-        }
-    }
-
-    /* Read NIT */
-    RECOVERABLE_MPEG2IS_READ_INIT(NIT, is, MAXNUMBER_OF_FAILURES, true);
-    RECOVERABLE_MPEG2IS_READ_BEGIN3(NIT, tables.NIT, is, pidNIT);
-        if (!tables.NIT) {
-            cerr << "Unable to locate SDT table in the transport stream!" << endl;
-        }
-    RECOVERABLE_MPEG2IS_READ_END(NIT, tables.NIT, is, "Failed to read NIT table due to some internal error!");
-
-    /* Read SDT */
-    RECOVERABLE_MPEG2IS_READ_INIT(SDT, is, MAXNUMBER_OF_FAILURES, true);
-    RECOVERABLE_MPEG2IS_READ_BEGIN2(SDT, tables.SDT, is);
-        if (!tables.SDT) {
-            cerr << "Unable to locate SDT table in the transport stream!" << endl;
-        }
-    RECOVERABLE_MPEG2IS_READ_END(SDT, tables.SDT, is, "Failed to read PMT table due to some internal error!");
-
-
-    /* Read TOT */
-    shared_ptr<TimeOffsetTable> TOT;
-    RECOVERABLE_MPEG2IS_READ_INIT(TOT, is, -1, true);
-    while (is.current() != is.end()) {
-        RECOVERABLE_MPEG2IS_READ_BEGIN2(TOT, TOT, is);
-        LocalTimeOffsetDescriptor ltod;
-        /* Read TOT which contains offset information */
-        if (TOT && TOT->descriptors.getSpecificDescriptor(ltod)) {
-            tables.TOT = TOT;
-            break;
-        } else if (!TOT) {
-            cerr << "Unable to locate TOT table!" << endl;
-            continue;
-        }
-        RECOVERABLE_MPEG2IS_READ_END(TOT, TOT, is, "Failed to read TOT table due to some internal error!");
-    }
-
-    /* Read PMT tables */
-    for (const Program &program : tables.PAT->programs) {
-        if (program.programNum != Program::NIT_PROG_NUM) {
-            shared_ptr<ProgramMapTable> PMT;
-            RECOVERABLE_MPEG2IS_READ_INIT(PMT, is, MAXNUMBER_OF_FAILURES, true);
-            RECOVERABLE_MPEG2IS_READ_BEGIN3(PMT, PMT, is, program.programPID);
-                if (PMT) {
-                    tables.PMTs.push_back(*PMT);
-                } else {
-                    cerr << "Unable to locate PMT table with PID " << hex << program.programPID << "!" << endl;
-                    continue;
-                }
-            RECOVERABLE_MPEG2IS_READ_END(PMT, PMT, is, "Failed to read PMT table due to some internal error!");
-        }
-    }
-
-    /* Read EITs */
-    shared_ptr<EventInformationTable> EIT;
-    RECOVERABLE_MPEG2IS_READ_INIT(EIT, is, -1, true);
-    while (is.current() != is.end()) {
-        RECOVERABLE_MPEG2IS_READ_BEGIN2(EIT, EIT, is);
-            if (EIT) {
-                tables.EITs.push_back(*EIT);
-            }
-        RECOVERABLE_MPEG2IS_READ_END(EIT, EIT, is, "Failed to read EIT table due to some internal error!");
-    }
-
-    return EXIT_SUCCESS;
-}
+struct Options {
+    Options() : threads(1), jobs(0), infoOnly(false), maxPackets(0), maxSeconds(0), statsSeconds(1.0) {}
+
+    vector<string> inputs;
+    string listFile;
+    unsigned int threads;
+    unsigned int jobs;
+    bool infoOnly;          // only PSI tables are read until they are complete
+    long maxPackets;        // zero for the whole input
+    double maxSeconds;      // PCR time, zero for the whole input
+    string statsFormat;     // csv or json, empty if the statistics are not saved
+    double statsSeconds;    // width of the time bucket of the statistics
+};
 
 /**
  * Transforms stream string into ASCII string
  * @param streamString Stream string to be transformed.
  * @return ASCII string
  */
-string toAsciiString(string &streamString) {
-    string asciiString(streamString);
+string toAsciiString(const ArenaString &streamString) {
+    string asciiString(streamString.begin(), streamString.end());
 
     asciiString.erase(remove_if(asciiString.begin(), asciiString.end(), [] (const char &character) {
         return character >= (char)0xC0 && character <= (char)0xCF;
@@ -326,75 +168,77 @@ string toAsciiString(string &streamString) {
 }
 
 /**
- * Fills vector with the events loaded from the tables
+ * Compares two events by their local start time
+ * @param lhs First event used for the comparison
+ * @param rhs Second event used for the comparison
+ * @return True if the first event starts sooner
+ */
+bool compareEventTime(const EventInfo &lhs, const EventInfo &rhs) {
+    return lhs.timestamp < rhs.timestamp;
+}
+
+/**
+ * Fills vector with the events of the program guide
  *
  * @param tables Tables which were processed.
- * @param fromTableID Start ID of the event table from which read the events.
- * @param toTableID End ID of the event table from which read the events.
+ * @param events Events of the service from the program guide.
  * @param serviceID ID of the service with the demanded events.
  * @param eventInfos Output vector with events.
  * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
  */
-int fillEventInfoVector(PSITables &tables, unsigned fromTableID, unsigned toTableID, unsigned serviceID, vector<EventInfo> &eventInfos) {
-    set<EventInfo> info_set;
-    for (const EventInformationTable &EIT : tables.EITs) {
-
-        /* Continue if table ID and service ID does not match */
-        if (EIT.tableID < fromTableID ||
-                EIT.tableID > toTableID || EIT.serviceID != serviceID) {
-            continue;
+int fillEventInfoVector(PSITables &tables, const vector<const Event *> &events, unsigned serviceID, vector<EventInfo> &eventInfos) {
+    const LocalTimeOffsetDescriptor *ltod = (tables.TOT)? tables.TOT->descriptors.get<LocalTimeOffsetDescriptor>() : 0;
+
+    eventInfos.clear();
+    eventInfos.reserve(events.size());
+
+    /* Process all events of the service, they are unique and ordered by the start time */
+    for (const Event *eventPtr : events) {
+        const Event &event = *eventPtr;
+        EventInfo eventInfo;
+
+        eventInfo.id = event.eventID;
+        eventInfo.dateTime = event.startTime;
+        eventInfo.duration = event.duration;
+        eventInfo.timestamp = event.startTimeUTC;
+
+        /* Transfer start time about the local offset - if is available */
+        if (ltod) {
+            eventInfo.timestamp += (event.startTimeUTC < ltod->timeOfChangeUTC)? ltod->timeOffsetSeconds : ltod->nextOffsetSeconds;
+            eventInfo.dateTime = DateTime::toDateTime(eventInfo.timestamp);
         }
 
-        /* Process all events in the table and store them into the set */
-        for (const Event &event : EIT.events) {
-            EventInfo eventInfo;
-
-            eventInfo.id = event.eventID;
-            eventInfo.dateTime = event.startTime;
-            eventInfo.duration = event.duration;
-
-            /* Transfer start time about the local offset - if is available */
-            struct tm startTimeCopy = event.startTime;
-            time_t startTime = mktime(&startTimeCopy);
-            LocalTimeOffsetDescriptor ltod;
-            if (tables.TOT && tables.TOT->descriptors.getSpecificDescriptor(ltod)) {
-                time_t timeOfChange = mktime(&ltod.timeOfChange);
-                if (startTime < timeOfChange) {
-                    eventInfo.dateTime = DateTime::offset(eventInfo.dateTime, ltod.timeOffset);
-                } else {
-                    eventInfo.dateTime = DateTime::offset(eventInfo.dateTime, ltod.nextOffset);
-                }
-            }
-
-            /* Read description of the event */
-            ShortEventDescriptor eventDescriptor;
-            if (event.descriptors.getSpecificDescriptor(eventDescriptor)) {
-                eventInfo.eventName = toAsciiString(eventDescriptor.eventName);
-                eventInfo.eventText = toAsciiString(eventDescriptor.eventText);
-            } else {
-                cerr << "Failed to get ShortEventDescriptor for actual event of service " << hex << serviceID << " with event ID " << event.eventID  << "!" << endl;
-            }
-
-            /* Erase the old record in the set */
-            info_set.erase(eventInfo);
-            info_set.insert(eventInfo);
+        /* Read description of the event */
+        const ShortEventDescriptor *eventDescriptor = event.descriptors.get<ShortEventDescriptor>();
+        if (eventDescriptor) {
+            eventInfo.eventName = toAsciiString(eventDescriptor->eventName);
+            eventInfo.eventText = toAsciiString(eventDescriptor->eventText);
+        } else {
+            // Guides are rendered concurrently, so the flags of cerr are not touched
+            ostringstream message;
+            message << "Failed to get ShortEventDescriptor for actual event of service " << hex << serviceID << " with event ID " << event.eventID  << "!" << endl;
+            cerr << message.str();
         }
+
+        eventInfos.push_back(eventInfo);
     }
 
-    /* Converts set into output vector */
-    eventInfos.resize(info_set.size());
-    copy(info_set.begin(), info_set.end(), eventInfos.begin());
+    /* Local offset may change between the events, order is then restored by the local time */
+    if (!is_sorted(eventInfos.begin(), eventInfos.end(), compareEventTime)) {
+        stable_sort(eventInfos.begin(), eventInfos.end(), compareEventTime);
+    }
 
     return EXIT_SUCCESS;
 }
 
+
 /**
- * Reads multiplex info from PSI tables into multiplex info structure
+ * Reads informations about the network from PSI tables into multiplex info structure
  * @param tables PSI tables
  * @param multInfo Multiplex info structure
  * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
  */
-int getMultiplexInfo(PSITables &tables, MultiplexInfo &multInfo) {
+int getNetworkInfo(PSITables &tables, MultiplexInfo &multInfo) {
     /* Read informations from NIT table */
     if (tables.NIT) {
         NetworkInformationTable &NIT = *tables.NIT;
@@ -403,125 +247,172 @@ int getMultiplexInfo(PSITables &tables, MultiplexInfo &multInfo) {
 
         /* Get network name and delivery method */
 
-        NetworkNameDescriptor networkDescriptor;
-        if (!NIT.descriptors.getSpecificDescriptor(networkDescriptor)) {
+        const NetworkNameDescriptor *networkDescriptor = NIT.descriptors.get<NetworkNameDescriptor>();
+        if (!networkDescriptor) {
             cerr << "Failed to get informations from NetworkNameDescriptor of NIT! NetworkNameDescriptor is not present!" << endl;
         } else {
-            multInfo.networkName = networkDescriptor.networkName;
+            multInfo.networkName.assign(networkDescriptor->networkName.begin(), networkDescriptor->networkName.end());
 
             /* Get the delivery method and parameters */
-            TerrestialDeliverySystemDescriptor terDSD;
-            bool loaded = false;
+            const TerrestialDeliverySystemDescriptor *terDSD = 0;
             for (const TransportStream &stream : NIT.streams) {
-                if (stream.descriptors.getSpecificDescriptor(terDSD)) {
-                    loaded = true;
+                if ((terDSD = stream.descriptors.get<TerrestialDeliverySystemDescriptor>())) {
                     break;
                 }
             }
 
             /* Store delivery method into multiplex structure */
-            if (!loaded) {
+            if (!terDSD) {
                 cerr << "Failed to get informations from TerrestialDeliverySystemDescriptor of NIT! TerrestialDeliverySystemDescriptor is not present!" << endl;
             } else {
                 multInfo.delivery = shared_ptr<TerrestialDeliveryInfo>(new TerrestialDeliveryInfo());
-                multInfo.delivery->bandwidth = terDSD.bandwidth;
-                if(terDSD.priority) {
-                    multInfo.delivery->codeRate = terDSD.codeRateHP;
+                multInfo.delivery->bandwidth = terDSD->bandwidth;
+                if(terDSD->priority) {
+                    multInfo.delivery->codeRate = terDSD->codeRateHP;
                 } else {
-                    multInfo.delivery->codeRate = terDSD.codeRateLP;
+                    multInfo.delivery->codeRate = terDSD->codeRateLP;
                 }
 
-                multInfo.delivery->constellation = terDSD.constellation;
-                multInfo.delivery->guardinterval = terDSD.guardInterval;
+                multInfo.delivery->constellation = terDSD->constellation;
+                multInfo.delivery->guardinterval = terDSD->guardInterval;
             }
         }
     } else {
         cerr << "Failed to get informations from NIT! NIT is not present!" << endl;
     }
 
-    /* Reads PMT tables and collect all necessary information for every station */
-    for (const ProgramMapTable &currPMT : tables.PMTs) {
-        ProgramInfo progInfo;
-        progInfo.PID = currPMT.tablePID; // PID which carries the PMT table
-
-        /* Locate corresponding service in the SDT table */
-        vector<Service> &services = tables.SDT->services;
-        vector<Service>::iterator serviceIter = find_if(services.begin(), services.end(), [&currPMT] (const Service &service) {
-            return service.serviceID == currPMT.programNumber;
-        });
+    return EXIT_SUCCESS;
+}
 
-        /* Service not found, skip this station */
-        if (serviceIter == services.end()) {
-            cerr << "Failed to get corresponding service from SDT for service ID in the current PMT!" << endl;
-            cerr << "Channel with program number" << hex << currPMT.programNumber << " will  be skipped in the futher processing!" << endl;
-            continue;
+/**
+ * Collects video and audio streams of the program which should be extracted
+ * @param PMT Program map table of the program
+ * @param services Output vector with the streams
+ */
+void getServiceInfos(const ProgramMapTable &PMT, vector<ServiceInfo> &services) {
+    for (const ProgramStream &transportStream : PMT.streams) {
+        ServiceInfo serviceInfo;
+        serviceInfo.PID = transportStream.elementaryPID;
+
+        const ISO639LanguageDescriptor *languageDescriptor;
+        switch (transportStream.streamType) {
+        case ProgramStream::StreamType::ISO_IEC_11172_2_VIDEO:
+        case ProgramStream::StreamType::ISO_IEC_13818_2_VIDEO:
+            serviceInfo.isVideo = true;
+            services.push_back(serviceInfo);
+            break;
+        case ProgramStream::StreamType::ISO_IEC_11172_3_AUDIO:
+        case ProgramStream::StreamType::ISO_IEC_13818_3_AUDIO:
+            serviceInfo.isVideo = false;
+            languageDescriptor = transportStream.ESDescriptors.get<ISO639LanguageDescriptor>();
+            if (languageDescriptor) {
+                if (languageDescriptor->audioType == AudioType::MAIN_AUDIO || languageDescriptor->audioType == AudioType::UNDEFINED) {
+                    services.push_back(serviceInfo);
+                }
+            }
+            break;
+        default:
+            break;
         }
+    }
+}
 
-        /* Service found, read some additional informations */
-        ServiceDescriptor serviceDescriptor;
-        if (!serviceIter->descriptors.getSpecificDescriptor(serviceDescriptor)) {
-            cerr << "Failed to get corresponding ServiceDescriptor from actual service of SDT!" << endl;
-            cerr << "Channel with program number" << hex << currPMT.programNumber << " will  be skipped in the futher processing!" << endl;
-            continue;
-        }
+/**
+ * Reads informations about the program from PSI tables into program info structure
+ * @param tables PSI tables
+ * @param PMT Program map table of the program
+ * @param progInfo Program info structure
+ * @return True if the program is television channel which should be extracted, otherwise false
+ */
+bool getProgramInfo(PSITables &tables, const ProgramMapTable &PMT, ProgramInfo &progInfo) {
+    progInfo.PID = PMT.tablePID; // PID which carries the PMT table
+    progInfo.programNumber = PMT.programNumber;
+
+    /* Locate corresponding service in the SDT table */
+    vector<Service, ArenaAllocator<Service>> &services = tables.SDT->services;
+    vector<Service, ArenaAllocator<Service>>::iterator serviceIter = find_if(services.begin(), services.end(), [&PMT] (const Service &service) {
+        return service.serviceID == PMT.programNumber;
+    });
 
-        /* Store addtional informations into program info structure */
-        progInfo.serviceName = serviceDescriptor.serviceName;
-        progInfo.serviceProvider = serviceDescriptor.serviceProviderName;
+    /* Service not found, skip this station */
+    if (serviceIter == services.end()) {
+        cerr << "Failed to get corresponding service from SDT for service ID in the current PMT!" << endl;
+        cerr << "Channel with program number" << hex << PMT.programNumber << dec << " will  be skipped in the futher processing!" << endl;
+        return false;
+    }
 
-        /* Continue only if we are reading the digital television */
-        if (serviceDescriptor.serviceType == ServiceType::DIGITAL_TV) {
-            /* Read present events. */
-            if (fillEventInfoVector(tables, EventInformationTable::EIT_PRESENT_TABLE_ID, EventInformationTable::EIT_PRESENT_TABLE_ID, currPMT.programNumber, progInfo.present) != EXIT_SUCCESS) {
-                cerr << "Failed to read present events for channel with program number " << currPMT.programNumber << "!" << endl;
-            }
+    /* Service found, read some additional informations */
+    const ServiceDescriptor *serviceDescriptor = serviceIter->descriptors.get<ServiceDescriptor>();
+    if (!serviceDescriptor) {
+        cerr << "Failed to get corresponding ServiceDescriptor from actual service of SDT!" << endl;
+        cerr << "Channel with program number" << hex << PMT.programNumber << dec << " will  be skipped in the futher processing!" << endl;
+        return false;
+    }
 
-            /* Read scheduled events. */
-            if (fillEventInfoVector(tables, EventInformationTable::EIT_SCHEDULE_STARTTABLE_ID, EventInformationTable::EIT_SCHEDULE_ENDTABLE_ID, currPMT.programNumber, progInfo.schedule) != EXIT_SUCCESS) {
-                cerr << "Failed to future events for channel with program number " << currPMT.programNumber << "!" << endl;
-            }
+    /* Store addtional informations into program info structure */
+    progInfo.serviceName.assign(serviceDescriptor->serviceName.begin(), serviceDescriptor->serviceName.end());
+    progInfo.serviceProvider.assign(serviceDescriptor->serviceProviderName.begin(), serviceDescriptor->serviceProviderName.end());
 
-            /* Get PID of video and audio streams */
-            for (const ProgramStream &transportStream : currPMT.streams) {
-                ServiceInfo serviceInfo;
-                serviceInfo.PID = transportStream.elementaryPID;
-
-                ISO639LanguageDescriptor languageDescriptor;
-                switch (transportStream.streamType) {
-                case ProgramStream::StreamType::ISO_IEC_11172_2_VIDEO:
-                case ProgramStream::StreamType::ISO_IEC_13818_2_VIDEO:
-                    serviceInfo.isVideo = true;
-                    progInfo.services.push_back(serviceInfo);
-                    break;
-                case ProgramStream::StreamType::ISO_IEC_11172_3_AUDIO:
-                case ProgramStream::StreamType::ISO_IEC_13818_3_AUDIO:
-                    serviceInfo.isVideo = false;
-                    if (transportStream.ESDescriptors.getSpecificDescriptor(languageDescriptor)) {
-                        if (languageDescriptor.audioType == AudioType::MAIN_AUDIO || languageDescriptor.audioType == AudioType::UNDEFINED) {
-                            progInfo.services.push_back(serviceInfo);
-                        }
-                    }
-                    break;
-                default:
-                    break;
-                }
-            }
+    /* Continue only if we are reading the digital television */
+    if (serviceDescriptor->serviceType != ServiceType::DIGITAL_TV) {
+        return false;
+    }
 
-            // Whole program has been successfuly read, store it into vector
-            multInfo.programs.push_back(progInfo);
-        }
+    /* Get PID of video and audio streams */
+    getServiceInfos(PMT, progInfo.services);
+
+    return true;
+}
+
+/**
+ * Reads events of the program from PSI tables into program info structure
+ * @param tables PSI tables
+ * @param progInfo Program info structure
+ */
+void getProgramEvents(PSITables &tables, ProgramInfo &progInfo) {
+    /* Read present events. */
+    if (fillEventInfoVector(tables, tables.EPG.presentFollowing(progInfo.programNumber), progInfo.programNumber, progInfo.present) != EXIT_SUCCESS) {
+        cerr << "Failed to read present events for channel with program number " << progInfo.programNumber << "!" << endl;
     }
 
-    return EXIT_SUCCESS;
+    /* Read scheduled events. */
+    if (fillEventInfoVector(tables, tables.EPG.schedule(progInfo.programNumber), progInfo.programNumber, progInfo.schedule) != EXIT_SUCCESS) {
+        cerr << "Failed to future events for channel with program number " << progInfo.programNumber << "!" << endl;
+    }
+}
+
+/**
+ * Renders events into the text of the program guide
+ * @param events Events ordered by their start time
+ * @return Text with one event per line
+ */
+string renderEvents(const vector<EventInfo> &events) {
+    const static size_t LINE_ESTIMATE = 128;
+    char BUFFER[BUFFER_SIZE];
+
+    string text;
+    text.reserve(events.size() * LINE_ESTIMATE);
+
+    /* Render the events in the demanded format. */
+    for (const EventInfo &event : events) {
+        text.append(BUFFER, strftime(BUFFER, BUFFER_SIZE, "%Y-%m-%d %H:%M:%S - ", &event.dateTime));
+        text.append(event.eventName).append(" - ").append(event.eventText).append(" - ");
+        text.append(BUFFER, strftime(BUFFER, BUFFER_SIZE, "(%H:%M:%S)", &event.duration));
+        text.push_back('\n');
+    }
+
+    return text;
 }
 
 /**
- * Saves events into file
+ * Saves events into file, whole file is written at once
  * @param filename Filename of the output file
  * @param events Events to be saved into file
  * @return  0 on success, 1 on failure
  */
-int saveEvents(string filename, const vector<EventInfo> &events) {
+int saveEvents(const string &filename, const vector<EventInfo> &events) {
+    string text = renderEvents(events);
+
     /* Opens output file for storing the events. */
     ofstream output;
     output.open(filename);
@@ -530,235 +421,967 @@ int saveEvents(string filename, const vector<EventInfo> &events) {
         return EXIT_FAILURE;
     }
 
-    /* Sorts events before saving. */
-    vector<EventInfo> eventsCopy(events);
-    sort(eventsCopy.begin(), eventsCopy.end(), [] (const EventInfo& lhs, const EventInfo& rhs) {
-        time_t t1 = mktime(const_cast<tm *>(&lhs.dateTime));
-        time_t t2 = mktime(const_cast<tm *>(&rhs.dateTime));
-        return t1 < t2;
-    });
+    output.write(text.data(), text.size());
+    output.close();
+
+    return (output)? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Reads program guide of the program and saves it into its folder
+ * @param tables Tables which were processed, they are only read
+ * @param programInfo Program whose guide is saved
+ */
+void saveProgramGuide(PSITables &tables, ProgramInfo &programInfo) {
+    getProgramEvents(tables, programInfo);
 
-    /* Save the events in the demanded format. */
-    for (const EventInfo &event : eventsCopy) {
-        strftime (BUFFER, BUFFER_SIZE, "%Y-%m-%d %H:%M:%S - ", &event.dateTime);
-        output << BUFFER << event.eventName << " - " << event.eventText << " - ";
-        strftime (BUFFER, BUFFER_SIZE, "(%H:%M:%S)", &event.duration);
-        output << BUFFER << endl;
+    /* Save present programs */
+    if(saveEvents(programInfo.folder + string("/epg-present.txt"), programInfo.present) != EXIT_SUCCESS) {
+        cerr << "Unable to create file \"" <<  programInfo.folder + string("/epg-present.txt") <<  "\" for saving present events!" << endl;
+    }
+
+    /* Save scheduled programs */
+    if(saveEvents(programInfo.folder + string("/epg-schedule.txt"), programInfo.schedule) != EXIT_SUCCESS) {
+        cerr << "Unable to create file \"" <<  programInfo.folder + string("/epg-schedule.txt") <<  "\" for saving schedule events!" << endl;
+    }
+}
+
+/**
+ * State of the single pass extraction of the multiplex
+ */
+struct ExtractionContext {
+    ExtractionContext(MPEG2Demultiplexer &demux, MultiplexInfo &multInfo, bool infoOnly) :
+        demux(demux), multInfo(multInfo), infoOnly(infoOnly), sectionCache(new SectionCache()), assemblerEIT(false), rootCreated(false)
+    {}
+
+    MPEG2Demultiplexer &demux;
+    MultiplexInfo &multInfo;
+    bool infoOnly;
+    PSITables tables;
+    shared_ptr<SectionCache> sectionCache;
+    TableAssembler assemblerNIT;
+    TableAssembler assemblerSDT;
+    TableAssembler assemblerEIT;    // only completeness, events are owned by the EPG store
+    set<uint16_t> resolvedPrograms;
+    bool rootCreated;
+};
+
+/**
+ * Creates output directory of the multiplex if it does not exist yet
+ * @param ctx Extraction context
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int createRootDirectory(ExtractionContext &ctx) {
+    if (!ctx.rootCreated) {
+        if(createDirectory(ctx.multInfo.fileName.c_str()) > 0) {
+            cerr << "Unable to create root directory \"" <<  ctx.multInfo.fileName <<  "\" for writing multiplex info!" << endl;
+            return EXIT_FAILURE;
+        }
+        ctx.rootCreated = true;
     }
-    output.close();
 
     return EXIT_SUCCESS;
 }
 
 /**
- * Saves multiplex info into output files and directories
- * @param is Input stream with MPEG2 packets
- * @param multInfo Parsed informations.
- * @return 0 on success, 1 on failure
+ * Creates folder of the program and opens streams for its video and audio
+ * @param ctx Extraction context
+ * @param programInfo Program which should be extracted
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
  */
-int saveMultiplexInfo(MPEG2FileInputStream &is, MultiplexInfo &multInfo) {
-    /* Create output directory */
-    if(createDirectory(multInfo.fileName.c_str()) > 0) {
-        cerr << "Unable to create root directory \"" <<  multInfo.fileName <<  "\" for writing multiplex info!" << endl;
+int openProgramStreams(ExtractionContext &ctx, ProgramInfo &programInfo) {
+    if (createRootDirectory(ctx) != EXIT_SUCCESS) {
         return EXIT_FAILURE;
     }
 
-    /* Open info.txt */
+    /* Construct folder name */
+    stringstream programFolderStream;
+    programFolderStream << ctx.multInfo.fileName + string("/");
+    programFolderStream << "0x" << hex << setfill('0') << setw(4) << programInfo.PID;
+    programFolderStream << "-" + programInfo.serviceProvider + "-" + programInfo.serviceName;
+    programInfo.folder = programFolderStream.str();
 
-    ofstream infoOutput;
-    string infoFilename = multInfo.fileName + string("/info.txt");
-    infoOutput.open( infoFilename );
+    /* Create directory for program */
+    if(createDirectory(programInfo.folder.c_str()) > 0) {
+        cerr << "Unable to create folder \"" <<  programInfo.folder <<  "\" for channel with service name: " << programInfo.serviceName << "!" << endl;
+        return EXIT_FAILURE;
+    }
 
-    if( !infoOutput ) {
-        cerr << "Unable to create file \"" <<  infoFilename <<  "\" for writing multiplex info!" << endl;
+    /* Open streams for video and audio */
+    for (const ServiceInfo &serviceInfo : programInfo.services) {
+        /* Stream which is already extracted is kept when the program is resolved again */
+        if (dynamic_pointer_cast<MPEG2ServiceStream>(ctx.demux.getStream(serviceInfo.PID))) {
+            continue;
+        }
+
+        shared_ptr<MPEG2ServiceStream> serviceStream;
+        string filename;
+
+        /* Determine stream type and create correspondig stream to it */
+
+        if (serviceInfo.isVideo) {
+            serviceStream = shared_ptr<MPEG2ServiceStream>(new MPEG2VideoFileStream(serviceInfo.PID));
+            filename = "video.m2v";
+        } else {
+            serviceStream = shared_ptr<MPEG2ServiceStream>(new MPEG2AudioFileStream(serviceInfo.PID));
+            filename = "audio.wav";
+        }
+
+        /* Open stream and attach it to the demultiplexer, packets held back so far are put into it */
+
+        string streamFileName = programInfo.folder + string("/") + filename;
+        serviceStream->open(streamFileName);
+
+        if( !*serviceStream ) {
+             cerr << "Unable to create stream file \"" <<  programInfo.folder + string("/") + filename << endl;
+             continue;
+        }
+
+        ctx.demux.attachStream(serviceStream);
     }
 
-    /* Writing into info.txt */
-    else {
-        infoOutput << "Network name: " << multInfo.networkName << endl;
-        infoOutput << "Network ID: " << multInfo.networkID << endl;
-        infoOutput << "Bandwidth: " << ((multInfo.delivery)? multInfo.delivery->bandwidth.toString() : "(unknown)") << endl;
-        infoOutput << "Constellation: " << ((multInfo.delivery)?multInfo.delivery->constellation.toString() : "(unknown)") << endl;
-        infoOutput << "Guard interval: " << ((multInfo.delivery)?multInfo.delivery->guardinterval.toString() : "(unknown)") << endl;
-        infoOutput << "Code rate: " <<((multInfo.delivery)? multInfo.delivery->codeRate.toString() : "(unknown)") << endl;
-        infoOutput << endl;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Decides about the programs whose PMT and service description are known and opens their streams.
+ * @param ctx Extraction context
+ * @param final True if the end of the stream was reached and all known programs should be decided.
+ */
+void resolvePrograms(ExtractionContext &ctx, bool final) {
+    if (ctx.infoOnly || (!ctx.tables.SDT && !final)) {
+        return;
     }
 
-    /* Create program guide files and files for storing video and audio */
+    for (const ProgramMapTable &PMT : ctx.tables.PMTs) {
+        if (ctx.resolvedPrograms.count(PMT.programNumber) > 0) {
+            continue;
+        }
+        ctx.resolvedPrograms.insert(PMT.programNumber);
 
-    map<uint16_t, shared_ptr<PacketStream> > streamsMap;
-    for (const ProgramInfo &programInfo : multInfo.programs) {
+        ProgramInfo progInfo;
+        if (ctx.tables.SDT && getProgramInfo(ctx.tables, PMT, progInfo)) {
+            if (openProgramStreams(ctx, progInfo) == EXIT_SUCCESS) {
+                /* Program resolved again from the changed PMT replaces its previous info */
+                vector<ProgramInfo>::iterator programIter = find_if(ctx.multInfo.programs.begin(), ctx.multInfo.programs.end(), [&PMT] (const ProgramInfo &info) {
+                    return info.programNumber == PMT.programNumber;
+                });
+                if (programIter != ctx.multInfo.programs.end()) {
+                    *programIter = progInfo;
+                } else {
+                    ctx.multInfo.programs.push_back(progInfo);
+                }
+            }
+        }
 
-        /* Construct folder name */
-        stringstream programFolderStream;
-        programFolderStream << multInfo.fileName + string("/");
-        programFolderStream << "0x" << hex << setfill('0') << setw(4) << programInfo.PID;
-        programFolderStream << "-" + programInfo.serviceProvider + "-" + programInfo.serviceName;
-        string programFolder = programFolderStream.str();
+        /* Streams of the programs which are not extracted are only counted */
+        vector<ServiceInfo> services;
+        getServiceInfos(PMT, services);
+        for (const ServiceInfo &serviceInfo : services) {
+            if (!ctx.demux.hasStream(serviceInfo.PID)) {
+                ctx.demux.attachStream(shared_ptr<PacketStream>(new PacketStream(serviceInfo.PID)));
+            }
+        }
+    }
+}
 
-        /* Create directory for program */
-        if(createDirectory(programFolder.c_str()) > 0) {
-            cerr << "Unable to create folder \"" <<  programFolder <<  "\" for channel with service name: " << programInfo.serviceName << "!" << endl;
-            break;
+/**
+ * Processes PAT section, registers streams for NIT and PMT tables.
+ * @param ctx Extraction context
+ * @param table Section with PAT
+ */
+void onPATRecieved(ExtractionContext &ctx, ServiceInformationTable &table);
+
+/**
+ * Tests whether all tables needed for the multiplex info are complete - PAT, PMT tables
+ * of all its programs, NIT and SDT.
+ * @param ctx Extraction context
+ * @return True if all tables are complete, otherwise false
+ */
+bool isDiscoveryComplete(ExtractionContext &ctx) {
+    if (!ctx.tables.PAT || !ctx.tables.NIT || !ctx.tables.SDT) {
+        return false;
+    }
+
+    size_t programsCount = count_if(ctx.tables.PAT->programs.begin(), ctx.tables.PAT->programs.end(), [] (const Program &program) {
+        return program.programNum != Program::NIT_PROG_NUM;
+    });
+    return ctx.tables.PMTs.size() >= programsCount;
+}
+
+/**
+ * Stops reading of the input when only the tables are demanded and all of them are complete.
+ * @param ctx Extraction context
+ */
+void checkDiscovery(ExtractionContext &ctx) {
+    if (ctx.infoOnly && isDiscoveryComplete(ctx)) {
+        ctx.demux.stop();
+    }
+}
+
+/**
+ * Processes NIT section.
+ * @param ctx Extraction context
+ * @param table Section with NIT
+ */
+void onNITRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    if (ctx.tables.NIT || table.tableID != NetworkInformationTable::NIT_ACTUAL_TABLE_ID) {
+        return;
+    }
+
+    if (ctx.assemblerNIT.put(table) == TableAssembler::TABLE_COMPLETE) {
+        vector<ServiceInformationTable> sections = ctx.assemblerNIT.sections(table.tableID, table.tableIDExtension());
+        ctx.tables.NIT = shared_ptr<NetworkInformationTable>(new NetworkInformationTable(sections));
+        checkDiscovery(ctx);
+    }
+}
+
+/**
+ * Processes SDT section.
+ * @param ctx Extraction context
+ * @param table Section with SDT
+ */
+void onSDTRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    if (ctx.tables.SDT || table.tableID != ServiceDescriptionTable::SDT_ACTUAL_TABLE_ID) {
+        return;
+    }
+
+    if (ctx.assemblerSDT.put(table) == TableAssembler::TABLE_COMPLETE) {
+        vector<ServiceInformationTable> sections = ctx.assemblerSDT.sections(table.tableID, table.tableIDExtension());
+        ctx.tables.SDT = shared_ptr<ServiceDescriptionTable>(new ServiceDescriptionTable(sections));
+        resolvePrograms(ctx, false);
+        checkDiscovery(ctx);
+    }
+}
+
+/**
+ * Processes TOT section, only TOT which contains offset information is stored.
+ * @param ctx Extraction context
+ * @param table Section with TOT
+ */
+void onTOTRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    if (ctx.tables.TOT || table.tableID != TimeOffsetTable::TOT_TABLE_ID) {
+        return;
+    }
+
+    shared_ptr<TimeOffsetTable> TOT(new TimeOffsetTable(table));
+    if (TOT->descriptors.contains(LocalTimeOffsetDescriptor::DESCRIPTOR_TAG)) {
+        ctx.tables.TOT = TOT;
+    }
+}
+
+/**
+ * Processes EIT section, every section of the current EIT version is indexed by the EPG store only once.
+ * @param ctx Extraction context
+ * @param table Section with EIT
+ */
+void onEITRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    if (ctx.assemblerEIT.put(table) != TableAssembler::SECTION_IGNORED) {
+        ctx.tables.EPG.put(EventInformationTable(table));
+    }
+}
+
+/**
+ * Constructs NIT and SDT from the sections which have been recieved if some of their sections are missing.
+ * @param ctx Extraction context
+ */
+void assembleIncompleteTables(ExtractionContext &ctx) {
+    try {
+        vector<ServiceInformationTable> sections;
+        if (!ctx.tables.NIT && !(sections = ctx.assemblerNIT.firstSections(NetworkInformationTable::NIT_ACTUAL_TABLE_ID)).empty()) {
+            cerr << "NIT table is incomplete, only " << dec << sections.size() << " of its sections have been recieved!" << endl;
+            ctx.tables.NIT = shared_ptr<NetworkInformationTable>(new NetworkInformationTable(sections));
         }
 
-        /* Save present programs */
-        if(saveEvents(programFolder + string("/epg-present.txt"), programInfo.present) != EXIT_SUCCESS) {
-            cerr << "Unable to create file \"" <<  programFolder + string("/epg-present.txt") <<  "\" for saving present events!" << endl;
+        if (!ctx.tables.SDT && !(sections = ctx.assemblerSDT.firstSections(ServiceDescriptionTable::SDT_ACTUAL_TABLE_ID)).empty()) {
+            cerr << "SDT table is incomplete, only " << dec << sections.size() << " of its sections have been recieved!" << endl;
+            ctx.tables.SDT = shared_ptr<ServiceDescriptionTable>(new ServiceDescriptionTable(sections));
         }
+    } catch (const exception& error) {
+        cerr << "Unable to assemble incomplete table: " << error.what() << endl;
+    }
+}
 
-        /* Save scheduled programs */
-        if(saveEvents(programFolder + string("/epg-schedule.txt"), programInfo.schedule) != EXIT_SUCCESS) {
-            cerr << "Unable to create file \"" <<  programFolder + string("/epg-schedule.txt") <<  "\" for saving schedule events!" << endl;
+/**
+ * Processes PMT section, streams of the program are held back until the program is resolved.
+ * @param ctx Extraction context
+ * @param table Section with PMT
+ */
+void onPMTRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    ProgramMapTable PMT(table);
+
+    /* Only the first PMT of the program announced by PAT is used */
+    if (!ctx.tables.PAT->containsProgramNum(PMT.programNumber)) {
+        return;
+    }
+    for (const ProgramMapTable &currPMT : ctx.tables.PMTs) {
+        if (currPMT.programNumber == PMT.programNumber) {
+            return;
         }
+    }
+    ctx.tables.PMTs.push_back(PMT);
 
-        /* Open streams for video and audio */
-        for (const ServiceInfo &serviceInfo : programInfo.services) {
-            shared_ptr<MPEG2ServiceStream> serviceStream;
-            string filename;
+    /* Time of the multiplex is measured by the PCR of the first program */
+    if (ctx.tables.PMTs.size() == 1) {
+        ctx.demux.setReferencePID(PMT.PCR_PID);
+    }
 
-            /* Determine stream type and create correspondig stream to it */
+    vector<ServiceInfo> services;
+    getServiceInfos(PMT, services);
+    for (const ServiceInfo &serviceInfo : services) {
+        if (!ctx.infoOnly) {
+            ctx.demux.deferStream(serviceInfo.PID);
+        }
+    }
 
-            if (serviceInfo.isVideo) {
-                serviceStream = shared_ptr<MPEG2ServiceStream>(new MPEG2VideoFileStream(serviceInfo.PID));
-                filename = "video.m2v";
-            } else {
-                serviceStream = shared_ptr<MPEG2ServiceStream>(new MPEG2AudioFileStream(serviceInfo.PID));
-                filename = "audio.wav";
-            }
+    /* All programs are known, packets of the other PIDs do not have to be held back anymore */
+    size_t programsCount = count_if(ctx.tables.PAT->programs.begin(), ctx.tables.PAT->programs.end(), [] (const Program &program) {
+        return program.programNum != Program::NIT_PROG_NUM;
+    });
+    if (ctx.tables.PMTs.size() >= programsCount) {
+        ctx.demux.setDeferUnknown(false);
+    }
 
-            /* Open stream and store it into streams map */
+    resolvePrograms(ctx, false);
+    checkDiscovery(ctx);
+}
 
-            string streamFileName = programFolder + string("/") + filename;
-            serviceStream->open(streamFileName);
+/**
+ * Processes change of the section which is going to be parsed. Program whose PMT has changed
+ * is forgotten, so the new PMT is accepted and the program is resolved again.
+ * @param ctx Extraction context
+ * @param key Key of the changed section
+ * @param change Kind of the change
+ */
+void onSectionChanged(ExtractionContext &ctx, const SectionKey &key, SectionCache::Change change) {
+    if (change == SectionCache::SECTION_NEW || key.tableID != ProgramMapTable::PMT_TABLE_ID) {
+        return;
+    }
 
-            if( !serviceStream ) {
-                 cerr << "Unable to create stream file \"" <<  programFolder + string("/") + filename << endl;
-                 continue;
-            }
+    uint16_t programNumber = key.tableIDExtension;
+    ctx.tables.PMTs.erase(remove_if(ctx.tables.PMTs.begin(), ctx.tables.PMTs.end(), [programNumber] (const ProgramMapTable &PMT) {
+        return PMT.programNumber == programNumber;
+    }), ctx.tables.PMTs.end());
+    ctx.resolvedPrograms.erase(programNumber);
+}
 
-            streamsMap.insert(pair<uint16_t, shared_ptr<MPEG2ServiceStream> >(serviceInfo.PID, serviceStream));
-        }
+void onPATRecieved(ExtractionContext &ctx, ServiceInformationTable &table) {
+    if (ctx.tables.PAT) {
+        return;
     }
+    ctx.tables.PAT = shared_ptr<ProgramAssociationTable>(new ProgramAssociationTable(table));
 
-    /* Process whole file and push transport streams into corresponding packets streams */
-    is.reset();
-    for (MPEG2FileInputStream::iterator &it = is.current(); it != is.end(); ++it) {
-        const MPEG2Packet &packet = *it;
-        map<uint16_t, shared_ptr<PacketStream> >::iterator streamIter = streamsMap.find(packet.header->PID);
-
-        /* Get packet stream from map, or create it if does not exist! */
-        shared_ptr<PacketStream> packetStream;
-        if(streamIter != streamsMap.end())
-        {
-           packetStream = streamIter->second;
-        } else {
-            packetStream = shared_ptr<PacketStream>(new PacketStream(packet.header->PID));
-            streamsMap.insert(pair<uint16_t, shared_ptr<PacketStream> >(packet.header->PID, packetStream));
+    /* Register stream of NIT */
+    uint16_t pidNIT = NetworkInformationTable::NIT_DEFAULT_PID;
+    for (const Program &program : ctx.tables.PAT->programs) {
+        if (program.programNum == Program::NIT_PROG_NUM) {
+            pidNIT = program.programPID;
+            break;
         }
+    }
 
-        /* Add current stream packet to the stream to which it belongs. */
-        try {
-            *packetStream << packet;
-        } catch (const runtime_error& error) {
-            cerr << "Packet " << is.currentFrameNo() << ": Internal error occured when reading MPEG2 packet!" << endl;
-            cerr << "Reason: " << error.what() << endl;                                                                                                                           \
+    /* Packets which came before PAT may have been only counted, counting is replaced by the section stream */
+    if (!ctx.demux.getStream(pidNIT)) {
+        ctx.demux.attachStream(shared_ptr<PacketStream>(new MPEG2SectionStream(pidNIT, [&ctx] (ServiceInformationTable &table) {
+            onNITRecieved(ctx, table);
+        }, NetworkInformationTable::NIT_ACTUAL_TABLE_ID, 0xFF, ctx.sectionCache)));
+    }
+
+    /* Register streams of PMT tables */
+    bool hasPrograms = false;
+    for (const Program &program : ctx.tables.PAT->programs) {
+        if (program.programNum != Program::NIT_PROG_NUM && !ctx.demux.getStream(program.programPID)) {
+            hasPrograms = true;
+            ctx.demux.attachStream(shared_ptr<PacketStream>(new MPEG2SectionStream(program.programPID, [&ctx] (ServiceInformationTable &table) {
+                onPMTRecieved(ctx, table);
+            }, ProgramMapTable::PMT_TABLE_ID, 0xFF, ctx.sectionCache)));
         }
     }
 
-    /* Print bitrate into info.txt */
+    if (!hasPrograms) {
+        ctx.demux.setDeferUnknown(false);
+    }
 
-    if (infoOutput) {
-        infoOutput << "Bitrate: " << endl;
+    checkDiscovery(ctx);
+}
 
-        if (multInfo.delivery) {
-            vector<BitratePerPID> bitrates;
+/**
+ * Saves informations about the multiplex and bitrates of its streams into info.txt
+ * @param ctx Extraction context
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int saveInfo(ExtractionContext &ctx) {
+    MultiplexInfo &multInfo = ctx.multInfo;
 
-            // calculate bitarates
-            for (const pair<uint16_t, shared_ptr<PacketStream> >& keyVal: streamsMap) {
-                bitrates.push_back(keyVal.second->calculateBitRate(multInfo.delivery->bandwidth, multInfo.delivery->codeRate, multInfo.delivery->constellation, multInfo.delivery->guardinterval));
-            }
+    /* Open info.txt */
 
-            // sort bitrates by their speed
-            sort(bitrates.begin(), bitrates.end(), greater<BitratePerPID>());
+    ofstream infoOutput;
+    string infoFilename = multInfo.fileName + string("/info.txt");
+    infoOutput.open( infoFilename );
 
-            // write bitarates into info.txt
-            for (const BitratePerPID bitRatePerPID : bitrates) {
-                infoOutput << "0x" << hex << setfill('0') << setw(4) << bitRatePerPID.PID << " ";
-                infoOutput << setprecision(2) << fixed << bitRatePerPID.bitrate << " Mbps" << endl;
+    if( !infoOutput ) {
+        cerr << "Unable to create file \"" <<  infoFilename <<  "\" for writing multiplex info!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    /* Writing into info.txt */
+    infoOutput << "Network name: " << multInfo.networkName << endl;
+    infoOutput << "Network ID: " << multInfo.networkID << endl;
+    infoOutput << "Bandwidth: " << ((multInfo.delivery)? multInfo.delivery->bandwidth.toString() : "(unknown)") << endl;
+    infoOutput << "Constellation: " << ((multInfo.delivery)?multInfo.delivery->constellation.toString() : "(unknown)") << endl;
+    infoOutput << "Guard interval: " << ((multInfo.delivery)?multInfo.delivery->guardinterval.toString() : "(unknown)") << endl;
+    infoOutput << "Code rate: " <<((multInfo.delivery)? multInfo.delivery->codeRate.toString() : "(unknown)") << endl;
+    infoOutput << endl;
+
+    /* Print bitrate into info.txt */
+
+    infoOutput << "Bitrate: " << endl;
+
+    const MPEG2BitrateStatistics &statistics = ctx.demux.bitrateStatistics();
+    bool stoppedEarly = ctx.demux.stopReason() != MPEG2Demultiplexer::NOT_STOPPED;
+    if (!statistics.hasMeasurement() && stoppedEarly) {
+        // nominal capacity shared by the few packets read is not the bitrate of the multiplex
+        infoOutput << "(unknown, reading was stopped after " << dec << ctx.demux.processedPackets() << " packets)" << endl;
+    } else if (statistics.hasMeasurement() || multInfo.delivery) {
+        vector<BitratePerPID> bitrates;
+
+        // bitrates measured by PCR are preferred, the nominal capacity of the delivery system is used without PCR
+        for (const pair<const uint16_t, shared_ptr<PacketStream> >& keyVal: ctx.demux.streams()) {
+            if (statistics.hasMeasurement()) {
+                BitrateSummary measured;
+                BitratePerPID bitRatePerPID;
+                bitRatePerPID.PID = keyVal.first;
+                bitRatePerPID.bitrate = (statistics.summary(keyVal.first, measured))? measured.average / 1000000 : 0;
+                bitrates.push_back(bitRatePerPID);
+            } else {
+                bitrates.push_back(keyVal.second->calculateBitRate(multInfo.delivery->bandwidth, multInfo.delivery->codeRate, multInfo.delivery->constellation, multInfo.delivery->guardinterval, ctx.demux.processedPackets()));
             }
         }
+
+        // sort bitrates by their speed
+        sort(bitrates.begin(), bitrates.end(), greater<BitratePerPID>());
+
+        // write bitarates into info.txt
+        for (const BitratePerPID bitRatePerPID : bitrates) {
+            infoOutput << "0x" << hex << setfill('0') << setw(4) << bitRatePerPID.PID << " ";
+            infoOutput << setprecision(2) << fixed << bitRatePerPID.bitrate << " Mbps" << endl;
+        }
     }
 
-    /* Close all output files */
+    /* Print bitrates of the sliding windows into info.txt */
+    if (statistics.hasMeasurement()) {
+        double windowSeconds = (double)MPEG2BitrateStatistics::WINDOW_SLOTS * MPEG2BitrateStatistics::SLOT_TICKS / MPEG2PacketView::PCR_CLOCK;
+
+        infoOutput << endl;
+        infoOutput << "Measured bitrate (min / avg / max over " << setprecision(1) << fixed << windowSeconds << " s windows, ";
+        infoOutput << setprecision(2) << statistics.measuredSeconds() << " s measured): " << endl;
+
+        for (const BitrateSummary &bitrate : statistics.summaries()) {
+            infoOutput << "0x" << hex << setfill('0') << setw(4) << bitrate.PID << " ";
+            infoOutput << setprecision(2) << fixed << bitrate.minimum / 1000000 << " / " << bitrate.average / 1000000 << " / " << bitrate.maximum / 1000000 << " Mbps" << endl;
+        }
+    }
 
-    // Close info.txt output
     infoOutput.close();
 
-    // Close stream outputs
-    for (const pair<uint16_t, shared_ptr<PacketStream> >& keyVal: streamsMap) {
-        keyVal.second->close();
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Returns state of the table assembled from more sections.
+ * @param assembler Sections of the table
+ * @return Description of the state
+ */
+string tableState(const TableAssembler &assembler) {
+    if (assembler.tablesCount() == 0) {
+        return "missing";
+    }
+    return assembler.allComplete()? "complete" : "incomplete";
+}
+
+/**
+ * Prints which tables have been found and how much of the input has been read
+ * @param ctx Extraction context
+ */
+void printDiscoveryReport(ExtractionContext &ctx) {
+    stringstream report;
+
+    report << ctx.multInfo.fileName << ": read " << dec << ctx.demux.processedPackets() << " packets";
+    switch (ctx.demux.stopReason()) {
+    case MPEG2Demultiplexer::STOP_REQUESTED:
+        report << ", all tables are complete" << endl;
+        break;
+    case MPEG2Demultiplexer::PACKET_BUDGET:
+        report << ", budget of the packets has been exhausted" << endl;
+        break;
+    case MPEG2Demultiplexer::TIME_BUDGET:
+        report << ", budget of the time has been exhausted" << endl;
+        break;
+    default:
+        report << ", end of the input has been reached" << endl;
+        break;
+    }
+
+    size_t programsCount = 0;
+    if (ctx.tables.PAT) {
+        programsCount = count_if(ctx.tables.PAT->programs.begin(), ctx.tables.PAT->programs.end(), [] (const Program &program) {
+            return program.programNum != Program::NIT_PROG_NUM;
+        });
+    }
+
+    report << "  PAT: " << ((ctx.tables.PAT)? "complete" : "missing") << endl;
+    report << "  PMT: " << ctx.tables.PMTs.size() << " of " << programsCount << endl;
+    report << "  NIT: " << tableState(ctx.assemblerNIT) << endl;
+    report << "  SDT: " << tableState(ctx.assemblerSDT) << endl;
+    report << "  Sections: " << ctx.sectionCache->sectionsCount() << " cached, " << ctx.sectionCache->repeatedSections() << " repeated" << endl;
+    if (ctx.demux.stopReason() == MPEG2Demultiplexer::TIME_BUDGET || ctx.demux.elapsedSeconds() > 0) {
+        report << "  PCR time: " << setprecision(2) << fixed << ctx.demux.elapsedSeconds() << " s" << endl;
+    }
+
+    const MPEG2ClockRecovery &clock = ctx.demux.clockRecovery();
+    if (clock.referencePID() != -1 && clock.averageBitrate(clock.referencePID()) > 0) {
+        report << "  Multiplex bitrate: " << setprecision(2) << fixed << clock.averageBitrate(clock.referencePID()) / 1000000 << " Mbps" << endl;
+    }
+
+    cout << report.str();
+}
+
+/**
+ * Saves statistics of the streams in the time buckets into stats.csv or stats.json
+ * @param ctx Extraction context
+ * @param format Format of the file, csv or json
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int saveStreamStatistics(ExtractionContext &ctx, const string &format) {
+    const MPEG2StreamStatistics *statistics = ctx.demux.streamStatistics();
+    if (!statistics) {
+        return EXIT_SUCCESS;
+    }
+
+    ofstream statsOutput;
+    string statsFilename = ctx.multInfo.fileName + string("/stats.") + format;
+    statsOutput.open( statsFilename );
+
+    if( !statsOutput ) {
+        cerr << "Unable to create file \"" <<  statsFilename <<  "\" for writing stream statistics!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    if (format == "json") {
+        statistics->writeJSON(statsOutput);
+    } else {
+        statistics->writeCSV(statsOutput);
     }
 
     return EXIT_SUCCESS;
 }
 
-int main(int argc, char *argv[])
-{
-    /* Check that is passed one argument  */
-    if (argc < 2) {
-        cerr << "Missing argument that specifies path to the file with MPEG-2 stream!" << endl;
+/**
+ * Extracts the multiplex in one pass of the input stream. Every packet is routed by its PID
+ * into the section streams of PSI tables or into the streams of the video and audio. PMT tables
+ * are discovered from PAT and the elementary streams from the PMT tables during the processing.
+ * In the info only mode only the tables are read and reading stops when they are complete.
+ * @param is Input stream with MPEG2 packets
+ * @param multInfo Informations about the multiplex.
+ * @param options Options of the processing, streams and program guides are processed in the calling thread if it has less than 2 threads.
+ * @return 0 on success, 1 on failure
+ */
+int extractMultiplex(MPEG2InputStream &is, MultiplexInfo &multInfo, const Options &options) {
+    bool parallel = options.threads > 1 && !options.infoOnly;
+    unique_ptr<MPEG2Demultiplexer> demux(parallel? new MPEG2ParallelDemultiplexer(is, options.threads) : new MPEG2Demultiplexer(is));
+    ExtractionContext ctx(*demux, multInfo, options.infoOnly);
+
+    ctx.demux.setPacketBudget(options.maxPackets);
+    ctx.demux.setTimeBudget(options.maxSeconds);
+    if (!options.statsFormat.empty()) {
+        ctx.demux.enableStreamStatistics(options.statsSeconds);
+    }
+    if (ctx.infoOnly) {
+        ctx.demux.setDeferUnknown(false);
+    }
+
+    ctx.sectionCache->setChangeCallback([&ctx] (const SectionKey &key, uint8_t, SectionCache::Change change) {
+        onSectionChanged(ctx, key, change);
+    });
+
+    /* Register streams of the tables with the well known PID */
+
+    ctx.demux.addStream(shared_ptr<PacketStream>(new MPEG2SectionStream(ProgramAssociationTable::PAT_PID, [&ctx] (ServiceInformationTable &table) {
+        onPATRecieved(ctx, table);
+    }, ProgramAssociationTable::PAT_TABLE_ID, 0xFF, ctx.sectionCache)));
+    ctx.demux.addStream(shared_ptr<PacketStream>(new MPEG2SectionStream(ServiceDescriptionTable::SDT_PID, [&ctx] (ServiceInformationTable &table) {
+        onSDTRecieved(ctx, table);
+    }, ServiceDescriptionTable::SDT_ACTUAL_TABLE_ID, 0xFF, ctx.sectionCache)));
+
+    // Program guides are not saved in the info only mode
+    if (!ctx.infoOnly) {
+        ctx.demux.addStream(shared_ptr<PacketStream>(new MPEG2SectionStream(EventInformationTable::EIT_PID, [&ctx] (ServiceInformationTable &table) {
+            onEITRecieved(ctx, table);
+        }, EventInformationTable::EIT_ACTUAL_FILTER_ID, EventInformationTable::EIT_ACTUAL_FILTER_MASK, ctx.sectionCache)));
+        ctx.demux.addStream(shared_ptr<PacketStream>(new MPEG2SectionStream(TimeOffsetTable::TOT_PID, [&ctx] (ServiceInformationTable &table) {
+            onTOTRecieved(ctx, table);
+        }, TimeOffsetTable::TOT_TABLE_ID, 0xFF, ctx.sectionCache)));
+    }
+
+    /* Process whole file and push transport streams into corresponding packets streams */
+    ctx.demux.run();
+
+    if (ctx.infoOnly || ctx.demux.stopReason() != MPEG2Demultiplexer::NOT_STOPPED) {
+        printDiscoveryReport(ctx);
+    }
+
+    if (is.skippedBytes() > 0) {
+        cerr << "Synchronization of the packets has been lost, " << dec << is.skippedBytes() << " bytes were skipped to regain it!" << endl;
+    }
+
+    if (!ctx.tables.PAT) {
+        cerr << "Unable to locate mandatory PAT table in the transport stream!" << endl;
+        cerr << "Terminating application now due to previous error!" << endl;
+        ctx.demux.close();
         return EXIT_FAILURE;
-    } else if (argc > 2) {
-        cerr << "Too many program arguments! Expected only one argument!" << endl;
     }
 
-    /* Parse filename with MPEG2 transport stream */
-    string filename(argv[1]);
-    if (filename.size() < 3 || filename.substr(filename.size() - 3) != string(".ts")) {
-        cerr << "Input transport stream filename should have an extension .ts!" << endl;
+    assembleIncompleteTables(ctx);
+
+    if (!ctx.tables.SDT) {
+        cerr << "Unable to locate SDT table in the transport stream!" << endl;
+    }
+
+    /* Decide about the programs which were not resolved during the processing */
+    resolvePrograms(ctx, true);
+    ctx.demux.flushDeferred();
+
+    /* Wait for all streams, bitrates are calculated from their packet counters */
+    ctx.demux.close();
+    multInfo.processedPackets = ctx.demux.processedPackets();
+
+    // Streams which could not write their files have reported it on closing
+    bool streamsFailed = false;
+    for (const pair<const uint16_t, shared_ptr<PacketStream> > &stream : ctx.demux.streams()) {
+        MPEG2ServiceStream *serviceStream = dynamic_cast<MPEG2ServiceStream *>(stream.second.get());
+        streamsFailed = streamsFailed || (serviceStream && !*serviceStream);
+    }
+
+    if (createRootDirectory(ctx) != EXIT_SUCCESS) {
         return EXIT_FAILURE;
     }
-    if (filename.find('/') != string::npos) {
-        cerr << "Input transport stream filename should not contain '/'!" << endl;
+
+    /* Save program guides, programs are independent so they are rendered concurrently */
+    if (options.threads > 1 && multInfo.programs.size() > 1) {
+        ThreadPool pool(min<size_t>(options.threads, multInfo.programs.size()));
+        for (ProgramInfo &programInfo : multInfo.programs) {
+            pool.submit([&ctx, &programInfo] () {
+                saveProgramGuide(ctx.tables, programInfo);
+            });
+        }
+        pool.wait();
+    } else {
+        for (ProgramInfo &programInfo : multInfo.programs) {
+            saveProgramGuide(ctx.tables, programInfo);
+        }
+    }
+
+    /* Save multiplex info */
+    getNetworkInfo(ctx.tables, multInfo);
+    saveInfo(ctx);
+    saveStreamStatistics(ctx, options.statsFormat);
+
+    return (streamsFailed)? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * Result of the processing of one input file
+ */
+struct InputSummary {
+    InputSummary() : result(EXIT_FAILURE), bytes(0), packets(0), seconds(0) {}
+
+    string inputFile;
+    int result;
+    unsigned long long bytes;
+    long packets;
+    double seconds;
+};
+
+/**
+ * Parses positive number of the option, e.g. the count of the threads or the limit of the processing
+ * @param option Name of the option
+ * @param value Value of the option
+ * @param number Parsed number
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+template <class T>
+int parsePositive(const string &option, const char *value, T &number) {
+    char *endPtr;
+    long parsed = strtol(value, &endPtr, 10);
+    if (*value == '\0' || *endPtr != '\0' || parsed < 1) {
+        cerr << "Value of the option " << option << " should be a positive number!" << endl;
         return EXIT_FAILURE;
     }
-    filename = filename.substr(0, filename.size() - 3);
 
-    /* Open input MPEG-2 stream */
-    MPEG2FileInputStream is;
-    is.open(argv[1], ios::in | ifstream::binary );
+    number = parsed;
+    return EXIT_SUCCESS;
+}
 
-    if( !is ) {
-        cerr << "Failed to open file!" << endl;
+/**
+ * Parses time limit of the processing
+ * @param option Name of the option
+ * @param value Value of the option
+ * @param seconds Parsed time in seconds
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int parseSeconds(const string &option, const char *value, double &seconds) {
+    char *endPtr;
+    double parsed = strtod(value, &endPtr);
+    if (*value == '\0' || *endPtr != '\0' || !(parsed > 0)) {
+        cerr << "Value of the option " << option << " should be a positive number of seconds!" << endl;
         return EXIT_FAILURE;
     }
 
-    /* Read program specifiec tables */
-    PSITables tables;
-    if (readPSITables(is, tables) != EXIT_SUCCESS) {
-        cerr << "Unable to read some neccessary service information tables!" << endl;
-        is.close();
+    seconds = parsed;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Parses arguments of the application
+ * @param argc Number of the arguments
+ * @param argv Arguments
+ * @param options Parsed options
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        string arg(argv[i]);
+
+        if (arg == "--info-only") {
+            options.infoOnly = true;
+        } else if (arg == "--threads" || arg == "--jobs" || arg == "--list" || arg == "--max-packets" || arg == "--max-seconds"
+                   || arg == "--stats" || arg == "--stats-interval") {
+            if (i + 1 >= argc) {
+                cerr << "Missing value of the option " << arg << "!" << endl;
+                return EXIT_FAILURE;
+            }
+
+            const char *value = argv[++i];
+            if (arg == "--list") {
+                options.listFile = value;
+            } else if (arg == "--max-packets") {
+                if (parsePositive(arg, value, options.maxPackets) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            } else if (arg == "--max-seconds") {
+                if (parseSeconds(arg, value, options.maxSeconds) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            } else if (arg == "--stats") {
+                options.statsFormat = value;
+                if (options.statsFormat != "csv" && options.statsFormat != "json") {
+                    cerr << "Value of the option " << arg << " should be csv or json!" << endl;
+                    return EXIT_FAILURE;
+                }
+            } else if (arg == "--stats-interval") {
+                if (parseSeconds(arg, value, options.statsSeconds) != EXIT_SUCCESS) {
+                    return EXIT_FAILURE;
+                }
+            } else if (parsePositive(arg, value, (arg == "--threads")? options.threads : options.jobs) != EXIT_SUCCESS) {
+                return EXIT_FAILURE;
+            }
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+
+    /* Check that is passed the input file */
+    if (options.inputs.empty() && options.listFile.empty()) {
+        cerr << "Missing argument that specifies path to the file with MPEG-2 stream!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Collects input files from the arguments, directories and list file
+ * @param options Options of the application
+ * @param inputs Input files
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int collectInputs(const Options &options, vector<string> &inputs) {
+    vector<string> candidates;
+
+    for (const string &input : options.inputs) {
+        if (isDirectory(input)) {
+            if (listFiles(input, ".ts", candidates) != 0) {
+                cerr << "Unable to read directory \"" << input << "\"!" << endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            candidates.push_back(input);
+        }
+    }
+
+    if (!options.listFile.empty()) {
+        ifstream listInput(options.listFile);
+        if (!listInput) {
+            cerr << "Unable to open list of the input files \"" << options.listFile << "\"!" << endl;
+            return EXIT_FAILURE;
+        }
+
+        string line;
+        while (getline(listInput, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            if (!line.empty() && line[0] != '#') {
+                candidates.push_back(line);
+            }
+        }
+    }
+
+    /* Every input has its own output directory named by the file */
+    set<string> outputDirectories;
+    for (const string &input : candidates) {
+        if (!outputDirectories.insert(baseName(input)).second) {
+            cerr << "Input file \"" << input << "\" has the same name as other input file, it will be skipped!" << endl;
+            continue;
+        }
+        inputs.push_back(input);
+    }
+
+    if (inputs.empty()) {
+        cerr << "No input files with MPEG-2 stream were found!" << endl;
         return EXIT_FAILURE;
     }
 
-    /* Get info to parsed tables */
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Extracts multiplex of one input file into the directory named by the file
+ * @param inputFile Path to the file with MPEG2 transport stream
+ * @param options Options of the processing
+ * @param summary Result of the processing
+ * @return EXIT_SUCCESS on success, otherwise EXIT_FAILURE
+ */
+int processInput(const string &inputFile, const Options &options, InputSummary &summary) {
+    summary.inputFile = inputFile;
+
+    /* Parse filename with MPEG2 transport stream, output is stored into the current directory */
+    string filename = baseName(inputFile);
+    if (!hasExtension(filename, ".ts")) {
+        cerr << "Input transport stream filename should have an extension .ts!" << endl;
+        return summary.result = EXIT_FAILURE;
+    }
+    filename = filename.substr(0, filename.size() - 3);
+
+    /* Open input MPEG-2 stream, file is mapped into memory if possible */
+    MPEG2MappedInputStream mappedStream;
+    MPEG2FileInputStream fileStream;
+    MPEG2InputStream *is = &mappedStream;
+
+    if (!mappedStream.open(inputFile)) {
+        if( !fileStream.open(inputFile) ) {
+            cerr << "Failed to open file \"" << inputFile << "\"!" << endl;
+            return summary.result = EXIT_FAILURE;
+        }
+        is = &fileStream;
+    }
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    /* Read program specific tables and save multiplex info in one pass */
     MultiplexInfo multiplexInfo;
     multiplexInfo.fileName = filename;
-    if (getMultiplexInfo(tables, multiplexInfo) != EXIT_SUCCESS) {
-        cerr << "Unable to read informations about multiplex and services from information tables!" << endl;
-        is.close();
+    summary.result = extractMultiplex(*is, multiplexInfo, options);
+    if (summary.result != EXIT_SUCCESS) {
+        cerr << "Unable to save informations about multiplex!" << endl;
+    }
+
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    summary.packets = multiplexInfo.processedPackets;
+    summary.bytes = fileSize(inputFile);
+
+    mappedStream.close();
+    fileStream.close();
+
+    return summary.result;
+}
+
+/**
+ * Prints results of the batch processing and the total throughput
+ * @param summaries Results of the input files
+ * @param seconds Time of the whole processing
+ */
+void printBatchSummary(const vector<InputSummary> &summaries, double seconds) {
+    const double MEGABYTE = 1024.0 * 1024.0;
+    unsigned long long totalBytes = 0;
+    long totalPackets = 0;
+    size_t failed = 0;
+
+    cout << setprecision(2) << fixed;
+    for (const InputSummary &summary : summaries) {
+        cout << summary.inputFile << ": ";
+        if (summary.result != EXIT_SUCCESS) {
+            cout << "failed" << endl;
+            failed++;
+            continue;
+        }
+
+        cout << summary.packets << " packets, " << summary.bytes / MEGABYTE << " MB in " << summary.seconds << " s";
+        cout << " (" << ((summary.seconds > 0)? summary.bytes / MEGABYTE / summary.seconds : 0) << " MB/s)" << endl;
+        totalBytes += summary.bytes;
+        totalPackets += summary.packets;
+    }
+
+    cout << "Processed " << summaries.size() - failed << " of " << summaries.size() << " files, ";
+    cout << totalPackets << " packets, " << totalBytes / MEGABYTE << " MB in " << seconds << " s";
+    cout << " (" << ((seconds > 0)? totalBytes / MEGABYTE / seconds : 0) << " MB/s)" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (parseOptions(argc, argv, options) != EXIT_SUCCESS) {
         return EXIT_FAILURE;
     }
 
-    /* Save multiplex info */
-    if (saveMultiplexInfo(is, multiplexInfo) != EXIT_SUCCESS) {
-        cerr << "Unable to save informations about multiplex!" << endl;
-        is.close();
+    vector<string> inputs;
+    if (collectInputs(options, inputs) != EXIT_SUCCESS) {
         return EXIT_FAILURE;
     }
 
-    is.close();
+    /* Single file is processed directly */
+    bool batch = inputs.size() > 1 || !options.listFile.empty() || (options.inputs.size() == 1 && isDirectory(options.inputs[0]));
+    if (!batch) {
+        InputSummary summary;
+        return processInput(inputs[0], options, summary);
+    }
+
+    /* Files of the batch are processed concurrently, pool is sized to the machine by default */
+    unsigned int jobs = options.jobs;
+    if (jobs == 0) {
+        jobs = max(1u, ThreadPool::hardwareThreads() / options.threads);
+    }
+    jobs = min<size_t>(jobs, inputs.size());
+
+    vector<InputSummary> summaries(inputs.size());
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    {
+        ThreadPool pool(jobs);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            pool.submit([&inputs, &summaries, &options, i] () {
+                processInput(inputs[i], options, summaries[i]);
+            });
+        }
+        pool.wait();
+    }
+
+    printBatchSummary(summaries, chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+
+    for (const InputSummary &summary : summaries) {
+        if (summary.result != EXIT_SUCCESS) {
+            return EXIT_FAILURE;
+        }
+    }
 
     return EXIT_SUCCESS;
 }
@@ -3,8 +3,10 @@
 
 #if defined(_WIN32)
     #include <dirent.h>
+    #include <sys/stat.h>
 #else
     #include <sys/stat.h>
+    #include <dirent.h>
 #endif
 
 int createDirectory(string name) {
@@ -15,4 +17,47 @@ int createDirectory(string name) {
 #endif
 }
 
+bool isDirectory(const string &name) {
+    struct stat fileStat;
+    return stat(name.c_str(), &fileStat) == 0 && S_ISDIR(fileStat.st_mode);
+}
+
+unsigned long long fileSize(const string &name) {
+    struct stat fileStat;
+    return (stat(name.c_str(), &fileStat) == 0)? fileStat.st_size : 0;
+}
+
+string baseName(const string &path) {
+#if defined(_WIN32)
+    size_t separator = path.find_last_of("/\\");
+#else
+    size_t separator = path.find_last_of('/');
+#endif
+    return (separator != string::npos)? path.substr(separator + 1) : path;
+}
+
+bool hasExtension(const string &name, const string &extension) {
+    return name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+int listFiles(const string &directory, const string &extension, vector<string> &files) {
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        return -1;
+    }
+
+    vector<string> names;
+    for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+        string name(entry->d_name);
+        if (hasExtension(name, extension) && !isDirectory(directory + "/" + name)) {
+            names.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+
+    sort(names.begin(), names.end());
+    files.insert(files.end(), names.begin(), names.end());
+    return 0;
+}
+
 #endif // MISCELLANEOUS_H
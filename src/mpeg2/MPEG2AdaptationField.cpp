@@ -25,22 +25,74 @@
 using namespace std;
 
 /**
- * Reads adaptation fields from the data vector.
- * @param field Data vector with the adapation fields.
+ * Reads adaptation fields from the buffer.
+ * @param field Pointer to the adaptation field.
+ * @param size Number of bytes available for the adaptation field.
  */
-MPEG2AdaptationField::MPEG2AdaptationField(vector<uint8_t> &field) :length(0)
+MPEG2AdaptationField::MPEG2AdaptationField(const uint8_t *field, unsigned int size) :length(0),
+    discontinuityIndicator(false), randomAccessindicator(false), elementaryStreamPriorityIndicator(false), flags((AdaptationFieldFlags)0),
+    PCR(0), OPCR(0), spliceCountdown(0), privateDataLength(0), privateData(0), extensionLength(0)
 {
-    if (field.size() < ADAPTATION_FIELD_HEADER_SIZE) {
+    if (size < 1) {
         throw runtime_error ("Unable to read header of Adaptation field, too small!");
     }
 
     length = field[0];
     length = (length > ADAPTATION_FIELD_MAXSIZE)? ADAPTATION_FIELD_MAXSIZE : length;
+    totalLength = length + 1;
+
+    /* Field of zero length is only one stuffing byte */
+    if (length == 0) {
+        return;
+    }
+
+    if (size < totalLength) {
+        throw runtime_error ("Unable to read Adaptation field, too small!");
+    }
 
     discontinuityIndicator = field[1] & 0x80;
     randomAccessindicator = field[1] & 0x40;
     elementaryStreamPriorityIndicator = field[1] & 0x20;
     flags = (AdaptationFieldFlags)(field[1] & 0x1F);
 
-    totalLength = length + 1;
+    /* Optional fields follow in the order of their flags */
+    unsigned int offset = ADAPTATION_FIELD_HEADER_SIZE;
+    if (flags & AdaptationFieldFlags::PCR) {
+        if (offset + CLOCK_REFERENCE_SIZE > totalLength) {
+            throw runtime_error ("Adaptation field is too small for PCR!");
+        }
+        PCR = readClockReference(&field[offset]);
+        offset += CLOCK_REFERENCE_SIZE;
+    }
+
+    if (flags & AdaptationFieldFlags::OPCR) {
+        if (offset + CLOCK_REFERENCE_SIZE > totalLength) {
+            throw runtime_error ("Adaptation field is too small for OPCR!");
+        }
+        OPCR = readClockReference(&field[offset]);
+        offset += CLOCK_REFERENCE_SIZE;
+    }
+
+    if (flags & AdaptationFieldFlags::SplicingPoint) {
+        if (offset + 1 > totalLength) {
+            throw runtime_error ("Adaptation field is too small for splice countdown!");
+        }
+        spliceCountdown = (int8_t)field[offset++];
+    }
+
+    if (flags & AdaptationFieldFlags::TransportPrivateData) {
+        if (offset + 1 > totalLength || offset + 1 + field[offset] > totalLength) {
+            throw runtime_error ("Adaptation field is too small for private data!");
+        }
+        privateDataLength = field[offset++];
+        privateData = &field[offset];
+        offset += privateDataLength;
+    }
+
+    if (flags & AdaptationFieldFlags::AdaptationFieldExtension) {
+        if (offset + 1 > totalLength || offset + 1 + field[offset] > totalLength) {
+            throw runtime_error ("Adaptation field is too small for its extension!");
+        }
+        extensionLength = field[offset];
+    }
 }
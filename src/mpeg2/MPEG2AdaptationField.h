@@ -21,31 +21,41 @@
 #ifndef MPEG2ADAPTATIONFIELD_H
 #define MPEG2ADAPTATIONFIELD_H
 
-#include <vector>
-
 #include <cstdint>
 
 /**
  * The Adaptation Field Flags enum
  */
 enum AdaptationFieldFlags {
-    PCR                         = 0x01,
-    OPCR                        = 0x02,
+    AdaptationFieldExtension    = 0x01,
+    TransportPrivateData        = 0x02,
     SplicingPoint               = 0x04,
-    TransportPrivateData        = 0x08,
-    AdaptationFieldExtension    = 0x10
+    OPCR                        = 0x08,
+    PCR                         = 0x10
 };
 
 /**
- * Class representing adaptation fields of MPEG2 packet
+ * Class representing adaptation fields of MPEG2 packet. Private data are not
+ * copied, they point into the packet.
  */
 class MPEG2AdaptationField
 {
 protected:
     const unsigned int static ADAPTATION_FIELD_HEADER_SIZE          = 2;
     const unsigned int static ADAPTATION_FIELD_MAXSIZE              = 183;
+    const unsigned int static CLOCK_REFERENCE_SIZE                  = 6;
 public:
-    MPEG2AdaptationField(std::vector<uint8_t> &field);
+    MPEG2AdaptationField(const uint8_t *field, unsigned int size);
+
+    /**
+     * Reads 42-bit clock reference, 33-bit base and 9-bit extension.
+     * @param data Pointer to the clock reference.
+     * @return Clock reference in 27 MHz ticks.
+     */
+    static uint64_t readClockReference(const uint8_t *data) {
+        uint64_t base = (uint64_t)data[0] << 25 | (uint64_t)data[1] << 17 | (uint64_t)data[2] << 9 | (uint64_t)data[3] << 1 | data[4] >> 7;
+        return base * 300 + ((data[4] & 0x01) << 8 | data[5]);
+    }
 
     uint8_t length;
     bool discontinuityIndicator;
@@ -53,6 +63,13 @@ public:
     bool elementaryStreamPriorityIndicator;
     AdaptationFieldFlags flags;
 
+    uint64_t PCR;                       // 27 MHz ticks, valid with PCR flag
+    uint64_t OPCR;                      // 27 MHz ticks, valid with OPCR flag
+    int8_t spliceCountdown;             // packets until the splicing point, valid with SplicingPoint flag
+    uint8_t privateDataLength;
+    const uint8_t *privateData;         // valid with TransportPrivateData flag
+    uint8_t extensionLength;            // valid with AdaptationFieldExtension flag
+
     uint16_t totalLength;
 };
 
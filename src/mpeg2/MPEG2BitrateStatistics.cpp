@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2BitrateStatistics.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro měření datového toku streamů podle PCR
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2BitrateStatistics.cpp
+ *
+ * @brief Module for measuring the bitrates of the streams by PCR.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include "MPEG2BitrateStatistics.h"
+
+using namespace std;
+
+/**
+ * Constructs statistics without any measurement.
+ * @param clock Recovered time of the multiplex, it has to be advanced before the packet is put here.
+ */
+MPEG2BitrateStatistics::MPEG2BitrateStatistics(const MPEG2ClockRecovery &clock)
+    : clock(clock), started(false), slotStart(0), lastTime(0), closedSlots(0), slotTicks(WINDOW_SLOTS, 0), windowTicks(0), measuredTicks(0)
+{
+    fill(counterIndices, counterIndices + PID_COUNT, -1);
+}
+
+/**
+ * Returns counters of the PID, they are created for the first packet of the PID.
+ * @param PID PID of the packet.
+ * @return Counters of the PID.
+ */
+MPEG2BitrateStatistics::PIDCounters &MPEG2BitrateStatistics::pidCounters(uint16_t PID) {
+    int &index = counterIndices[PID & (PID_COUNT - 1)];
+    if (index == -1) {
+        PIDCounters pidCounters = {PID, 0, 0, 0, 0, vector<long>(WINDOW_SLOTS, 0), 0, 0};
+        index = counters.size();
+        counters.push_back(pidCounters);
+    }
+    return counters[index];
+}
+
+/**
+ * Counts the packet and closes the slot when the reference clock has advanced enough.
+ * Packets are moved into the open slot by PCR of the reference clock.
+ * @param packet Packet which has been routed.
+ */
+void MPEG2BitrateStatistics::put(const MPEG2PacketView &packet) {
+    uint16_t PID = packet.PID();
+    if (started) {
+        pidCounters(PID).pending++;
+    }
+
+    if (!packet.hasPCR() || PID != clock.referencePID()) {
+        return;
+    }
+
+    lastTime = clock.currentTime(PID);
+    if (!started) {
+        started = true;
+        slotStart = lastTime;
+        return;
+    }
+
+    for (PIDCounters &pid : counters) {
+        pid.current += pid.pending;
+        pid.pending = 0;
+    }
+
+    if (lastTime >= slotStart + SLOT_TICKS) {
+        closeSlot(lastTime);
+    }
+}
+
+/**
+ * Closes the open slot at the last PCR, it is called at the end of the input.
+ */
+void MPEG2BitrateStatistics::close() {
+    if (started && lastTime > slotStart) {
+        closeSlot(lastTime);
+    }
+}
+
+/**
+ * Moves packets of the open slot into the window and updates bitrates of the window.
+ * @param now Time of the end of the slot.
+ */
+void MPEG2BitrateStatistics::closeSlot(uint64_t now) {
+    unsigned int slot = closedSlots % WINDOW_SLOTS;
+    uint64_t ticks = now - slotStart;
+    bool windowFull = closedSlots + 1 >= WINDOW_SLOTS;
+
+    windowTicks += ticks - slotTicks[slot];
+    slotTicks[slot] = ticks;
+
+    for (PIDCounters &pid : counters) {
+        pid.windowPackets += pid.current - pid.slotPackets[slot];
+        pid.slotPackets[slot] = pid.current;
+        pid.packets += pid.current;
+        pid.current = 0;
+
+        if (windowFull) {
+            double rate = MPEG2ClockRecovery::bitrate(pid.windowPackets, windowTicks);
+            bool first = closedSlots + 1 == WINDOW_SLOTS;
+            pid.minimum = (first)? rate : min(pid.minimum, rate);
+            pid.maximum = (first)? rate : max(pid.maximum, rate);
+        }
+    }
+
+    closedSlots++;
+    measuredTicks += ticks;
+    slotStart = now;
+}
+
+/**
+ * @return True if some time has been measured.
+ */
+bool MPEG2BitrateStatistics::hasMeasurement() const {
+    return measuredTicks > 0;
+}
+
+/**
+ * @return Measured time in seconds.
+ */
+double MPEG2BitrateStatistics::measuredSeconds() const {
+    return (double)measuredTicks / MPEG2PacketView::PCR_CLOCK;
+}
+
+/**
+ * Returns measured bitrates of the PID. If the measured time is shorter
+ * than the window, the minimum and maximum equal the average.
+ * @param PID PID of the stream.
+ * @param bitrate Measured bitrates.
+ * @return True if the PID has been measured, otherwise false.
+ */
+bool MPEG2BitrateStatistics::summary(uint16_t PID, BitrateSummary &bitrate) const {
+    int index = counterIndices[PID & (PID_COUNT - 1)];
+    if (index == -1 || !hasMeasurement()) {
+        return false;
+    }
+
+    const PIDCounters &pid = counters[index];
+    bitrate.PID = PID;
+    bitrate.packets = pid.packets;
+    bitrate.average = MPEG2ClockRecovery::bitrate(pid.packets, measuredTicks);
+    bitrate.minimum = (closedSlots >= WINDOW_SLOTS)? pid.minimum : bitrate.average;
+    bitrate.maximum = (closedSlots >= WINDOW_SLOTS)? pid.maximum : bitrate.average;
+    return true;
+}
+
+/**
+ * @return Measured bitrates of all PIDs ordered by PID.
+ */
+vector<BitrateSummary> MPEG2BitrateStatistics::summaries() const {
+    vector<BitrateSummary> bitrates;
+    for (unsigned int PID = 0; PID < PID_COUNT; PID++) {
+        BitrateSummary bitrate;
+        if (summary(PID, bitrate)) {
+            bitrates.push_back(bitrate);
+        }
+    }
+    return bitrates;
+}
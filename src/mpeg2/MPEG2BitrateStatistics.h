@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2BitrateStatistics.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro měření datového toku streamů podle PCR
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2BitrateStatistics.h
+ *
+ * @brief Module for measuring the bitrates of the streams by PCR.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2BITRATESTATISTICS_H
+#define MPEG2BITRATESTATISTICS_H
+
+#include <vector>
+
+#include "MPEG2ClockRecovery.h"
+
+using namespace std;
+
+/**
+ * Measured bitrate of one PID in bits per second.
+ */
+struct BitrateSummary {
+    uint16_t PID;
+    long packets;           // packets in the measured time
+    double minimum;         // the slowest window
+    double average;         // whole measured time
+    double maximum;         // the fastest window
+};
+
+/**
+ * Measures bitrates of the PIDs by the time of the reference clock, i.e. the clock
+ * of PCR_PID of the first program. Measured time is split into the slots between
+ * PCRs at least SLOT_TICKS long, window of WINDOW_SLOTS last slots slides by one slot
+ * and the minimal and maximal bitrate of every PID is taken over these windows.
+ * Packets before the first and after the last PCR have no time, they are not measured.
+ * The last slot is shorter, it is closed at the last PCR when the input ends.
+ */
+class MPEG2BitrateStatistics {
+public:
+    const static uint64_t SLOT_TICKS            = MPEG2PacketView::PCR_CLOCK / 10;
+    const static unsigned int WINDOW_SLOTS      = 10;
+    const static unsigned int PID_COUNT         = 8192;
+
+    MPEG2BitrateStatistics(const MPEG2ClockRecovery &clock);
+
+    void put(const MPEG2PacketView &packet);
+    void close();
+
+    bool hasMeasurement() const;
+    double measuredSeconds() const;
+    bool summary(uint16_t PID, BitrateSummary &bitrate) const;
+    vector<BitrateSummary> summaries() const;
+
+protected:
+    /**
+     * Counters of one PID.
+     */
+    struct PIDCounters {
+        uint16_t PID;
+        long pending;               // packets after the last PCR
+        long current;               // packets in the open slot up to the last PCR
+        long packets;               // packets in the closed slots
+        long windowPackets;         // packets in the slots of the window
+        vector<long> slotPackets;   // ring of the window slots
+        double minimum;
+        double maximum;
+    };
+
+    const MPEG2ClockRecovery &clock;
+    vector<PIDCounters> counters;
+    int counterIndices[PID_COUNT];
+    bool started;
+    uint64_t slotStart;
+    uint64_t lastTime;
+    unsigned long closedSlots;
+    vector<uint64_t> slotTicks;
+    uint64_t windowTicks;
+    uint64_t measuredTicks;
+
+    PIDCounters &pidCounters(uint16_t PID);
+    void closeSlot(uint64_t now);
+};
+
+#endif // MPEG2BITRATESTATISTICS_H
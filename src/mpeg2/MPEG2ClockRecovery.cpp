@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2ClockRecovery.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro obnovu času multiplexu z PCR
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2ClockRecovery.cpp
+ *
+ * @brief Module for the recovery of the multiplex time from PCR.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include "MPEG2ClockRecovery.h"
+
+using namespace std;
+
+const uint64_t MPEG2ClockRecovery::PCR_MAXGAP;
+const uint64_t MPEG2ClockRecovery::PCR_MODULO;
+const uint64_t MPEG2ClockRecovery::SAMPLE_INTERVAL;
+
+/**
+ * Constructs recovery without any clock.
+ */
+MPEG2ClockRecovery::MPEG2ClockRecovery() : reference(-1), demandedPID(-1) {}
+
+/**
+ * Advances the clock of the packet PID, packets without PCR are ignored.
+ * @param packetIndex Index of the packet from the beginning of the input.
+ * @param packet Packet which may carry PCR.
+ */
+void MPEG2ClockRecovery::put(long packetIndex, const MPEG2PacketView &packet) {
+    if (!packet.hasAdaptationField()) {
+        return;
+    }
+
+    MPEG2AdaptationField field(packet.adaptationField(), MPEG2PacketView::PACKET_SIZE - MPEG2PacketView::HEADER_SIZE);
+    if (!(field.flags & AdaptationFieldFlags::PCR)) {
+        return;
+    }
+
+    uint16_t PID = packet.PID();
+    Sample sample = {packetIndex, (reference != -1)? currentTime(reference) : 0};
+
+    Clock &clock = clocks[PID];
+    if (reference == -1 || PID == demandedPID) {
+        reference = PID;
+    }
+
+    if (!clock.samples.empty()) {
+        const Sample &first = clock.samples.front();
+        const Sample &last = clock.samples.back();
+
+        uint64_t gap = (field.PCR + PCR_MODULO - clock.lastPCR) % PCR_MODULO;
+        if (field.discontinuityIndicator || gap > PCR_MAXGAP) {
+            // New time base, gap is estimated from the average bitrate
+            gap = (last.time > first.time)? (uint64_t)((double)(packetIndex - last.packet) * (last.time - first.time) / (last.packet - first.packet)) : 0;
+        }
+        sample.time = last.time + gap;
+        clock.previous = last;
+    }
+
+    /* Latest sample replaces the previous one until the interval is reached */
+    size_t count = clock.samples.size();
+    if (count >= 2 && clock.samples[count - 1].time - clock.samples[count - 2].time < SAMPLE_INTERVAL) {
+        clock.samples.back() = sample;
+    } else {
+        clock.samples.push_back(sample);
+    }
+
+    clock.lastPCR = field.PCR;
+}
+
+/**
+ * Demands the reference clock, it is used since the PID carries PCR.
+ * @param PID PID of the reference clock, i.e. PCR_PID of the program.
+ */
+void MPEG2ClockRecovery::setReferencePID(uint16_t PID) {
+    demandedPID = PID;
+    if (findClock(PID)) {
+        reference = PID;
+    }
+}
+
+/**
+ * @param PID PID of the clock.
+ * @return Clock of the PID, null if the PID has not carried PCR.
+ */
+const MPEG2ClockRecovery::Clock *MPEG2ClockRecovery::findClock(uint16_t PID) const {
+    map<uint16_t, Clock>::const_iterator clock = clocks.find(PID);
+    return (clock != clocks.end())? &clock->second : 0;
+}
+
+/**
+ * @return PID of the reference clock, -1 if there was no PCR.
+ */
+int MPEG2ClockRecovery::referencePID() const {
+    return reference;
+}
+
+/**
+ * Computes bitrate of the multiplex.
+ * @param packets Number of the packets.
+ * @param ticks Time of the packets in 27 MHz ticks.
+ * @return Bitrate in bits per second, zero if the time is unknown.
+ */
+double MPEG2ClockRecovery::bitrate(long packets, uint64_t ticks) {
+    if (ticks == 0) {
+        return 0;
+    }
+    return (double)packets * MPEG2PacketView::PACKET_SIZE * 8 * MPEG2PacketView::PCR_CLOCK / ticks;
+}
+
+/**
+ * @param PID PID of the clock.
+ * @return Bitrate of the multiplex between the last two PCRs in bits per second.
+ */
+double MPEG2ClockRecovery::instantBitrate(uint16_t PID) const {
+    const Clock *clock = findClock(PID);
+    if (!clock || clock->samples.size() < 2) {
+        return 0;
+    }
+
+    const Sample &last = clock->samples.back();
+    return bitrate(last.packet - clock->previous.packet, last.time - clock->previous.time);
+}
+
+/**
+ * @param PID PID of the clock.
+ * @return Bitrate of the multiplex between the first and the last PCR in bits per second.
+ */
+double MPEG2ClockRecovery::averageBitrate(uint16_t PID) const {
+    const Clock *clock = findClock(PID);
+    if (!clock || clock->samples.size() < 2) {
+        return 0;
+    }
+
+    const Sample &first = clock->samples.front();
+    const Sample &last = clock->samples.back();
+    return bitrate(last.packet - first.packet, last.time - first.time);
+}
+
+/**
+ * @param PID PID of the clock.
+ * @return Time of the last PCR in seconds since the first PCR of the multiplex.
+ */
+double MPEG2ClockRecovery::duration(uint16_t PID) const {
+    const Clock *clock = findClock(PID);
+    return (clock && !clock->samples.empty())? (double)clock->samples.back().time / MPEG2PacketView::PCR_CLOCK : 0;
+}
+
+/**
+ * @param PID PID of the clock.
+ * @return Time of the last PCR in 27 MHz ticks since the first PCR of the multiplex.
+ */
+uint64_t MPEG2ClockRecovery::currentTime(uint16_t PID) const {
+    const Clock *clock = findClock(PID);
+    return (clock && !clock->samples.empty())? clock->samples.back().time : 0;
+}
+
+/**
+ * Selects the samples between which is interpolated, outer samples are used for the extrapolation.
+ * @param upper Index of the first sample after the demanded position.
+ * @param count Number of the samples, at least two.
+ * @return Index of the first sample of the segment.
+ */
+size_t MPEG2ClockRecovery::segmentStart(size_t upper, size_t count) {
+    if (upper == 0) {
+        return 0;
+    }
+    return (upper >= count)? count - 2 : upper - 1;
+}
+
+/**
+ * Maps packet index to the time of the reference clock.
+ * @param packetIndex Index of the packet from the beginning of the input.
+ * @return Time of the packet in seconds since the first PCR of the multiplex, it is negative
+ * for the packets before it.
+ */
+double MPEG2ClockRecovery::timeAt(long packetIndex) const {
+    const Clock *clock = (reference != -1)? findClock(reference) : 0;
+    if (!clock || clock->samples.size() < 2) {
+        return 0;
+    }
+
+    const vector<Sample> &samples = clock->samples;
+    size_t upper = upper_bound(samples.begin(), samples.end(), packetIndex, [] (long packet, const Sample &sample) {
+        return packet < sample.packet;
+    }) - samples.begin();
+
+    const Sample &from = samples[segmentStart(upper, samples.size())];
+    const Sample &to = samples[segmentStart(upper, samples.size()) + 1];
+    double ticks = from.time + (double)(packetIndex - from.packet) * ((double)to.time - from.time) / (to.packet - from.packet);
+    return ticks / MPEG2PacketView::PCR_CLOCK;
+}
+
+/**
+ * Maps time of the reference clock to the packet index, it is used for seeking by time.
+ * @param seconds Time in seconds since the first PCR of the multiplex.
+ * @return Index of the packet from the beginning of the input, -1 if the time is unknown.
+ */
+long MPEG2ClockRecovery::packetAt(double seconds) const {
+    const Clock *clock = (reference != -1)? findClock(reference) : 0;
+    if (!clock || clock->samples.size() < 2) {
+        return -1;
+    }
+
+    const vector<Sample> &samples = clock->samples;
+    double ticks = seconds * MPEG2PacketView::PCR_CLOCK;
+    size_t upper = upper_bound(samples.begin(), samples.end(), ticks, [] (double time, const Sample &sample) {
+        return time < sample.time;
+    }) - samples.begin();
+
+    const Sample &from = samples[segmentStart(upper, samples.size())];
+    const Sample &to = samples[segmentStart(upper, samples.size()) + 1];
+    if (to.time == from.time) {
+        return from.packet;
+    }
+
+    long packet = from.packet + (long)((ticks - from.time) * (to.packet - from.packet) / ((double)to.time - from.time));
+    return max(packet, 0L);
+}
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2ClockRecovery.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro obnovu času multiplexu z PCR
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2ClockRecovery.h
+ *
+ * @brief Module for the recovery of the multiplex time from PCR.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2CLOCKRECOVERY_H
+#define MPEG2CLOCKRECOVERY_H
+
+#include <map>
+#include <vector>
+
+#include "MPEG2PacketView.h"
+
+using namespace std;
+
+/**
+ * Recovers time of the multiplex from PCR. Every PID which carries PCR,
+ * i.e. the PCR_PID of some program, has its own clock. Time of the clock is
+ * continuous, the wrapping of PCR is unfolded and the discontinuities are bridged
+ * by the average bitrate. The first clock starts at zero, the other clocks start
+ * at the time of the reference clock, so all of them share one time base.
+ *
+ * Reference clock is the clock of the demanded PID, i.e. the PCR_PID from PMT.
+ * The PID which carried PCR first is the reference until the demanded PID carries PCR.
+ *
+ * Clock keeps one sample per SAMPLE_INTERVAL and the latest sample, between
+ * them the packet index and the time are mapped linearly.
+ */
+class MPEG2ClockRecovery {
+public:
+    const static uint64_t PCR_MAXGAP            = 10ULL * MPEG2PacketView::PCR_CLOCK;  // larger gap is discontinuity
+    const static uint64_t PCR_MODULO            = (1ULL << 33) * 300;
+    const static uint64_t SAMPLE_INTERVAL       = MPEG2PacketView::PCR_CLOCK;
+
+    MPEG2ClockRecovery();
+
+    void put(long packetIndex, const MPEG2PacketView &packet);
+    void setReferencePID(uint16_t PID);
+
+    int referencePID() const;
+    double instantBitrate(uint16_t PID) const;
+    double averageBitrate(uint16_t PID) const;
+    double duration(uint16_t PID) const;
+    uint64_t currentTime(uint16_t PID) const;
+    double timeAt(long packetIndex) const;
+    long packetAt(double seconds) const;
+
+    static double bitrate(long packets, uint64_t ticks);
+
+protected:
+    /**
+     * Packet index with the time of the clock in 27 MHz ticks.
+     */
+    struct Sample {
+        long packet;
+        uint64_t time;
+    };
+
+    /**
+     * Clock of one PCR PID.
+     */
+    struct Clock {
+        Clock() : lastPCR(0) {}
+
+        vector<Sample> samples;
+        Sample previous;        // sample of the PCR before the last one
+        uint64_t lastPCR;
+    };
+
+    map<uint16_t, Clock> clocks;
+    int reference;
+    int demandedPID;
+
+    const Clock *findClock(uint16_t PID) const;
+    static size_t segmentStart(size_t upper, size_t count);
+};
+
+#endif // MPEG2CLOCKRECOVERY_H
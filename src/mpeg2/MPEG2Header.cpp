@@ -18,24 +18,18 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
-#include <stdexcept>
-
 #include "MPEG2Header.h"
 
 using namespace std;
 
 /**
  * Reads header of the MPEG2 packet.
- * @param field Data vector with the MPEG2 header.
+ * @param header Pointer to the 4 bytes of the MPEG2 header.
  */
-MPEG2Header::MPEG2Header(vector<uint8_t> &header)
+MPEG2Header::MPEG2Header(const uint8_t *header)
 {
-    if (header.size() < 4) {
-        throw runtime_error ("Expected packet with length at least 4 bytes");
-    }
-
     uint8_t header_byte;
-    uint8_t *packetPtr = &header[0];
+    const uint8_t *packetPtr = header;
     synByte = *packetPtr++;
 
     header_byte = *packetPtr++;
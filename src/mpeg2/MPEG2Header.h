@@ -21,8 +21,6 @@
 #ifndef MPEG2HEADER_H
 #define MPEG2HEADER_H
 
-#include <vector>
-
 #include <cstdint>
 
 /**
@@ -51,7 +49,7 @@ class MPEG2Header
 {
 public:
     static const uint8_t CONTINUITY_COUTER_SIZE   = 16;
-    MPEG2Header(std::vector<uint8_t> &header);
+    MPEG2Header(const uint8_t *header);
 
     uint8_t synByte;
     bool transportErrorIndicator;
@@ -18,49 +18,25 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
-#include <stdexcept>
-
-#include <cstdint>
+#include <algorithm>
 
 #include "MPEG2Packet.h"
 
 using namespace std;
 
 /**
- * Reads MPEG2 packet from the data vector.
- * @param field Data vector with the MPEG2 packet.
+ * Constructs empty MPEG2 packet.
  */
 MPEG2Packet::MPEG2Packet()
-    :header(0), adaptationField(0), payload(0)
 {
+    fill(data, data + PACKET_SIZE, 0);
 }
 
 /**
- * Reads MPEG2 packet from the data vector.
- * @param field Data vector with the MPEG2 packet.
+ * Copies MPEG2 packet from the view.
+ * @param packet View of the MPEG2 packet.
  */
-MPEG2Packet::MPEG2Packet(vector<uint8_t> &packet)
-    :header(0), adaptationField(0), payload(0)
+MPEG2Packet::MPEG2Packet(const MPEG2PacketView &packet)
 {
-    if (packet.size() != PACKET_SIZE) {
-        throw runtime_error ("Packet should have exactly the length 188 bytes!");
-    }
-
-    header = shared_ptr<MPEG2Header>(new MPEG2Header(packet));
-
-    vector<uint8_t> adaptationAndPayload(&packet[4], &packet[packet.size()]);
-
-    switch (header->adaptationFieldControl) {
-    case AdaptationFieldControl::NoAdaptationFields:
-        payload = shared_ptr<MPEG2Payload>(new MPEG2Payload(adaptationAndPayload));
-        break;
-    case AdaptationFieldControl::AdaptationFieldOnly:
-        adaptationField = shared_ptr<MPEG2AdaptationField>(new MPEG2AdaptationField(adaptationAndPayload));
-        break;
-    case AdaptationFieldControl::AdaptationFieldAndPayload:
-        adaptationField = shared_ptr<MPEG2AdaptationField>(new MPEG2AdaptationField(adaptationAndPayload));
-        vector<uint8_t> payloadOnly(&adaptationAndPayload[adaptationField->totalLength], &adaptationAndPayload[adaptationAndPayload.size()]);
-        payload = shared_ptr<MPEG2Payload>(new MPEG2Payload(payloadOnly));
-        break;
-    }
+    copy(packet.bytes(), packet.bytes() + PACKET_SIZE, data);
 }
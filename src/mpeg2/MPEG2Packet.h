@@ -21,31 +21,32 @@
 #ifndef MPEG2PACKET_H
 #define MPEG2PACKET_H
 
-#include <vector>
-#include <memory>
+#include <cstdint>
 
-#include "MPEG2Header.h"
-#include "MPEG2AdaptationField.h"
-#include "MPEG2Payload.h"
+#include "MPEG2PacketView.h"
 
 /**
- * Class representing MPEG2 packet
+ * Class representing MPEG2 packet which owns its data.
  */
 class MPEG2Packet
 {
 
 public:
     MPEG2Packet();
-    MPEG2Packet(std::vector<uint8_t> &packet);
-    virtual ~MPEG2Packet() {}
+    MPEG2Packet(const MPEG2PacketView &packet);
 
-    static const unsigned int PACKET_SIZE         = 188;
-    static const unsigned int HEADER_SIZE         = 4;
-    static const unsigned int PAYLOAD_MAXSIZE     = 184;
+    static const unsigned int PACKET_SIZE         = MPEG2PacketView::PACKET_SIZE;
+    static const unsigned int HEADER_SIZE         = MPEG2PacketView::HEADER_SIZE;
+    static const unsigned int PAYLOAD_MAXSIZE     = MPEG2PacketView::PAYLOAD_MAXSIZE;
 
-    std::shared_ptr<MPEG2Header> header;
-    std::shared_ptr<MPEG2AdaptationField> adaptationField;
-    std::shared_ptr<MPEG2Payload> payload;
+    /**
+     * @return View which provides access to the fields of the packet.
+     */
+    MPEG2PacketView view() const {
+        return MPEG2PacketView(data);
+    }
+
+    uint8_t data[PACKET_SIZE];
 };
 
 #endif // MPEG2PACKET_H
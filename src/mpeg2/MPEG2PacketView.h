@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2PacketView.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro čtení MPEG2 packetu přímo z bufferu.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2PacketView.h
+ *
+ * @brief Module which reads MPEG2 packet directly from the buffer.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2PACKETVIEW_H
+#define MPEG2PACKETVIEW_H
+
+#include <cstdint>
+
+#include "MPEG2Header.h"
+#include "MPEG2AdaptationField.h"
+
+/**
+ * Class which provides access to the MPEG2 packet stored in some buffer.
+ * View does not own the data, fields of the packet are decoded only
+ * when they are demanded, so no copy or allocation is done per packet.
+ */
+class MPEG2PacketView
+{
+public:
+    static const unsigned int PACKET_SIZE         = 188;
+    static const unsigned int HEADER_SIZE         = 4;
+    static const unsigned int PAYLOAD_MAXSIZE     = 184;
+    static const unsigned int ADAPTATION_FIELD_MAXSIZE = 183;
+    static const unsigned int PCR_SIZE            = 6;
+    static const uint32_t PCR_CLOCK               = 27000000;     // PCR ticks per second
+
+    MPEG2PacketView() : data(0) {}
+    explicit MPEG2PacketView(const uint8_t *data) : data(data) {}
+
+    /**
+     * @return Pointer to the beginning of the packet.
+     */
+    const uint8_t *bytes() const {
+        return data;
+    }
+
+    uint8_t synByte() const {
+        return data[0];
+    }
+
+    bool transportErrorIndicator() const {
+        return data[1] & 0x80;
+    }
+
+    bool payloadUnitStartIndicator() const {
+        return data[1] & 0x40;
+    }
+
+    bool transportPriority() const {
+        return data[1] & 0x20;
+    }
+
+    uint16_t PID() const {
+        return (data[1] & 0x1F) << 8 | data[2];
+    }
+
+    ScramblingControl scramblingControl() const {
+        return static_cast<ScramblingControl>((data[3] & 0xC0) >> 6);
+    }
+
+    AdaptationFieldControl adaptationFieldControl() const {
+        return static_cast<AdaptationFieldControl>((data[3] & 0x30) >> 4);
+    }
+
+    uint8_t continuityCounter() const {
+        return data[3] & 0x0F;
+    }
+
+    bool hasAdaptationField() const {
+        return data[3] & 0x20;
+    }
+
+    bool hasPayload() const {
+        return data[3] & 0x10;
+    }
+
+    /**
+     * @return Pointer to the adaptation field, or null pointer if packet does not contain it.
+     */
+    const uint8_t *adaptationField() const {
+        return (hasAdaptationField())? data + HEADER_SIZE : 0;
+    }
+
+    /**
+     * @return Size of the adaptation field including its length byte, zero if packet does not contain it.
+     */
+    unsigned int adaptationFieldSize() const {
+        if (!hasAdaptationField()) {
+            return 0;
+        }
+        unsigned int length = data[HEADER_SIZE];
+        return ((length > ADAPTATION_FIELD_MAXSIZE)? ADAPTATION_FIELD_MAXSIZE : length) + 1;
+    }
+
+    /**
+     * @return True if the adaptation field carries program clock reference.
+     */
+    bool hasPCR() const {
+        return hasAdaptationField() && data[HEADER_SIZE] >= PCR_SIZE + 1 && (data[HEADER_SIZE + 1] & AdaptationFieldFlags::PCR);
+    }
+
+    /**
+     * @return Program clock reference in 27 MHz ticks, valid only if hasPCR() is true.
+     */
+    uint64_t PCR() const {
+        return MPEG2AdaptationField::readClockReference(data + HEADER_SIZE + 2);
+    }
+
+    /**
+     * @return Pointer to the payload of the packet.
+     */
+    const uint8_t *payload() const {
+        return data + HEADER_SIZE + adaptationFieldSize();
+    }
+
+    /**
+     * @return Size of the payload, zero if packet does not transfer any payload.
+     */
+    unsigned int payloadSize() const {
+        return (hasPayload())? PAYLOAD_MAXSIZE - adaptationFieldSize() : 0;
+    }
+
+protected:
+    const uint8_t *data;
+};
+
+#endif // MPEG2PACKETVIEW_H
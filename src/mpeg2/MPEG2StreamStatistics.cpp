@@ -0,0 +1,288 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2StreamStatistics.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul se statistikami streamů v časových intervalech
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2StreamStatistics.cpp
+ *
+ * @brief Module with the statistics of the streams in the time intervals.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <iomanip>
+
+#include "MPEG2StreamStatistics.h"
+
+using namespace std;
+
+/**
+ * Constructs statistics with one empty bucket.
+ * @param clock Recovered time of the multiplex, it has to be advanced before the packet is put here.
+ * @param bucketSeconds Width of the bucket in seconds.
+ * @param bucketsCount Maximal number of the kept buckets.
+ */
+MPEG2StreamStatistics::MPEG2StreamStatistics(const MPEG2ClockRecovery &clock, double bucketSeconds, size_t bucketsCount)
+    : clock(clock), bucketTicks(max<uint64_t>(1, (uint64_t)(bucketSeconds * MPEG2PacketView::PCR_CLOCK))),
+      capacity(max<size_t>(1, bucketsCount)), buckets(1), firstBucket(0), currentBucket(0)
+{
+    fill(stateIndices, stateIndices + PID_COUNT, -1);
+}
+
+/**
+ * Returns index of the state of the PID, state is created for the first packet of the PID.
+ * @param PID PID of the packet.
+ * @return Index of the state.
+ */
+int MPEG2StreamStatistics::stateIndex(uint16_t PID) {
+    int &index = stateIndices[PID & (PID_COUNT - 1)];
+    if (index == -1) {
+        PIDState state = {PID, -1, false, 0, false};
+        index = states.size();
+        states.push_back(state);
+    }
+    return index;
+}
+
+/**
+ * @param bucket Absolute number of the bucket.
+ * @return Counters of the bucket from the ring.
+ */
+vector<StreamCounters> &MPEG2StreamStatistics::bucketCounters(unsigned long bucket) {
+    size_t slot = bucket % capacity;
+    if (slot >= buckets.size()) {
+        buckets.resize(slot + 1);
+    }
+    return buckets[slot];
+}
+
+/**
+ * @param bucket Absolute number of the bucket.
+ * @return Counters of the bucket from the ring.
+ */
+const vector<StreamCounters> &MPEG2StreamStatistics::bucketCounters(unsigned long bucket) const {
+    const static vector<StreamCounters> EMPTY;
+    size_t slot = bucket % capacity;
+    return (slot < buckets.size())? buckets[slot] : EMPTY;
+}
+
+/**
+ * Opens buckets up to the time, the oldest buckets are dropped when the ring is full.
+ * @param now Time of the reference clock in 27 MHz ticks.
+ */
+void MPEG2StreamStatistics::advance(uint64_t now) {
+    unsigned long bucket = now / bucketTicks;
+    if (bucket <= currentBucket) {
+        return;
+    }
+
+    // Whole ring is replaced after the long gap
+    unsigned long from = (bucket - currentBucket > capacity)? bucket - capacity + 1 : currentBucket + 1;
+    for (unsigned long newBucket = from; newBucket <= bucket; newBucket++) {
+        bucketCounters(newBucket).clear();
+    }
+
+    currentBucket = bucket;
+    if (currentBucket - firstBucket >= capacity) {
+        firstBucket = currentBucket - capacity + 1;
+    }
+}
+
+/**
+ * Counts continuity error of the packet. Counter is raised only by the packets with
+ * the payload, one duplicate packet is allowed and the discontinuity indicator
+ * of the adaptation field starts the counting again.
+ * @param state State of the packet PID.
+ * @param counters Counters of the packet PID in the current bucket.
+ * @param packet Packet to be checked.
+ */
+void MPEG2StreamStatistics::checkContinuity(PIDState &state, StreamCounters &counters, const MPEG2PacketView &packet) {
+    if (state.PID == NULL_PID || !packet.hasPayload()) {
+        return;
+    }
+
+    int continuityCounter = packet.continuityCounter();
+    bool discontinuity = packet.adaptationFieldSize() > 1 && (packet.adaptationField()[1] & 0x80);
+
+    if (state.continuityCounter != -1 && !discontinuity) {
+        if (continuityCounter == state.continuityCounter) {
+            counters.continuityErrors += (state.duplicateSeen)? 1 : 0;
+            state.duplicateSeen = true;
+            return;
+        }
+
+        if (continuityCounter != ((state.continuityCounter + 1) & 0x0F)) {
+            counters.continuityErrors++;
+        }
+    }
+
+    state.continuityCounter = continuityCounter;
+    state.duplicateSeen = false;
+}
+
+/**
+ * Counts PCR of the packet and measures its interval, intervals over discontinuities are ignored.
+ * @param state State of the packet PID.
+ * @param counters Counters of the packet PID in the current bucket.
+ * @param packet Packet to be checked.
+ */
+void MPEG2StreamStatistics::checkPCR(PIDState &state, StreamCounters &counters, const MPEG2PacketView &packet) {
+    if (!packet.hasPCR()) {
+        return;
+    }
+
+    uint64_t PCR = packet.PCR();
+    if (state.hasPCR) {
+        uint64_t interval = (PCR + MPEG2ClockRecovery::PCR_MODULO - state.lastPCR) % MPEG2ClockRecovery::PCR_MODULO;
+        if (interval <= MPEG2ClockRecovery::PCR_MAXGAP) {
+            counters.maxPCRInterval = max(counters.maxPCRInterval, interval);
+        }
+    }
+
+    counters.PCRs++;
+    state.lastPCR = PCR;
+    state.hasPCR = true;
+}
+
+/**
+ * Counts the packet into the bucket of the current time.
+ * @param packet Packet which has been routed.
+ */
+void MPEG2StreamStatistics::put(const MPEG2PacketView &packet) {
+    uint16_t PID = packet.PID();
+    if (packet.hasPCR() && PID == clock.referencePID()) {
+        advance(clock.currentTime(PID));
+    }
+
+    int index = stateIndex(PID);
+    vector<StreamCounters> &bucket = bucketCounters(currentBucket);
+    if ((int)bucket.size() <= index) {
+        StreamCounters empty = {0, 0, 0, 0, 0, 0};
+        bucket.resize(states.size(), empty);
+    }
+
+    StreamCounters &counters = bucket[index];
+    PIDState &state = states[index];
+
+    counters.packets++;
+    counters.bytes += packet.payloadSize();
+    counters.scrambledPackets += (packet.scramblingControl() != NotScrambled)? 1 : 0;
+
+    checkContinuity(state, counters, packet);
+    checkPCR(state, counters, packet);
+}
+
+/**
+ * @return Width of the bucket in seconds.
+ */
+double MPEG2StreamStatistics::bucketSeconds() const {
+    return (double)bucketTicks / MPEG2PacketView::PCR_CLOCK;
+}
+
+/**
+ * @return Number of the kept buckets, the last one may be incomplete.
+ */
+size_t MPEG2StreamStatistics::bucketsCount() const {
+    return currentBucket - firstBucket + 1;
+}
+
+/**
+ * @param bucket Index of the kept bucket, zero is the oldest one.
+ * @return Start of the bucket in seconds since the first PCR of the multiplex.
+ */
+double MPEG2StreamStatistics::bucketTime(size_t bucket) const {
+    return (firstBucket + bucket) * bucketSeconds();
+}
+
+/**
+ * @param bucket Index of the kept bucket, zero is the oldest one.
+ * @param PID PID of the stream.
+ * @return Counters of the PID in the bucket, null if the PID has no packet in it.
+ */
+const StreamCounters *MPEG2StreamStatistics::counters(size_t bucket, uint16_t PID) const {
+    int index = stateIndices[PID & (PID_COUNT - 1)];
+    const vector<StreamCounters> &counters = bucketCounters(firstBucket + bucket);
+    if (index == -1 || (int)counters.size() <= index || counters[index].packets == 0) {
+        return 0;
+    }
+    return &counters[index];
+}
+
+/**
+ * @return PIDs with some packet ordered by PID.
+ */
+vector<uint16_t> MPEG2StreamStatistics::PIDs() const {
+    vector<uint16_t> PIDs;
+    for (const PIDState &state : states) {
+        PIDs.push_back(state.PID);
+    }
+    sort(PIDs.begin(), PIDs.end());
+    return PIDs;
+}
+
+/**
+ * Writes time series as CSV, one line per bucket and PID with some packet.
+ * @param output Output stream.
+ */
+void MPEG2StreamStatistics::writeCSV(ostream &output) const {
+    vector<uint16_t> PIDs = this->PIDs();
+
+    output << "time,pid,packets,bytes,bitrate,continuity_errors,scrambled_packets,pcr_count,max_pcr_interval_ms\n";
+    for (size_t bucket = 0; bucket < bucketsCount(); bucket++) {
+        for (uint16_t PID : PIDs) {
+            const StreamCounters *pidCounters = counters(bucket, PID);
+            if (!pidCounters) {
+                continue;
+            }
+
+            output << fixed << setprecision(3) << bucketTime(bucket) << ",";
+            output << "0x" << hex << setfill('0') << setw(4) << PID << dec << ",";
+            output << pidCounters->packets << "," << pidCounters->bytes << ",";
+            output << setprecision(0) << (double)pidCounters->packets * MPEG2PacketView::PACKET_SIZE * 8 / bucketSeconds() << ",";
+            output << pidCounters->continuityErrors << "," << pidCounters->scrambledPackets << "," << pidCounters->PCRs << ",";
+            output << setprecision(3) << (double)pidCounters->maxPCRInterval * 1000 / MPEG2PacketView::PCR_CLOCK << "\n";
+        }
+    }
+}
+
+/**
+ * Writes time series as JSON, buckets contain PIDs with some packet.
+ * @param output Output stream.
+ */
+void MPEG2StreamStatistics::writeJSON(ostream &output) const {
+    vector<uint16_t> PIDs = this->PIDs();
+
+    output << fixed << setprecision(3);
+    output << "{\n  \"bucket_seconds\": " << bucketSeconds() << ",\n  \"buckets\": [";
+    for (size_t bucket = 0; bucket < bucketsCount(); bucket++) {
+        output << ((bucket > 0)? "," : "") << "\n    {\"time\": " << bucketTime(bucket) << ", \"pids\": [";
+
+        bool first = true;
+        for (uint16_t PID : PIDs) {
+            const StreamCounters *pidCounters = counters(bucket, PID);
+            if (!pidCounters) {
+                continue;
+            }
+
+            output << ((first)? "" : ",") << "\n      {\"pid\": " << PID;
+            output << ", \"packets\": " << pidCounters->packets << ", \"bytes\": " << pidCounters->bytes;
+            output << ", \"bitrate\": " << setprecision(0) << (double)pidCounters->packets * MPEG2PacketView::PACKET_SIZE * 8 / bucketSeconds() << setprecision(3);
+            output << ", \"continuity_errors\": " << pidCounters->continuityErrors << ", \"scrambled_packets\": " << pidCounters->scrambledPackets;
+            output << ", \"pcr_count\": " << pidCounters->PCRs;
+            output << ", \"max_pcr_interval_ms\": " << (double)pidCounters->maxPCRInterval * 1000 / MPEG2PacketView::PCR_CLOCK << "}";
+            first = false;
+        }
+
+        output << ((first)? "]}" : "\n    ]}");
+    }
+    output << "\n  ]\n}\n";
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2StreamStatistics.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul se statistikami streamů v časových intervalech
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2StreamStatistics.h
+ *
+ * @brief Module with the statistics of the streams in the time intervals.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2STREAMSTATISTICS_H
+#define MPEG2STREAMSTATISTICS_H
+
+#include <vector>
+#include <ostream>
+
+#include "MPEG2ClockRecovery.h"
+
+using namespace std;
+
+/**
+ * Counters of one PID in one time bucket.
+ */
+struct StreamCounters {
+    long packets;
+    unsigned long long bytes;           // payload bytes
+    unsigned long continuityErrors;
+    unsigned long scrambledPackets;
+    unsigned long PCRs;
+    uint64_t maxPCRInterval;            // 27 MHz ticks
+};
+
+/**
+ * Aggregates counters of the PIDs into the buckets of the fixed width, the time is
+ * taken from the reference clock of the multiplex. Buckets are kept in the ring,
+ * when it is full, the oldest bucket is dropped, so the memory does not grow
+ * with the length of the input. Packets before the first PCR go into the first bucket.
+ */
+class MPEG2StreamStatistics {
+public:
+    const static unsigned int PID_COUNT         = 8192;
+    const static uint16_t NULL_PID              = 0x1FFF;
+    const static size_t DEFAULT_BUCKETS         = 43200;    // 12 hours of 1 s buckets
+
+    MPEG2StreamStatistics(const MPEG2ClockRecovery &clock, double bucketSeconds, size_t bucketsCount = DEFAULT_BUCKETS);
+
+    void put(const MPEG2PacketView &packet);
+
+    double bucketSeconds() const;
+    size_t bucketsCount() const;
+    double bucketTime(size_t bucket) const;
+    const StreamCounters *counters(size_t bucket, uint16_t PID) const;
+    vector<uint16_t> PIDs() const;
+
+    void writeCSV(ostream &output) const;
+    void writeJSON(ostream &output) const;
+
+protected:
+    /**
+     * State of the PID which is kept between the buckets.
+     */
+    struct PIDState {
+        uint16_t PID;
+        int continuityCounter;          // -1 before the first payload
+        bool duplicateSeen;
+        uint64_t lastPCR;
+        bool hasPCR;
+    };
+
+    const MPEG2ClockRecovery &clock;
+    uint64_t bucketTicks;
+    size_t capacity;
+    vector<vector<StreamCounters> > buckets;    // ring, counters by the index of the PID state
+    unsigned long firstBucket;                  // absolute number of the oldest kept bucket
+    unsigned long currentBucket;                // absolute number of the newest bucket
+    vector<PIDState> states;
+    int stateIndices[PID_COUNT];
+
+    int stateIndex(uint16_t PID);
+    void advance(uint64_t now);
+    void checkContinuity(PIDState &state, StreamCounters &counters, const MPEG2PacketView &packet);
+    void checkPCR(PIDState &state, StreamCounters &counters, const MPEG2PacketView &packet);
+    vector<StreamCounters> &bucketCounters(unsigned long bucket);
+    const vector<StreamCounters> &bucketCounters(unsigned long bucket) const;
+};
+
+#endif // MPEG2STREAMSTATISTICS_H
@@ -30,34 +30,71 @@ const static uint8_t PES_DATA_HEADER_SEQUENCE_ARR[] = { 0x00, 0x00, 0x01, 0xB3 }
 const vector<uint8_t> PacketElementaryStream::PES_DATA_HEADER_SEQUENCE(PES_DATA_HEADER_SEQUENCE_ARR, PES_DATA_HEADER_SEQUENCE_ARR + sizeof PES_DATA_HEADER_SEQUENCE_ARR / sizeof PES_DATA_HEADER_SEQUENCE_ARR[ 0 ]);
 
 /**
- * Constructs PES packet from data vector
- * @param streamData Data vector which contains PES packet.
+ * Constructs PES packet over the assembled payload
+ * @param PESHeader Header of the PES.
+ * @param PESExtension Extension of the PES header, it may be null.
+ * @param data Payload of the PES.
+ * @param size Size of the payload.
  */
-PacketElementaryStream::PacketElementaryStream(vector<uint8_t> &streamData)
-    :streamData(streamData) {
+PacketElementaryStream::PacketElementaryStream(const PacketElementaryStreamHeader *PESHeader, const PacketElementaryStreamExtension *PESExtension, const uint8_t *data, size_t size)
+    : PESHeader(PESHeader), PESExtension(PESExtension), data(data), size(size) {
+    if (!PESHeader) {
+        throw runtime_error ("PES packet should contain PES header!");
+    }
+}
 
+/**
+ * @return True if the packet carries presentation timestamp.
+ */
+bool PacketElementaryStream::hasPTS() const {
+    return PESExtension && PESExtension->hasPTS();
 }
 
 /**
- * Constructs PES packet from PES fragments
- * @param fragments vector of PES fragments.
+ * @return Presentation timestamp in 90 kHz ticks, zero if it is not present.
  */
-PacketElementaryStream::PacketElementaryStream(vector<PacketElementaryStreamFragment> &fragments) {
-    if (fragments.empty()) {
-        throw runtime_error ("There should be at least one fragment!");
-    }
+uint64_t PacketElementaryStream::PTS() const {
+    return (PESExtension)? PESExtension->PTS() : 0;
+}
 
-    PacketElementaryStreamFragment &firstFragment = fragments.front();
-    if (!firstFragment.PESHeader) {
-        throw runtime_error ("First fragment should contain PES header!");
-    }
+/**
+ * @return True if the packet carries decoding timestamp.
+ */
+bool PacketElementaryStream::hasDTS() const {
+    return PESExtension && PESExtension->hasDTS();
+}
 
-    PESHeader = firstFragment.PESHeader;
-    PESExtension = firstFragment.PESExtension;
+/**
+ * @return Decoding timestamp in 90 kHz ticks, it equals PTS if only PTS is present.
+ */
+uint64_t PacketElementaryStream::DTS() const {
+    return (hasDTS())? PESExtension->DTS() : PTS();
+}
 
-    /* Copies all fragments into current stream */
-    for (const PacketElementaryStreamFragment &currFragment : fragments) {
-        streamData.resize(streamData.size() + currFragment.streamData.size());
-        copy ( currFragment.streamData.begin(), currFragment.streamData.end(), &streamData[streamData.size() - currFragment.streamData.size()] );
-    }
+/**
+ * @return True if the packet carries elementary stream clock reference.
+ */
+bool PacketElementaryStream::hasESCR() const {
+    return PESExtension && PESExtension->hasESCR();
+}
+
+/**
+ * @return Elementary stream clock reference in 27 MHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStream::ESCR() const {
+    return (PESExtension)? PESExtension->ESCR() : 0;
+}
+
+/**
+ * @return True if the packet carries rate of the elementary stream.
+ */
+bool PacketElementaryStream::hasESRate() const {
+    return PESExtension && PESExtension->hasESRate();
+}
+
+/**
+ * @return Rate of the elementary stream in units of 50 bytes per second, zero if it is not present.
+ */
+uint32_t PacketElementaryStream::ESRate() const {
+    return (PESExtension)? PESExtension->ESRate() : 0;
 }
@@ -26,24 +26,31 @@
 using namespace std;
 
 /**
- * Class for storing packet element stream fragments.
+ * Class representing complete PES packet. Header and payload are not owned by the packet,
+ * they point into the assembler and they are valid only during the callback.
  */
 class PacketElementaryStream
 {
-protected:
-    PacketElementaryStream() {}
-
 public:
-    PacketElementaryStream(vector<uint8_t> &streamData);
-    PacketElementaryStream(vector<PacketElementaryStreamFragment> &fragments);
+    PacketElementaryStream(const PacketElementaryStreamHeader *PESHeader, const PacketElementaryStreamExtension *PESExtension, const uint8_t *data, size_t size);
 
     const unsigned int static PES_DATA_HEADER_SIZE = 4;
     const static vector<uint8_t> PES_DATA_HEADER_PREFIX;
     const static vector<uint8_t> PES_DATA_HEADER_SEQUENCE;
 
-    shared_ptr<PacketElementaryStreamHeader> PESHeader;
-    shared_ptr<PacketElementaryStreamExtension> PESExtension;
-    vector<uint8_t> streamData;
+    bool hasPTS() const;
+    uint64_t PTS() const;
+    bool hasDTS() const;
+    uint64_t DTS() const;
+    bool hasESCR() const;
+    uint64_t ESCR() const;
+    bool hasESRate() const;
+    uint32_t ESRate() const;
+
+    const PacketElementaryStreamHeader *PESHeader;
+    const PacketElementaryStreamExtension *PESExtension;     // null if the stream has no optional header
+    const uint8_t *data;
+    size_t size;
 };
 
 #endif // PACKETELEMENTARYSTREAM_H
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          PacketElementaryStreamAssembler.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro skládání PES packetů z fragmentů
+ *
+ ******************************************************************************/
+
+/**
+ * @file PacketElementaryStreamAssembler.cpp
+ *
+ * @brief Module for assembling the PES packets from the fragments.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include <cstring>
+
+#include "PacketElementaryStreamAssembler.h"
+
+/**
+ * Constructs assembler without any packet.
+ */
+PacketElementaryStreamAssembler::PacketElementaryStreamAssembler()
+    : started(false), hasExtension(false), extensionData(MAX_EXTENSION_SIZE), used(0), expected(0) {}
+
+/**
+ * Starts new packet with the fragment which carries the PES header.
+ * Packet which has not been taken yet is dropped.
+ * @param fragment First fragment of the packet.
+ */
+void PacketElementaryStreamAssembler::start(const PacketElementaryStreamFragment &fragment) {
+    reset();
+
+    if (!fragment.PESHeader) {
+        return;
+    }
+
+    started = true;
+    header = *fragment.PESHeader;
+
+    /* Extension is decoded from its own copy, the fragment points into the packet */
+    if (fragment.PESExtension) {
+        const PacketElementaryStreamExtension &source = *fragment.PESExtension;
+        extensionData[0] = source.flags;
+        extensionData[1] = source.optionalFlags;
+        extensionData[2] = source.length;
+        memcpy(&extensionData[3], source.headerData, source.headerDataSize);
+        extension = PacketElementaryStreamExtension(extensionData.data(), source.totalLength);
+        hasExtension = true;
+    }
+
+    /* Packet length counts also the extension of the header */
+    size_t extensionLength = (hasExtension)? extension.totalLength : 0;
+    if (header.packetLength > extensionLength) {
+        expected = header.packetLength - extensionLength;
+        if (buffer.size() < expected) {
+            buffer.resize(expected);
+        }
+    }
+
+    write(fragment.data, fragment.size);
+}
+
+/**
+ * Appends next fragment of the packet, fragments without started packet are ignored.
+ * @param fragment Fragment of the packet.
+ */
+void PacketElementaryStreamAssembler::append(const PacketElementaryStreamFragment &fragment) {
+    if (started) {
+        write(fragment.data, fragment.size);
+    }
+}
+
+/**
+ * Copies data into the buffer, data over the expected size of the packet are dropped.
+ * @param data Data of the fragment.
+ * @param size Size of the data.
+ */
+void PacketElementaryStreamAssembler::write(const uint8_t *data, size_t size) {
+    if (expected > 0) {
+        size = min(size, expected - min(used, expected));
+    }
+
+    if (size == 0) {
+        return;
+    }
+
+    if (used + size > buffer.size()) {
+        buffer.resize(max(used + size, 2 * buffer.size()));
+    }
+
+    memcpy(&buffer[used], data, size);
+    used += size;
+}
+
+/**
+ * Forgets the packet, buffer is kept for the next packets.
+ */
+void PacketElementaryStreamAssembler::reset() {
+    started = false;
+    hasExtension = false;
+    used = 0;
+    expected = 0;
+}
+
+/**
+ * @return True if some packet has been started.
+ */
+bool PacketElementaryStreamAssembler::pending() const {
+    return started;
+}
+
+/**
+ * @return True if the packet has known length and all its data were recieved.
+ */
+bool PacketElementaryStreamAssembler::complete() const {
+    return started && expected > 0 && used >= expected;
+}
+
+/**
+ * Returns the packet, its header and data are valid until the assembler is changed.
+ * @return Assembled packet.
+ */
+PacketElementaryStream PacketElementaryStreamAssembler::packet() const {
+    return PacketElementaryStream((started)? &header : 0, (hasExtension)? &extension : 0, buffer.data(), used);
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          PacketElementaryStreamAssembler.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro skládání PES packetů z fragmentů
+ *
+ ******************************************************************************/
+
+/**
+ * @file PacketElementaryStreamAssembler.h
+ *
+ * @brief Module for assembling the PES packets from the fragments.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef PACKETELEMENTARYSTREAMASSEMBLER_H
+#define PACKETELEMENTARYSTREAMASSEMBLER_H
+
+#include "PacketElementaryStream.h"
+
+using namespace std;
+
+/**
+ * Assembles PES packet from the fragments. Payload of every fragment is copied
+ * only once into the buffer which is reused by the following packets. Buffer is
+ * reserved for the whole packet if its length is known from the PES header.
+ * Header of the packet is copied as well, so it outlives the first fragment.
+ */
+class PacketElementaryStreamAssembler
+{
+public:
+    const static unsigned int MAX_EXTENSION_SIZE = 3 + 255;
+
+    PacketElementaryStreamAssembler();
+
+    void start(const PacketElementaryStreamFragment &fragment);
+    void append(const PacketElementaryStreamFragment &fragment);
+    void reset();
+
+    bool pending() const;
+    bool complete() const;
+    PacketElementaryStream packet() const;
+
+protected:
+    bool started;
+    bool hasExtension;
+    PacketElementaryStreamHeader header;
+    PacketElementaryStreamExtension extension;
+    vector<uint8_t> extensionData;      // copy of the extension bytes, extension points into it
+    vector<uint8_t> buffer;
+    size_t used;
+    size_t expected;        // size of the payload, zero if it is unbounded
+
+    void write(const uint8_t *data, size_t size);
+};
+
+#endif // PACKETELEMENTARYSTREAMASSEMBLER_H
@@ -19,97 +19,426 @@
  */
 
 #include <stdexcept>
-#include <iterator>
 
 #include "PacketElementaryStreamFragment.h"
 
 /**
- * Reads PES extension and construct object
- * @param data Vector with the PES extension.
+ * Constructs extension without any optional field.
  */
-PacketElementaryStreamExtension::PacketElementaryStreamExtension(vector<uint8_t> &data) {
-    if (data.size() < PES_EXTENSION_HEADER_SIZE) {
+PacketElementaryStreamExtension::PacketElementaryStreamExtension()
+    : flags(0), optionalFlags(0), length(0), totalLength(0), headerData(0), headerDataSize(0) {}
+
+/**
+ * Reads PES extension and construct object, header data are not copied.
+ * @param data Pointer to the PES extension, it has to outlive the object.
+ * @param size Number of bytes available for the PES extension.
+ */
+PacketElementaryStreamExtension::PacketElementaryStreamExtension(const uint8_t *data, unsigned int size) {
+    if (size < PES_EXTENSION_HEADER_SIZE) {
         throw runtime_error ("Unable to read extension of PES!");
     }
-    byte1 = data[0];
-    byte2 = data[1];
+    flags = data[0];
+    optionalFlags = data[1];
     length = data[2];
 
-    if (data.size() < PES_EXTENSION_HEADER_SIZE + length) {
+    if (size < PES_EXTENSION_HEADER_SIZE + length) {
         throw runtime_error ("PES extension does not contain PES header data!");
     }
 
+    headerData = &data[PES_EXTENSION_HEADER_SIZE];
+    headerDataSize = length;
     totalLength = length + PES_EXTENSION_HEADER_SIZE;
 }
 
 /**
- * Reads PES header and construct object
- * @param data Vector with the PES header.
+ * Finds the optional field in the header data.
+ * @param field Demanded field.
+ * @param offset Offset of the field in the header data.
+ * @return True if the field is present and fits into the header data.
  */
-PacketElementaryStreamHeader::PacketElementaryStreamHeader(vector<uint8_t> &data) {
-    if (data.size() < PES_HEADER_HEADER_SIZE) {
-        throw runtime_error ("Unable to read header of PES!");
+bool PacketElementaryStreamExtension::locate(Field field, size_t &offset) const {
+    const static uint8_t FIELD_FLAGS[] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    const static uint8_t FIELD_SIZES[] = { TIMESTAMP_SIZE, TIMESTAMP_SIZE, 6, 3, 1, 1, 2, 1 };
+    const static uint8_t EXTENSION_FLAGS[] = { 0x80, 0x40, 0x20, 0x10 };
+    const static uint8_t EXTENSION_SIZES[] = { PRIVATE_DATA_SIZE, 1, 2, 2 };
+
+    offset = 0;
+    for (unsigned int i = FIELD_PTS; i <= FIELD_EXTENSION; i++) {
+        // DTS is present only together with PTS
+        bool present = (optionalFlags & FIELD_FLAGS[i]) && (i != FIELD_DTS || (optionalFlags & FIELD_FLAGS[FIELD_PTS]));
+        if (i == (unsigned int)field) {
+            return present && offset + FIELD_SIZES[i] <= headerDataSize;
+        }
+        offset += (present)? FIELD_SIZES[i] : 0;
     }
-    prefix = data[0] << 16;
-    prefix = data[1] << 8;
-    prefix = data[2];
 
-    streamID = data[3];
+    /* Fields of the extension follow its flags */
+    if (!(optionalFlags & FIELD_FLAGS[FIELD_EXTENSION]) || offset > headerDataSize) {
+        return false;
+    }
 
-    packetLength = data[4] << 8;
-    packetLength = data[5];
+    uint8_t extensionFlags = headerData[offset - 1];
+    for (unsigned int i = FIELD_PRIVATE_DATA; i <= FIELD_PSTD_BUFFER; i++) {
+        bool present = extensionFlags & EXTENSION_FLAGS[i - FIELD_PRIVATE_DATA];
+        size_t size = EXTENSION_SIZES[i - FIELD_PRIVATE_DATA];
+        if (i == FIELD_PACK_HEADER && present && offset < headerDataSize) {
+            size += headerData[offset];
+        }
+        if (i == (unsigned int)field) {
+            return present && offset + size <= headerDataSize;
+        }
+        offset += (present)? size : 0;
+    }
 
-    totalLength = PES_HEADER_HEADER_SIZE;
+    return false;
+}
+
+/**
+ * Reads 33-bit timestamp with the marker bits.
+ * @param data Pointer to the timestamp.
+ * @return Timestamp in 90 kHz ticks.
+ */
+uint64_t PacketElementaryStreamExtension::readTimestamp(const uint8_t *data) {
+    return (uint64_t)(data[0] & 0x0E) << 29 | (uint64_t)data[1] << 22 | (uint64_t)(data[2] >> 1) << 15 | data[3] << 7 | data[4] >> 1;
+}
+
+/**
+ * @return Scrambling control of the payload.
+ */
+uint8_t PacketElementaryStreamExtension::scramblingControl() const {
+    return (flags >> 4) & 0x03;
+}
+
+/**
+ * @return True if the payload has higher priority.
+ */
+bool PacketElementaryStreamExtension::priority() const {
+    return flags & 0x08;
+}
+
+/**
+ * @return True if the payload starts with the access unit or the start code.
+ */
+bool PacketElementaryStreamExtension::dataAlignment() const {
+    return flags & 0x04;
+}
+
+/**
+ * @return True if the payload is protected by the copyright.
+ */
+bool PacketElementaryStreamExtension::copyright() const {
+    return flags & 0x02;
+}
+
+/**
+ * @return True if the payload is original, otherwise it is a copy.
+ */
+bool PacketElementaryStreamExtension::original() const {
+    return flags & 0x01;
+}
+
+/**
+ * @return True if the header carries presentation timestamp.
+ */
+bool PacketElementaryStreamExtension::hasPTS() const {
+    size_t offset;
+    return locate(FIELD_PTS, offset);
+}
+
+/**
+ * @return Presentation timestamp in 90 kHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStreamExtension::PTS() const {
+    size_t offset;
+    return (locate(FIELD_PTS, offset))? readTimestamp(headerData + offset) : 0;
+}
+
+/**
+ * @return True if the header carries decoding timestamp.
+ */
+bool PacketElementaryStreamExtension::hasDTS() const {
+    size_t offset;
+    return locate(FIELD_DTS, offset);
+}
+
+/**
+ * @return Decoding timestamp in 90 kHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStreamExtension::DTS() const {
+    size_t offset;
+    return (locate(FIELD_DTS, offset))? readTimestamp(headerData + offset) : 0;
+}
+
+/**
+ * @return True if the header carries elementary stream clock reference.
+ */
+bool PacketElementaryStreamExtension::hasESCR() const {
+    size_t offset;
+    return locate(FIELD_ESCR, offset);
+}
+
+/**
+ * @return Elementary stream clock reference in 27 MHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStreamExtension::ESCR() const {
+    size_t offset;
+    if (!locate(FIELD_ESCR, offset)) {
+        return 0;
+    }
+
+    const uint8_t *escr = headerData + offset;
+    uint64_t base = (uint64_t)(escr[0] & 0x38) << 27 | (uint64_t)(escr[0] & 0x03) << 28 | (uint64_t)escr[1] << 20
+            | (uint64_t)(escr[2] >> 3) << 15 | (escr[2] & 0x03) << 13 | escr[3] << 5 | escr[4] >> 3;
+    return base * 300 + ((escr[4] & 0x03) << 7 | escr[5] >> 1);
+}
+
+/**
+ * @return True if the header carries rate of the elementary stream.
+ */
+bool PacketElementaryStreamExtension::hasESRate() const {
+    size_t offset;
+    return locate(FIELD_ES_RATE, offset);
+}
+
+/**
+ * @return Rate of the elementary stream in units of 50 bytes per second, zero if it is not present.
+ */
+uint32_t PacketElementaryStreamExtension::ESRate() const {
+    size_t offset;
+    if (!locate(FIELD_ES_RATE, offset)) {
+        return 0;
+    }
+
+    const uint8_t *rate = headerData + offset;
+    return (rate[0] & 0x7F) << 15 | rate[1] << 7 | rate[2] >> 1;
+}
+
+/**
+ * @return True if the header carries trick mode of the digital storage media.
+ */
+bool PacketElementaryStreamExtension::hasTrickMode() const {
+    size_t offset;
+    return locate(FIELD_TRICK_MODE, offset);
+}
+
+/**
+ * @return Trick mode control, zero if it is not present.
+ */
+uint8_t PacketElementaryStreamExtension::trickModeControl() const {
+    size_t offset;
+    return (locate(FIELD_TRICK_MODE, offset))? headerData[offset] >> 5 : 0;
+}
+
+/**
+ * @return Five bits which follow the trick mode control, their meaning depends on the control.
+ */
+uint8_t PacketElementaryStreamExtension::trickModeData() const {
+    size_t offset;
+    return (locate(FIELD_TRICK_MODE, offset))? headerData[offset] & 0x1F : 0;
+}
+
+/**
+ * @return True if the header carries additional copyright information.
+ */
+bool PacketElementaryStreamExtension::hasAdditionalCopyInfo() const {
+    size_t offset;
+    return locate(FIELD_ADDITIONAL_COPY_INFO, offset);
+}
+
+/**
+ * @return Additional copyright information, zero if it is not present.
+ */
+uint8_t PacketElementaryStreamExtension::additionalCopyInfo() const {
+    size_t offset;
+    return (locate(FIELD_ADDITIONAL_COPY_INFO, offset))? headerData[offset] & 0x7F : 0;
+}
+
+/**
+ * @return True if the header carries CRC of the previous PES packet.
+ */
+bool PacketElementaryStreamExtension::hasPreviousCRC() const {
+    size_t offset;
+    return locate(FIELD_PREVIOUS_CRC, offset);
+}
+
+/**
+ * @return CRC of the previous PES packet, zero if it is not present.
+ */
+uint16_t PacketElementaryStreamExtension::previousCRC() const {
+    size_t offset;
+    return (locate(FIELD_PREVIOUS_CRC, offset))? headerData[offset] << 8 | headerData[offset + 1] : 0;
+}
+
+/**
+ * @return True if the header carries the extension fields.
+ */
+bool PacketElementaryStreamExtension::hasExtension() const {
+    size_t offset;
+    return locate(FIELD_EXTENSION, offset);
 }
 
 /**
- * Reads PES extension and construct object
- * @param data Vector with the PES extension.
+ * @return Pointer to 16 bytes of the private data, null if they are not present.
  */
-PacketElementaryStreamFragment::PacketElementaryStreamFragment(vector<uint8_t> &packet)
-    : MPEG2Packet(packet) {
-    initPESFragment();
+const uint8_t *PacketElementaryStreamExtension::privateData() const {
+    size_t offset;
+    return (locate(FIELD_PRIVATE_DATA, offset))? headerData + offset : 0;
 }
 
 /**
- * Gets PES fragment packet from the MPEG2 packet
- * @param packet MPEG2 packet
- * @return PES fragment packet
+ * @return True if the header carries program packet sequence counter.
  */
-PacketElementaryStreamFragment PacketElementaryStreamFragment::fromMPEG2Packet(const MPEG2Packet &packet) {
-    PacketElementaryStreamFragment streamFragment;
-    streamFragment.header = packet.header;
-    streamFragment.adaptationField = packet.adaptationField;
-    streamFragment.payload = packet.payload;
+bool PacketElementaryStreamExtension::hasSequenceCounter() const {
+    size_t offset;
+    return locate(FIELD_SEQUENCE_COUNTER, offset);
+}
 
-    streamFragment.initPESFragment();
+/**
+ * @return Program packet sequence counter, zero if it is not present.
+ */
+uint8_t PacketElementaryStreamExtension::sequenceCounter() const {
+    size_t offset;
+    return (locate(FIELD_SEQUENCE_COUNTER, offset))? headerData[offset] & 0x7F : 0;
+}
 
-    return streamFragment;
+/**
+ * @return True if the header carries size of the P-STD buffer.
+ */
+bool PacketElementaryStreamExtension::hasPSTDBuffer() const {
+    size_t offset;
+    return locate(FIELD_PSTD_BUFFER, offset);
 }
 
 /**
- * Initializes PES fragment from MPEG2 background.
+ * @return Size of the P-STD buffer in bytes, zero if it is not present.
  */
-void PacketElementaryStreamFragment::initPESFragment() {
-    if (!payload) {
+uint32_t PacketElementaryStreamExtension::PSTDBufferSize() const {
+    size_t offset;
+    if (!locate(FIELD_PSTD_BUFFER, offset)) {
+        return 0;
+    }
+
+    uint32_t size = (headerData[offset] & 0x1F) << 8 | headerData[offset + 1];
+    return size * ((headerData[offset] & 0x20)? 1024 : 128);
+}
+
+/**
+ * Decides if the stream carries the optional PES header.
+ * @param streamID ID of the stream.
+ * @return True if the PES header is followed by the PES extension.
+ */
+bool PacketElementaryStreamHeader::hasOptionalHeader(uint8_t streamID) {
+    return streamID != ID_PROGRAM_STREAM_MAP
+        && streamID != ID_PADDING_STREAM_1
+        && streamID != ID_PRIVATE_STREAM_2
+        && streamID != ID_ECM_STREAM
+        && streamID != ID_EMM_STREAM
+        && streamID != ID_DSMCC_STREAM
+        && streamID != ID_H222_1_TYPE_E_STREAM
+        && streamID != ID_PROGRAM_STREAM_DIRECTORY;
+}
+
+/**
+ * Reads PES header and construct object
+ * @param data Pointer to the PES header.
+ * @param size Number of bytes available for the PES header.
+ */
+PacketElementaryStreamHeader::PacketElementaryStreamHeader(const uint8_t *data, unsigned int size) {
+    if (size < PES_HEADER_HEADER_SIZE) {
+        throw runtime_error ("Unable to read header of PES!");
+    }
+    prefix = (data[0] << 16) | (data[1] << 8) | data[2];
+
+    streamID = data[3];
+
+    packetLength = (data[4] << 8) | data[5];
+
+    totalLength = PES_HEADER_HEADER_SIZE;
+}
+
+/**
+ * Reads PES fragment from the payload of the MPEG2 packet.
+ * @param packet MPEG2 packet which carries the fragment.
+ */
+PacketElementaryStreamFragment::PacketElementaryStreamFragment(const MPEG2PacketView &packet)
+    : data(0), size(0) {
+    unsigned int payloadSize = packet.payloadSize();
+    if (payloadSize == 0) {
         return;
     }
 
-    if (header->payloadUnitStartIndicator) {
-        PESHeader = shared_ptr<PacketElementaryStreamHeader>(new PacketElementaryStreamHeader(payload->data));
-        int dataOffset = PESHeader->totalLength;
+    const uint8_t *payload = packet.payload();
+
+    if (packet.payloadUnitStartIndicator()) {
+        PESHeader = shared_ptr<PacketElementaryStreamHeader>(new PacketElementaryStreamHeader(payload, payloadSize));
+        unsigned int dataOffset = PESHeader->totalLength;
 
-        if (PESHeader->streamID == PacketElementaryStreamHeader::ID_PRIVATE_STREAM_1
-            || (PESHeader->streamID >= PacketElementaryStreamHeader::ID_AUDIO_STREAM_START && PESHeader->streamID <= PacketElementaryStreamHeader::ID_AUDIO_STREAM_END)
-            || (PESHeader->streamID >= PacketElementaryStreamHeader::ID_VIDEO_STREAM_START && PESHeader->streamID <= PacketElementaryStreamHeader::ID_VIDEO_STREAM_END)) {
+        if (PacketElementaryStreamHeader::hasOptionalHeader(PESHeader->streamID)) {
 
-            vector<uint8_t> extensionData(&payload->data[PESHeader->totalLength], &payload->data[payload->data.size()]);
-            PESExtension = shared_ptr<PacketElementaryStreamExtension>(new PacketElementaryStreamExtension(extensionData));
+            PESExtension = shared_ptr<PacketElementaryStreamExtension>(new PacketElementaryStreamExtension(&payload[dataOffset], payloadSize - dataOffset));
             dataOffset += PESExtension->totalLength;
         }
 
-        copy (&payload->data[dataOffset], &payload->data[payload->data.size()], back_inserter(streamData));
+        data = &payload[dataOffset];
+        size = payloadSize - dataOffset;
     } else {
-        streamData = payload->data;
+        data = payload;
+        size = payloadSize;
     }
 }
+
+/**
+ * @return True if the fragment starts PES packet with presentation timestamp.
+ */
+bool PacketElementaryStreamFragment::hasPTS() const {
+    return PESExtension && PESExtension->hasPTS();
+}
+
+/**
+ * @return Presentation timestamp in 90 kHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStreamFragment::PTS() const {
+    return (PESExtension)? PESExtension->PTS() : 0;
+}
+
+/**
+ * @return True if the fragment starts PES packet with decoding timestamp.
+ */
+bool PacketElementaryStreamFragment::hasDTS() const {
+    return PESExtension && PESExtension->hasDTS();
+}
+
+/**
+ * @return Decoding timestamp in 90 kHz ticks, it equals PTS if only PTS is present.
+ */
+uint64_t PacketElementaryStreamFragment::DTS() const {
+    return (hasDTS())? PESExtension->DTS() : PTS();
+}
+
+/**
+ * @return True if the fragment starts PES packet with elementary stream clock reference.
+ */
+bool PacketElementaryStreamFragment::hasESCR() const {
+    return PESExtension && PESExtension->hasESCR();
+}
+
+/**
+ * @return Elementary stream clock reference in 27 MHz ticks, zero if it is not present.
+ */
+uint64_t PacketElementaryStreamFragment::ESCR() const {
+    return (PESExtension)? PESExtension->ESCR() : 0;
+}
+
+/**
+ * @return True if the fragment starts PES packet with rate of the elementary stream.
+ */
+bool PacketElementaryStreamFragment::hasESRate() const {
+    return PESExtension && PESExtension->hasESRate();
+}
+
+/**
+ * @return Rate of the elementary stream in units of 50 bytes per second, zero if it is not present.
+ */
+uint32_t PacketElementaryStreamFragment::ESRate() const {
+    return (PESExtension)? PESExtension->ESRate() : 0;
+}
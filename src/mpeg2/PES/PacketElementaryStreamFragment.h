@@ -23,7 +23,9 @@
 
 #include <vector>
 
-#include "../MPEG2Packet.h"
+#include <memory>
+
+#include "../MPEG2PacketView.h"
 
 using namespace std;
 
@@ -34,8 +36,9 @@ class PacketElementaryStreamHeader {
     const unsigned int static PES_HEADER_HEADER_SIZE      = 6;
 public:
     PacketElementaryStreamHeader() {}
-    PacketElementaryStreamHeader(vector<uint8_t> &data);
+    PacketElementaryStreamHeader(const uint8_t *data, unsigned int size);
 
+    const unsigned int static ID_PROGRAM_STREAM_MAP    = 0xBC;
     const unsigned int static ID_PRIVATE_STREAM_1      = 0xBD;
     const unsigned int static ID_PADDING_STREAM_1      = 0xBE;
     const unsigned int static ID_PRIVATE_STREAM_2      = 0xBF;
@@ -43,6 +46,13 @@ public:
     const unsigned int static ID_AUDIO_STREAM_END      = 0xDF;
     const unsigned int static ID_VIDEO_STREAM_START    = 0xE0;
     const unsigned int static ID_VIDEO_STREAM_END      = 0xEF;
+    const unsigned int static ID_ECM_STREAM            = 0xF0;
+    const unsigned int static ID_EMM_STREAM            = 0xF1;
+    const unsigned int static ID_DSMCC_STREAM          = 0xF2;
+    const unsigned int static ID_H222_1_TYPE_E_STREAM  = 0xF8;
+    const unsigned int static ID_PROGRAM_STREAM_DIRECTORY = 0xFF;
+
+    static bool hasOptionalHeader(uint8_t streamID);
 
     uint32_t prefix;
     uint8_t streamID;
@@ -51,37 +61,102 @@ public:
 };
 
 /**
- * Class representing PES Extension
+ * Class representing PES Extension, the optional PES header. Its fields are
+ * decoded on demand from the header data in the payload, so consumers which need only
+ * the payload skip the header by its length.
  */
 class PacketElementaryStreamExtension {
 protected:
     const unsigned int static PES_EXTENSION_HEADER_SIZE      = 3;
+    const unsigned int static TIMESTAMP_SIZE                 = 5;
+    const unsigned int static PRIVATE_DATA_SIZE              = 16;
+
+    /**
+     * Optional fields in the order of their appearance in the header data
+     */
+    enum Field {
+        FIELD_PTS                   = 0,
+        FIELD_DTS                   = 1,
+        FIELD_ESCR                  = 2,
+        FIELD_ES_RATE               = 3,
+        FIELD_TRICK_MODE            = 4,
+        FIELD_ADDITIONAL_COPY_INFO  = 5,
+        FIELD_PREVIOUS_CRC          = 6,
+        FIELD_EXTENSION             = 7,
+        FIELD_PRIVATE_DATA          = 8,
+        FIELD_PACK_HEADER           = 9,
+        FIELD_SEQUENCE_COUNTER      = 10,
+        FIELD_PSTD_BUFFER           = 11
+    };
+
+    bool locate(Field field, size_t &offset) const;
+    static uint64_t readTimestamp(const uint8_t *data);
 public:
-    PacketElementaryStreamExtension(vector<uint8_t> &data);
+    const static uint32_t PTS_CLOCK = 90000;        // PTS and DTS ticks per second
+    const static uint32_t ESCR_CLOCK = 27000000;    // ESCR ticks per second
+    const static uint32_t ES_RATE_UNIT = 50;        // bytes per second
+
+    PacketElementaryStreamExtension();
+    PacketElementaryStreamExtension(const uint8_t *data, unsigned int size);
 
-    uint8_t byte1; // TODO: finish processing data
-    uint8_t byte2; // TODO: finish processing data
+    uint8_t scramblingControl() const;
+    bool priority() const;
+    bool dataAlignment() const;
+    bool copyright() const;
+    bool original() const;
+
+    bool hasPTS() const;
+    uint64_t PTS() const;
+    bool hasDTS() const;
+    uint64_t DTS() const;
+    bool hasESCR() const;
+    uint64_t ESCR() const;
+    bool hasESRate() const;
+    uint32_t ESRate() const;
+    bool hasTrickMode() const;
+    uint8_t trickModeControl() const;
+    uint8_t trickModeData() const;
+    bool hasAdditionalCopyInfo() const;
+    uint8_t additionalCopyInfo() const;
+    bool hasPreviousCRC() const;
+    uint16_t previousCRC() const;
+    bool hasExtension() const;
+    const uint8_t *privateData() const;
+    bool hasSequenceCounter() const;
+    uint8_t sequenceCounter() const;
+    bool hasPSTDBuffer() const;
+    uint32_t PSTDBufferSize() const;
+
+    uint8_t flags;              // scrambling, priority, alignment, copyright and original flags
+    uint8_t optionalFlags;      // flags of the optional fields
     uint8_t length;
     uint16_t totalLength;
+    const uint8_t *headerData;      // points into the payload which carries the extension
+    size_t headerDataSize;
 };
 
 /**
- * Class representing one PES fragment
+ * Class representing one PES fragment, data point into the payload of the packet.
+ * Fragment which starts the PES packet carries its decoded header.
  */
-class PacketElementaryStreamFragment : public MPEG2Packet
+class PacketElementaryStreamFragment
 {
-protected:
-    PacketElementaryStreamFragment() {}
-
-    void initPESFragment();
 public:
-    PacketElementaryStreamFragment(vector<uint8_t> &packet);
+    PacketElementaryStreamFragment(const MPEG2PacketView &packet);
 
-    static PacketElementaryStreamFragment fromMPEG2Packet(const MPEG2Packet &packet);
+    bool hasPTS() const;
+    uint64_t PTS() const;
+    bool hasDTS() const;
+    uint64_t DTS() const;
+    bool hasESCR() const;
+    uint64_t ESCR() const;
+    bool hasESRate() const;
+    uint32_t ESRate() const;
 
     shared_ptr<PacketElementaryStreamHeader> PESHeader;
     shared_ptr<PacketElementaryStreamExtension> PESExtension;
-    vector<uint8_t> streamData;
+    const uint8_t *data;
+    size_t size;
 };
 
 #endif // PACKETELEMENTARYSTREAMFRAGMENT_H
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          Arena.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s pamětí pro rozparsované PSI tabulky.
+ *
+ ******************************************************************************/
+
+/**
+ * @file Arena.cpp
+ *
+ * @brief Module with the memory of the parsed PSI tables.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstdlib>
+#include <cstdint>
+
+#include "Arena.h"
+
+using namespace std;
+
+/**
+ * Constructs empty arena, the first block is allocated with the first allocation.
+ * @param blockSize Size of the blocks.
+ */
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize), blocks(0), position(0), end(0), allocated(0), blocksNumber(0) {}
+
+/**
+ * Frees all blocks of the arena.
+ */
+Arena::~Arena() {
+    while (blocks) {
+        Block *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+}
+
+/**
+ * Allocates new block from the heap.
+ * @param size Size of the data in the block.
+ * @return Pointer to the data of the block.
+ */
+char *Arena::addBlock(size_t size) {
+    Block *block = static_cast<Block *>(malloc(sizeof(Block) + size));
+    if (!block) {
+        throw bad_alloc();
+    }
+
+    block->next = blocks;
+    blocks = block;
+    blocksNumber++;
+
+    return reinterpret_cast<char *>(block + 1);
+}
+
+/**
+ * Aligns the pointer.
+ * @param pointer Pointer to be aligned.
+ * @param alignment Alignment, power of two.
+ * @return Aligned pointer.
+ */
+static char *alignPointer(char *pointer, size_t alignment) {
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(pointer) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return reinterpret_cast<char *>(aligned);
+}
+
+/**
+ * Takes memory from the arena. Big allocations get the block of their own size,
+ * so the rest of the current block is not wasted.
+ * @param size Size of the memory.
+ * @param alignment Alignment of the memory, power of two.
+ * @return Pointer to the memory.
+ */
+void *Arena::allocate(size_t size, size_t alignment) {
+    allocated += size;
+
+    if (size + alignment > blockSize / 4) {
+        return alignPointer(addBlock(size + alignment), alignment);
+    }
+
+    char *aligned = alignPointer(position, alignment);
+    if (!position || aligned + size > end) {
+        position = addBlock(blockSize);
+        end = position + blockSize;
+        aligned = alignPointer(position, alignment);
+    }
+
+    position = aligned + size;
+    return aligned;
+}
+
+/**
+ * @return Sum of the sizes of all allocations.
+ */
+size_t Arena::allocatedBytes() const {
+    return allocated;
+}
+
+/**
+ * @return Number of the blocks allocated from the heap.
+ */
+size_t Arena::blocksCount() const {
+    return blocksNumber;
+}
@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          Arena.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s pamětí pro rozparsované PSI tabulky.
+ *
+ ******************************************************************************/
+
+/**
+ * @file Arena.h
+ *
+ * @brief Module with the memory of the parsed PSI tables.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <string>
+#include <vector>
+#include <new>
+#include <type_traits>
+
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Monotonic memory of one parsed table. Memory is taken from the blocks by moving
+ * the pointer, it is never returned separately and all blocks are freed at once
+ * when the arena is destroyed.
+ */
+class Arena {
+public:
+    const static size_t BLOCK_SIZE          = 16384;
+
+    Arena(size_t blockSize = BLOCK_SIZE);
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+
+    size_t allocatedBytes() const;
+    size_t blocksCount() const;
+
+protected:
+    /**
+     * Header of the block, data follow the header
+     */
+    struct Block {
+        Block *next;
+    };
+
+    size_t blockSize;
+    Block *blocks;
+    char *position;
+    char *end;
+    size_t allocated;
+    size_t blocksNumber;
+
+    char *addBlock(size_t size);
+};
+
+/**
+ * Allocator of the containers which takes memory from the arena. Allocator only
+ * points to the arena, the table which owns the arena has to outlive its containers
+ * and descriptors. Allocator without the arena uses the global heap.
+ */
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    typedef true_type propagate_on_container_copy_assignment;
+    typedef true_type propagate_on_container_move_assignment;
+    typedef true_type propagate_on_container_swap;
+
+    ArenaAllocator() : arena(0) {}
+    ArenaAllocator(Arena *arena) : arena(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        if (!arena) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, size_t) {
+        if (!arena) {
+            ::operator delete(pointer);
+        }
+    }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template <class U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+
+    Arena *arena;
+};
+
+/**
+ * String stored in the arena.
+ */
+typedef basic_string<char, char_traits<char>, ArenaAllocator<char>> ArenaString;
+
+#endif // ARENA_H
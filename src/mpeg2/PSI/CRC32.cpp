@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          CRC32.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro výpočet kontrolního součtu CRC-32 sekcí PSI.
+ *
+ ******************************************************************************/
+
+/**
+ * @file CRC32.cpp
+ *
+ * @brief Module for computing CRC-32 checksum of PSI sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include "CRC32.h"
+
+/**
+ * Tables for slicing-by-8, table[k][i] is the CRC of byte i followed by k zero bytes.
+ */
+struct CRC32Tables {
+    CRC32Tables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i << 24;
+            for (unsigned int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80000000)? (crc << 1) ^ CRC32::POLYNOMIAL : crc << 1;
+            }
+            table[0][i] = crc;
+        }
+
+        for (unsigned int k = 1; k < 8; k++) {
+            for (uint32_t i = 0; i < 256; i++) {
+                table[k][i] = (table[k - 1][i] << 8) ^ table[0][table[k - 1][i] >> 24];
+            }
+        }
+    }
+
+    uint32_t table[8][256];
+};
+
+/**
+ * @return Tables for slicing-by-8.
+ */
+static const CRC32Tables &crcTables() {
+    static const CRC32Tables tables;
+    return tables;
+}
+
+/**
+ * Computes CRC-32/MPEG-2 of the data.
+ * @param data Data to be checked.
+ * @param size Size of the data.
+ * @param crc CRC of the preceding data, initial value for the first block.
+ * @return CRC of the data.
+ */
+uint32_t CRC32::compute(const uint8_t *data, size_t size, uint32_t crc) {
+    const uint32_t (&table)[8][256] = crcTables().table;
+
+    /* Eight bytes at once, words are composed byte by byte so the byte order does not matter */
+    for (; size >= 8; data += 8, size -= 8) {
+        crc ^= (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+        crc = table[7][crc >> 24] ^ table[6][(crc >> 16) & 0xFF] ^
+              table[5][(crc >> 8) & 0xFF] ^ table[4][crc & 0xFF] ^
+              table[3][data[4]] ^ table[2][data[5]] ^
+              table[1][data[6]] ^ table[0][data[7]];
+    }
+
+    /* Remaining bytes */
+    for (; size > 0; data++, size--) {
+        crc = (crc << 8) ^ table[0][(crc >> 24) ^ *data];
+    }
+
+    return crc;
+}
+
+/**
+ * Validates the section which ends by CRC_32 field.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ * @return True if the checksum is correct, otherwise false.
+ */
+bool CRC32::isValid(const uint8_t *section, size_t size) {
+    return compute(section, size) == 0;
+}
@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          CRC32.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro výpočet kontrolního součtu CRC-32 sekcí PSI.
+ *
+ ******************************************************************************/
+
+/**
+ * @file CRC32.h
+ *
+ * @brief Module for computing CRC-32 checksum of PSI sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * CRC-32/MPEG-2 checksum (polynomial 0x04C11DB7, no reflection, no final XOR).
+ * It is computed by slicing-by-8, eight bytes are processed by one step.
+ * Checksum over the whole section including its CRC_32 field is zero.
+ */
+class CRC32 {
+public:
+    const static uint32_t POLYNOMIAL    = 0x04C11DB7;
+    const static uint32_t INITIAL_VALUE = 0xFFFFFFFF;
+
+    static uint32_t compute(const uint8_t *data, size_t size, uint32_t crc = INITIAL_VALUE);
+    static bool isValid(const uint8_t *section, size_t size);
+};
+
+#endif // CRC32_H
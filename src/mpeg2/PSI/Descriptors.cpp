@@ -18,8 +18,8 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <bitset>
 #include <stdexcept>
 
 #include "TimeOffsetTable.h"
@@ -28,93 +28,218 @@
 using namespace std;
 
 /**
- * Parses the descriptor from the data vector and constructs descriptor object.
- * @param data Vector with the desriptor.
+ * Constructs iterator which points to the first descriptor of the data.
+ * @param data Data with the descriptors, they have to be valid while the iterator is used.
+ * @param size Size of the data.
  */
-Descriptor::Descriptor(vector<uint8_t> &data) {
-    if (data.size() < DESCRIPTOR_HEADER_SIZE) {
-        throw runtime_error ("Descriptor have to containa at least header with decriptor tag and lehgth!");
-    }
+DescriptorIterator::DescriptorIterator(const uint8_t *data, size_t size)
+    : position(data), end(data + size)
+{
+    read();
+}
 
-    tag = data[0];
-    length = data[1];
+/**
+ * Moves the iterator to the next descriptor.
+ * @return This iterator.
+ */
+DescriptorIterator &DescriptorIterator::operator++() {
+    position += current.totalLength();
+    read();
+    return *this;
+}
 
-    if (length + DESCRIPTOR_HEADER_SIZE > data.size()) {
-        throw runtime_error ("Passed data vector is not sufficient for reading descriptor with length: " + to_string(length));
+/**
+ * Parses header of the descriptor at the current position.
+ */
+void DescriptorIterator::read() {
+    if (position == end) {
+        return;
     }
 
-    if (length > 0) {
-        descriptorBody.insert(descriptorBody.end(), &data[2], &data[2 + length]);
+    if ((size_t)(end - position) < DescriptorView::DESCRIPTOR_HEADER_SIZE) {
+        throw runtime_error ("Descriptor have to containa at least header with decriptor tag and lehgth!");
     }
 
-    totalLength = length + DESCRIPTOR_HEADER_SIZE;
+    current.tag = position[0];
+    current.length = position[1];
+    current.body = position + DescriptorView::DESCRIPTOR_HEADER_SIZE;
+
+    if (current.totalLength() > (size_t)(end - position)) {
+        throw runtime_error ("Passed data vector is not sufficient for reading descriptor with length: " + to_string(current.length));
+    }
 }
 
 /**
- * Parses the descriptor from the data vector and constructs descriptor object. Additionaly does tag checking.
- * @param data Vector with the desriptor.
+ * Constructs descriptor object from the descriptor parsed in place.
+ * @param view Parsed desriptor.
+ */
+Descriptor::Descriptor(const DescriptorView &view)
+    : tag(view.tag), length(view.length), totalLength(view.totalLength()) {}
+
+/**
+ * Constructs descriptor object from the descriptor parsed in place. Additionaly does tag checking.
+ * @param view Parsed desriptor.
  * @param descTag Tag of which should be the descriptor
  */
-Descriptor::Descriptor(vector<uint8_t> &data, uint8_t descTag) : Descriptor(data) {
+Descriptor::Descriptor(const DescriptorView &view, uint8_t descTag) : Descriptor(view) {
     if (tag != descTag) {
         throw runtime_error ("Invalid descriptor tag! Expected: " + to_string(descTag));
     }
 }
 
+const uint16_t Descriptors::NO_INDEX;
+
+/**
+ * Constructs empty container.
+ */
+Descriptors::Descriptors() {
+    fill(tagBitmap, tagBitmap + BITMAP_WORDS, 0);
+}
+
+/**
+ * Constructs empty container whose memory is taken from the arena.
+ * @param arena Arena of the table.
+ */
+Descriptors::Descriptors(Arena *arena)
+    : descriptors(DescriptorVector::allocator_type(arena)), nextIndices(arena), tagIndices(arena)
+{
+    fill(tagBitmap, tagBitmap + BITMAP_WORDS, 0);
+}
+
+/**
+ * Counts the present tags which are lower than the passed tag.
+ * @param tag Tag of the descriptor.
+ * @return Position of the tag in the tag indices.
+ */
+unsigned int Descriptors::rank(uint8_t tag) const {
+    unsigned int word = tag / 64;
+    unsigned int count = bitset<64>(tagBitmap[word] & ((UINT64_C(1) << (tag % 64)) - 1)).count();
+    for (unsigned int i = 0; i < word; i++) {
+        count += bitset<64>(tagBitmap[i]).count();
+    }
+    return count;
+}
+
 /**
- * Constructs descriptor from the data vector.
+ * @param tag Tag of the descriptor.
+ * @return True if the descriptor with the tag is present.
+ */
+bool Descriptors::contains(uint8_t tag) const {
+    return tagBitmap[tag / 64] & (UINT64_C(1) << (tag % 64));
+}
+
+/**
+ * @param tag Tag of the descriptor.
+ * @return Index of the first descriptor with the tag, NO_INDEX if it is not present.
+ */
+uint16_t Descriptors::firstIndex(uint8_t tag) const {
+    return contains(tag)? tagIndices[rank(tag)].first : NO_INDEX;
+}
+
+/**
+ * Returns the first descriptor with the tag.
+ * @param tag Tag of the descriptor.
+ * @return Pointer to the descriptor owned by the container, null pointer if it is not present.
+ */
+const Descriptor *Descriptors::find(uint8_t tag) const {
+    uint16_t index = firstIndex(tag);
+    return (index != NO_INDEX)? descriptors[index].get() : 0;
+}
+
+/**
+ * Adds the descriptor at the end of the container.
+ * @param descriptor Descriptor to be added.
+ */
+void Descriptors::push_back(const shared_ptr<Descriptor> &descriptor) {
+    if (descriptors.size() >= NO_INDEX) {
+        throw runtime_error ("Unable to add descriptor, too many descriptors in the container!");
+    }
+
+    uint16_t index = descriptors.size();
+    uint8_t tag = descriptor->tag;
+
+    descriptors.push_back(descriptor);
+    nextIndices.push_back(NO_INDEX);
+
+    auto tagIndex = tagIndices.begin() + rank(tag);
+    if (contains(tag)) {
+        nextIndices[tagIndex->last] = index;
+        tagIndex->last = index;
+    } else {
+        TagIndex newIndex = {index, index};
+        tagIndices.insert(tagIndex, newIndex);
+        tagBitmap[tag / 64] |= UINT64_C(1) << (tag % 64);
+    }
+}
+
+/**
+ * Adds all descriptors of the other container at the end of this container.
+ * @param other Container with the descriptors.
+ */
+void Descriptors::append(const Descriptors &other) {
+    for (const shared_ptr<Descriptor> &descriptor : other.descriptors) {
+        push_back(descriptor);
+    }
+}
+
+/**
+ * Constructs specialized descriptor from the descriptor parsed in place.
  *
- * @param data Vector with the desriptor.
- * @return Pointer to the descriptor.
+ * @param view Parsed desriptor.
+ * @param arena Arena of the table, descriptor is allocated from the heap without the arena.
+ * @return Pointer to the descriptor, null pointer if the tag of the descriptor is not supported.
  */
-shared_ptr<Descriptor> DescriptorFactory::readDescriptor(vector<uint8_t> &data) {
-    shared_ptr<Descriptor> descriptor(new Descriptor(data));
-    switch (descriptor->tag) {
+shared_ptr<Descriptor> DescriptorFactory::readDescriptor(const DescriptorView &view, Arena *arena) {
+    switch (view.tag) {
     case NetworkNameDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new NetworkNameDescriptor(data));
+        return allocate_shared<NetworkNameDescriptor>(ArenaAllocator<NetworkNameDescriptor>(arena), view, arena);
     case TerrestialDeliverySystemDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new TerrestialDeliverySystemDescriptor(data));
+        return allocate_shared<TerrestialDeliverySystemDescriptor>(ArenaAllocator<TerrestialDeliverySystemDescriptor>(arena), view);
     case ServiceDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new ServiceDescriptor(data));
+        return allocate_shared<ServiceDescriptor>(ArenaAllocator<ServiceDescriptor>(arena), view, arena);
     case ShortEventDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new ShortEventDescriptor(data));
+        return allocate_shared<ShortEventDescriptor>(ArenaAllocator<ShortEventDescriptor>(arena), view, arena);
     case ISO639LanguageDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new ISO639LanguageDescriptor(data));
+        return allocate_shared<ISO639LanguageDescriptor>(ArenaAllocator<ISO639LanguageDescriptor>(arena), view, arena);
     case LocalTimeOffsetDescriptor::DESCRIPTOR_TAG:
-        return shared_ptr<Descriptor>(new LocalTimeOffsetDescriptor(data));
-
+        return allocate_shared<LocalTimeOffsetDescriptor>(ArenaAllocator<LocalTimeOffsetDescriptor>(arena), view);
     }
 
-    return descriptor;
+    return shared_ptr<Descriptor>();
 }
 
 /**
- * Constructs descriptor loop from the data vector.
+ * Constructs descriptor loop from the data. Descriptors are walked in place and only
+ * the supported ones are constructed, the others are skipped.
  *
- * @param data Vector with the desriptors.
+ * @param data Data with the length of the loop and the desriptors.
+ * @param size Size of the data.
+ * @param arena Arena of the table which owns the loop.
  * @return Descriptor loop.
  */
-DescriptorLoop DescriptorFactory::readDescriptorLoop(vector<uint8_t> &data)
+DescriptorLoop DescriptorFactory::readDescriptorLoop(const uint8_t *data, size_t size, Arena *arena)
 {
-    DescriptorLoop loop;
+    DescriptorLoop loop(arena);
     uint8_t headerSize = DescriptorLoop::DESCRIPTOR_LOOP_HEADER_SIZE;
 
-    if (data.size() < headerSize) {
+    if (size < headerSize) {
         throw runtime_error ("Unable to read descriptor loop, insufficient size of header!");
     }
 
     uint16_t descriptorsLength = (data[0] & 0x0F) << 8;
     descriptorsLength |= data[1];
 
-    if (data.size() < descriptorsLength + headerSize) {
+    if (size < (size_t)descriptorsLength + headerSize) {
         throw runtime_error ("Unable to read descriptors, insufficient size of data vector!");
     }
 
-    vector<uint8_t> descData(&data[headerSize], &data[headerSize + descriptorsLength]);
-    while (!descData.empty()) {
-        shared_ptr<Descriptor> descriptor = readDescriptor(descData);
-        loop.descriptors.push_back(descriptor);
-        descData.erase(descData.begin(), descData.begin() + descriptor->totalLength);
+    const uint8_t *descData = data + headerSize;
+    DescriptorIterator end(descData + descriptorsLength, 0);
+    for (DescriptorIterator it(descData, descriptorsLength); it != end; ++it) {
+        shared_ptr<Descriptor> descriptor = readDescriptor(*it, arena);
+        if (descriptor) {
+            loop.descriptors.push_back(descriptor);
+        }
     }
 
     loop.totalLength = descriptorsLength + headerSize;
@@ -124,11 +249,12 @@ DescriptorLoop DescriptorFactory::readDescriptorLoop(vector<uint8_t> &data)
 
 /**
  * Constructs specialized Network Name Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
+ * @param arena Arena for the name of the network.
  */
-NetworkNameDescriptor::NetworkNameDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
-    networkName = string((char *)&descriptorBody[0], descriptorBody.size());
+NetworkNameDescriptor::NetworkNameDescriptor(const DescriptorView &view, Arena *arena)
+    : Descriptor(view, DESCRIPTOR_TAG), networkName(arena) {
+    networkName.assign((const char *)view.body, view.length);
 }
 
 /**
@@ -309,16 +435,16 @@ double GuardInterval::toValue() const {
 
 /**
  * Constructs specialized Terrestial Delivery System Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
  */
-TerrestialDeliverySystemDescriptor::TerrestialDeliverySystemDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
+TerrestialDeliverySystemDescriptor::TerrestialDeliverySystemDescriptor(const DescriptorView &view)
+    : Descriptor(view, DESCRIPTOR_TAG) {
 
-    if (descriptorBody.size() < DESCRIPTOR_BODY_SIZE) {
+    if (view.length < DESCRIPTOR_BODY_SIZE) {
         throw runtime_error ("Passed data vector is not sufficient for reading descriptor with length: " + to_string(DESCRIPTOR_BODY_SIZE));
     }
 
-    uint8_t *dataPtr = &descriptorBody[0];
+    const uint8_t *dataPtr = view.body;
 
     centreFrequency = *dataPtr++ << 24;
     centreFrequency |= *dataPtr++ << 16;
@@ -337,219 +463,211 @@ TerrestialDeliverySystemDescriptor::TerrestialDeliverySystemDescriptor(vector<ui
 
 /**
  * Constructs specialized Service Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
+ * @param arena Arena for the names of the service and its provider.
  */
-ServiceDescriptor::ServiceDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
+ServiceDescriptor::ServiceDescriptor(const DescriptorView &view, Arena *arena)
+    : Descriptor(view, DESCRIPTOR_TAG), serviceProviderName(arena), serviceName(arena) {
 
     uint16_t readLen = 0;
-    if (descriptorBody.size() == 0) {
+    if (view.length == 0) {
         throw runtime_error ("Passed data vector does not contain service_type item!");
     }
-    serviceType = (ServiceType)descriptorBody[readLen];
+    serviceType = (ServiceType)view.body[readLen];
     readLen++;
 
-    if (descriptorBody.size() < (unsigned)(readLen + 1)) {
+    if (view.length < (unsigned)(readLen + 1)) {
         throw runtime_error ("Passed data vector does not contain length of service_provider_name item!");
     }
-    uint8_t len = descriptorBody[readLen];
+    uint8_t len = view.body[readLen];
     readLen++;
 
-    if (descriptorBody.size() < len + readLen) {
+    if (view.length < len + readLen) {
         throw runtime_error ("Passed data vector does not contain service_provider_name item full length!");
     }
-    serviceProviderName = string((char *)&descriptorBody[readLen], len);
+    serviceProviderName.assign((const char *)&view.body[readLen], len);
     readLen += len;
 
-    if (descriptorBody.size() < (unsigned)(readLen + 1)) {
+    if (view.length < (unsigned)(readLen + 1)) {
         throw runtime_error ("Passed data vector does not contain length of service_provider_name item!");
     }
-    len = descriptorBody[readLen];
+    len = view.body[readLen];
     readLen++;
 
-    if (descriptorBody.size() < len + readLen) {
+    if (view.length < len + readLen) {
         throw runtime_error ("Passed data vector does not contain service_provider_name item full length!");
     }
-    serviceName = string((char *)&descriptorBody[readLen], len);
+    serviceName.assign((const char *)&view.body[readLen], len);
 }
 
 /**
  * Constructs specialized Short Event Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
+ * @param arena Arena for the strings of the descriptor.
  */
-ShortEventDescriptor::ShortEventDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
+ShortEventDescriptor::ShortEventDescriptor(const DescriptorView &view, Arena *arena)
+    : Descriptor(view, DESCRIPTOR_TAG), languageCode(arena), eventName(arena), eventText(arena) {
 
     uint16_t readLen = 0;
-    if (descriptorBody.size() < DESCRIPTOR_CODE_LANGUAGE_SIZE) {
+    if (view.length < DESCRIPTOR_CODE_LANGUAGE_SIZE) {
         throw runtime_error ("Passed data vector does not contain code language item!");
     }
-    languageCode =  string((char *)&descriptorBody[readLen], DESCRIPTOR_CODE_LANGUAGE_SIZE);
+    languageCode.assign((const char *)&view.body[readLen], DESCRIPTOR_CODE_LANGUAGE_SIZE);
     readLen += DESCRIPTOR_CODE_LANGUAGE_SIZE;
 
-    if (descriptorBody.size() < (unsigned)(readLen + 1)) {
+    if (view.length < (unsigned)(readLen + 1)) {
         throw runtime_error ("Passed data vector does not contain length of event_name item!");
     }
-    uint8_t len = descriptorBody[readLen];
+    uint8_t len = view.body[readLen];
     readLen++;
 
-    if (descriptorBody.size() < len + readLen) {
+    if (view.length < len + readLen) {
         throw runtime_error ("Passed data vector does not contain full length of event_name!");
     }
-    eventName = string((char *)&descriptorBody[readLen], len);
+    eventName.assign((const char *)&view.body[readLen], len);
     readLen += len;
 
-    if (descriptorBody.size() < (unsigned)(readLen + 1)) {
+    if (view.length < (unsigned)(readLen + 1)) {
         throw runtime_error ("Passed data vector does not contain length of event_text item!");
     }
-    len = descriptorBody[readLen];
+    len = view.body[readLen];
     readLen++;
 
-    if (descriptorBody.size() < len + readLen) {
+    if (view.length < len + readLen) {
         throw runtime_error ("Passed data vector does not contain full length of event_text!");
     }
-    eventText = string((char *)&descriptorBody[readLen], len);
+    eventText.assign((const char *)&view.body[readLen], len);
 }
 
 /**
  * Constructs specialized ISO 639 Language Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
+ * @param arena Arena for the language code.
  */
-ISO639LanguageDescriptor::ISO639LanguageDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
+ISO639LanguageDescriptor::ISO639LanguageDescriptor(const DescriptorView &view, Arena *arena)
+    : Descriptor(view, DESCRIPTOR_TAG), languageCode(arena) {
 
     uint16_t readLen = 0;
-    if (descriptorBody.size() < DESCRIPTOR_BODY_SIZE) {
+    if (view.length < DESCRIPTOR_BODY_SIZE) {
         throw runtime_error ("Passed data vector does does not have correct size!");
     }
-    languageCode =  string((char *)&descriptorBody[readLen], DESCRIPTOR_CODE_LANGUAGE_SIZE);
+    languageCode.assign((const char *)&view.body[readLen], DESCRIPTOR_CODE_LANGUAGE_SIZE);
     readLen += DESCRIPTOR_CODE_LANGUAGE_SIZE;
 
-    audioType = (AudioType)descriptorBody[readLen];
+    audioType = (AudioType)view.body[readLen];
 }
 
 /**
  * Constructs specialized Local Time Offset Descriptor
- * @param data Vector with the desriptor.
+ * @param view Parsed desriptor.
  */
-LocalTimeOffsetDescriptor::LocalTimeOffsetDescriptor(vector<uint8_t> &data)
-    : Descriptor(data, DESCRIPTOR_TAG) {
+LocalTimeOffsetDescriptor::LocalTimeOffsetDescriptor(const DescriptorView &view)
+    : Descriptor(view, DESCRIPTOR_TAG) {
 
-    if (descriptorBody.size() < LTO_DESCRIPTOR_SIZE) {
+    if (view.length < LTO_DESCRIPTOR_SIZE) {
         throw runtime_error ("Passed data vector have size at least 10!");
     }
 
     int readLength = 0;
 
-    countryCode = descriptorBody[readLength] << 16;
-    countryCode |= descriptorBody[readLength + 1] << 8;
-    countryCode |= descriptorBody[readLength + 2];
+    countryCode = view.body[readLength] << 16;
+    countryCode |= view.body[readLength + 1] << 8;
+    countryCode |= view.body[readLength + 2];
     readLength += 3;
 
-    regionID = descriptorBody[readLength] & 0xFC;
-    timeOffsetPolarity = descriptorBody[readLength] & 0x01;
+    regionID = view.body[readLength] & 0xFC;
+    timeOffsetPolarity = view.body[readLength] & 0x01;
     readLength++;
 
-    vector<uint8_t> timeData(&descriptorBody[readLength], &descriptorBody[descriptorBody.size()]);
-    timeData.resize(2);
-    timeData.push_back(0);
-    timeOffset = DateTime::parseTime(timeData);
+    // Offsets contain only hours and minutes
+    int sign = (timeOffsetPolarity)? -1 : 1;
+    timeOffsetSeconds = sign * (DateTime::fromBCD(view.body[readLength]) * 3600 + DateTime::fromBCD(view.body[readLength + 1]) * 60);
+    timeOffset = DateTime::toTime(sign * timeOffsetSeconds);
     readLength += 2;
 
-    vector<uint8_t> dateTimeData(&descriptorBody[readLength], &descriptorBody[descriptorBody.size()]);
-    timeOfChange = DateTime::parseDateTime(dateTimeData);
-    readLength += 5;
+    timeOfChangeUTC = DateTime::parseDateTime(view.body + readLength);
+    timeOfChange = DateTime::toDateTime(timeOfChangeUTC);
+    readLength += DateTime::DATETIME_SIZE;
 
-    vector<uint8_t> timeData2(&descriptorBody[readLength], &descriptorBody[descriptorBody.size()]);
-    timeData2.resize(2);
-    timeData2.push_back(0);
-    nextOffset = DateTime::parseTime(timeData2);
+    nextOffsetSeconds = sign * (DateTime::fromBCD(view.body[readLength]) * 3600 + DateTime::fromBCD(view.body[readLength + 1]) * 60);
+    nextOffset = DateTime::toTime(sign * nextOffsetSeconds);
     readLength += 2;
- }
+}
 
 /**
- * Converts number to hex number which is stored again as a decimal number.
- * @param number Number to be converted.
- * @return Hexadecimal number represented by decimal.
+ * Parses date and time coded as MJD and BCD.
+ * @param data Five bytes with the date time.
+ * @return Seconds since 1970 in UTC.
  */
-int DateTime::toHex(unsigned int number) {
-    std::stringstream stream;
-    stream << std::hex << number;
-    std::string result( stream.str() );
-    return std::stoi(result);
+int64_t DateTime::parseDateTime(const uint8_t *data) {
+    int64_t MJD = (data[0] << 8) | data[1];
+    return (MJD - MJD_UNIX_EPOCH) * SECONDS_PER_DAY + parseTime(data + 2);
 }
 
 /**
- * Parses date and time from he vector.
- * @param data Vector with the date time.
- * @return Datetime from the vector.
+ * Parses time coded in BCD.
+ * @param data Three bytes with hours, minutes and seconds.
+ * @return Time in seconds.
  */
-struct tm DateTime::parseDateTime(vector<uint8_t> &data) {
-    if (data.size() < DATETIME_SIZE) {
-        throw runtime_error ("Unable to read datetime, insufficient size!");
+int32_t DateTime::parseTime(const uint8_t *data) {
+    return fromBCD(data[0]) * 3600 + fromBCD(data[1]) * 60 + fromBCD(data[2]);
+}
+
+/**
+ * Converts timestamp to the broken down date time, only integer arithmetics is used.
+ * @param timestamp Seconds since 1970.
+ * @return Date time of the timestamp.
+ */
+struct tm DateTime::toDateTime(int64_t timestamp) {
+    int64_t days = timestamp / SECONDS_PER_DAY;
+    int64_t seconds = timestamp % SECONDS_PER_DAY;
+    if (seconds < 0) {
+        seconds += SECONDS_PER_DAY;
+        days--;
     }
 
-    uint8_t *dataPtr = &data[0];
+    /* Civil date from the days, years start with March so the leap day is the last one */
+    int64_t shifted = days + 719468;
+    int64_t era = ((shifted >= 0)? shifted : shifted - 146096) / 146097;
+    int64_t dayOfEra = shifted - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int64_t month = (monthIndex < 10)? monthIndex + 3 : monthIndex - 9;
+    int64_t year = yearOfEra + era * 400 + ((month <= 2)? 1 : 0);
+    bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
 
     struct tm resTime;
-    int MJD = *dataPtr++ << 8;
-    MJD |= *dataPtr++;
-
-    int Y = (MJD - 15078.2) / 365.25;
-    int M = (MJD - 14956.1 - (int)(Y * 365.25)) / 30.6001;
-    resTime.tm_mday = MJD - 14956 - (int)(Y * 365.25) - (int)(M * 30.6001);
-    int K = (M == 14 || M == 15)? 1 : 0;
-    resTime.tm_year = Y + K;
-    resTime.tm_mon = M - 2 - K * 12;
-
-    resTime.tm_hour = toHex(*dataPtr++);
-    resTime.tm_min = toHex(*dataPtr++);
-    resTime.tm_sec = toHex(*dataPtr++);
+    resTime.tm_year = year - 1900;
+    resTime.tm_mon = month - 1;
+    resTime.tm_mday = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    resTime.tm_yday = (month <= 2)? dayOfYear - 306 : dayOfYear + 59 + (leapYear? 1 : 0);
+    resTime.tm_wday = ((days + 4) % 7 + 7) % 7;     // 1970-01-01 was Thursday
+    resTime.tm_hour = seconds / 3600;
+    resTime.tm_min = seconds / 60 % 60;
+    resTime.tm_sec = seconds % 60;
     resTime.tm_isdst = -1;
 
     return resTime;
 }
 
 /**
- * Parses time from the vector.
- * @param data Vector with the time.
- * @return Time parsed from the vector.
+ * Converts time to the broken down time.
+ * @param seconds Time in seconds.
+ * @return Time in the hours, minutes and seconds.
  */
-struct tm DateTime::parseTime(vector<uint8_t> &data) {
-    if (data.size() < TIME_SIZE) {
-        throw runtime_error ("Unable to read time, insufficient size!");
-    }
-
-    uint8_t *dataPtr = &data[0];
+struct tm DateTime::toTime(int32_t seconds) {
     struct tm resTime;
 
     resTime.tm_mday = 1;
     resTime.tm_year = 0;
     resTime.tm_mon = 0;
-    resTime.tm_hour = toHex(*dataPtr++);
-    resTime.tm_min = toHex(*dataPtr++);
-    resTime.tm_sec = toHex(*dataPtr++);
+    resTime.tm_hour = seconds / 3600;
+    resTime.tm_min = seconds / 60 % 60;
+    resTime.tm_sec = seconds % 60;
     resTime.tm_wday = 0;
     resTime.tm_yday = 0;
     resTime.tm_isdst = -1;
 
     return resTime;
 }
-
-/**
- * Offsets datetime about passed offset time.
- * @param timeToOffset Datetime to be offeseted.
- * @param offsetTime Time about which to offset demanded datetime.
- * @return Offseted datetime.
- */
-struct tm DateTime::offset(struct tm& timeToOffset, struct tm &offsetTime) {
-
-    struct tm offsetedTime = timeToOffset;
-    offsetedTime.tm_hour += offsetTime.tm_hour;
-    offsetedTime.tm_min += offsetTime.tm_min;
-    offsetedTime.tm_sec += offsetTime.tm_sec;
-
-    mktime(&offsetedTime);
-
-    return offsetedTime;
-}
@@ -27,20 +27,72 @@
 
 #include <ctime>
 #include <cstdint>
+#include <cstddef>
+
+#include "Arena.h"
 
 using namespace std;
 
+/**
+ * Descriptor which is read in place, body points into the data of the section.
+ */
+struct DescriptorView {
+    const unsigned int static DESCRIPTOR_HEADER_SIZE        = 2;
+
+    DescriptorView() : tag(0), length(0), body(0) {}
+
+    uint8_t tag;
+    uint8_t length;
+    const uint8_t *body;
+
+    uint32_t totalLength() const {
+        return length + DESCRIPTOR_HEADER_SIZE;
+    }
+};
+
+/**
+ * Forward iterator over the descriptors of the loop. Descriptors are parsed
+ * in place when the iterator is advanced, nothing is copied nor allocated.
+ */
+class DescriptorIterator {
+public:
+    DescriptorIterator(const uint8_t *data, size_t size);
+
+    const DescriptorView &operator*() const {
+        return current;
+    }
+
+    const DescriptorView *operator->() const {
+        return &current;
+    }
+
+    DescriptorIterator &operator++();
+
+    bool operator==(const DescriptorIterator &other) const {
+        return position == other.position;
+    }
+
+    bool operator!=(const DescriptorIterator &other) const {
+        return position != other.position;
+    }
+
+protected:
+    const uint8_t *position;
+    const uint8_t *end;
+    DescriptorView current;
+
+    void read();
+};
+
 /**
  * Base class for all descriptors.
  */
 class Descriptor {
 protected:
-    const unsigned int static DESCRIPTOR_HEADER_SIZE        = 2;
-
-    vector<uint8_t> descriptorBody;
+    const unsigned int static DESCRIPTOR_HEADER_SIZE        = DescriptorView::DESCRIPTOR_HEADER_SIZE;
 public:
-    Descriptor(vector<uint8_t> &data);
-    Descriptor(vector<uint8_t> &data, uint8_t descTag);
+    Descriptor(const DescriptorView &view);
+    Descriptor(const DescriptorView &view, uint8_t descTag);
     Descriptor(uint8_t tag) : tag(tag) {}
 
     uint8_t tag;
@@ -49,21 +101,81 @@ public:
 };
 
 /**
- * Class representing vector of descriptors.
+ * Container of the descriptors with the lookup by the tag in the constant time.
+ * Presence of the tags is kept in the bitmap, the rank of the tag in the bitmap
+ * indexes the first and the last descriptor of the tag. Descriptors of the same
+ * tag are chained in the order in which they were added.
  */
-class Descriptors : public vector<shared_ptr<Descriptor>> {
+class Descriptors {
 public:
+    typedef vector<shared_ptr<Descriptor>, ArenaAllocator<shared_ptr<Descriptor>>> DescriptorVector;
+    typedef DescriptorVector::const_iterator const_iterator;
+
+    Descriptors();
+    Descriptors(Arena *arena);
+
+    void push_back(const shared_ptr<Descriptor> &descriptor);
+    void append(const Descriptors &other);
+
+    bool contains(uint8_t tag) const;
+    const Descriptor *find(uint8_t tag) const;
+
+    /**
+     * Returns the first descriptor of the specific type.
+     * @return Pointer to the descriptor owned by the container, null pointer if it is not present
+     */
     template <class SpecDescriptor>
-    bool getSpecificDescriptor(SpecDescriptor &descriptor) const {
-        vector<shared_ptr<Descriptor>>::const_iterator it = begin();
-        for (; it != end(); it++) {
-            if ((*it)->tag == descriptor.tag) {
-                descriptor = *static_cast<SpecDescriptor*>(it->get());
-                return true;
-            }
+    const SpecDescriptor *get() const {
+        return static_cast<const SpecDescriptor *>(find(SpecDescriptor::DESCRIPTOR_TAG));
+    }
+
+    /**
+     * Calls the visitor for all descriptors of the specific type in the order of the loop.
+     * @param visitor Function called with the constant reference to the descriptor
+     */
+    template <class SpecDescriptor, class Visitor>
+    void visit(Visitor visitor) const {
+        uint16_t index = firstIndex(SpecDescriptor::DESCRIPTOR_TAG);
+        for (; index != NO_INDEX; index = nextIndices[index]) {
+            visitor(static_cast<const SpecDescriptor &>(*descriptors[index]));
         }
-        return false;
     }
+
+    size_t size() const {
+        return descriptors.size();
+    }
+
+    bool empty() const {
+        return descriptors.empty();
+    }
+
+    const_iterator begin() const {
+        return descriptors.begin();
+    }
+
+    const_iterator end() const {
+        return descriptors.end();
+    }
+
+protected:
+    const static uint16_t NO_INDEX                  = 0xFFFF;
+    const static unsigned int BITMAP_WORDS          = 4;
+
+    /**
+     * First and last descriptor of the tag
+     */
+    struct TagIndex {
+        uint16_t first;
+        uint16_t last;
+    };
+
+    DescriptorVector descriptors;
+    vector<uint16_t, ArenaAllocator<uint16_t>> nextIndices;     // next descriptor of the same tag
+    vector<TagIndex, ArenaAllocator<TagIndex>> tagIndices;      // ordered by the tag
+    uint64_t tagBitmap[BITMAP_WORDS];
+
+    unsigned int rank(uint8_t tag) const;
+    uint16_t firstIndex(uint8_t tag) const;
 };
 
 /**
@@ -72,6 +184,7 @@ public:
 class DescriptorLoop {
 public:
     DescriptorLoop() : totalLength(0) {}
+    DescriptorLoop(Arena *arena) : descriptors(arena), totalLength(0) {}
 
     const unsigned int static DESCRIPTOR_LOOP_HEADER_SIZE        = 2;
 
@@ -84,8 +197,8 @@ public:
  */
 class DescriptorFactory {
 public:
-    static shared_ptr<Descriptor> readDescriptor(vector<uint8_t> &data);
-    static DescriptorLoop readDescriptorLoop(vector<uint8_t> &data);
+    static shared_ptr<Descriptor> readDescriptor(const DescriptorView &view, Arena *arena = 0);
+    static DescriptorLoop readDescriptorLoop(const uint8_t *data, size_t size, Arena *arena = 0);
 };
 
 /**
@@ -93,12 +206,12 @@ public:
  */
 class NetworkNameDescriptor : public Descriptor {
 public:
-    NetworkNameDescriptor(vector<uint8_t> &data);
+    NetworkNameDescriptor(const DescriptorView &view, Arena *arena = 0);
     NetworkNameDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                = 0x40;
 
-    string networkName;
+    ArenaString networkName;
 };
 
 /**
@@ -203,7 +316,7 @@ class TerrestialDeliverySystemDescriptor : public Descriptor {
 protected:
     const unsigned int static DESCRIPTOR_BODY_SIZE        = 11;
 public:
-    TerrestialDeliverySystemDescriptor(vector<uint8_t> &data);
+    TerrestialDeliverySystemDescriptor(const DescriptorView &view);
     TerrestialDeliverySystemDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                = 0x5A;
@@ -247,15 +360,15 @@ enum ServiceType {
  */
 class ServiceDescriptor : public Descriptor {
 public:
-    ServiceDescriptor(vector<uint8_t> &data);
+    ServiceDescriptor(const DescriptorView &view, Arena *arena = 0);
     ServiceDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                = 0x48;
 
     ServiceType serviceType;
 
-    string serviceProviderName;
-    string serviceName;
+    ArenaString serviceProviderName;
+    ArenaString serviceName;
 };
 
 /**
@@ -263,15 +376,15 @@ public:
  */
 class ShortEventDescriptor : public Descriptor {
 public:
-    ShortEventDescriptor(vector<uint8_t> &data);
+    ShortEventDescriptor(const DescriptorView &view, Arena *arena = 0);
     ShortEventDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                  = 0x4D;
     const unsigned int static DESCRIPTOR_CODE_LANGUAGE_SIZE   = 3;
 
-    string languageCode;
-    string eventName;
-    string eventText;
+    ArenaString languageCode;
+    ArenaString eventName;
+    ArenaString eventText;
 };
 
 /**
@@ -289,13 +402,13 @@ class ISO639LanguageDescriptor : public Descriptor {
 protected:
     const unsigned int static DESCRIPTOR_BODY_SIZE        = 4;
 public:
-    ISO639LanguageDescriptor(vector<uint8_t> &data);
+    ISO639LanguageDescriptor(const DescriptorView &view, Arena *arena = 0);
     ISO639LanguageDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                  = 0x0a;
     const unsigned int static DESCRIPTOR_CODE_LANGUAGE_SIZE   = 3;
 
-    string languageCode;
+    ArenaString languageCode;
     AudioType audioType;
 };
 
@@ -304,7 +417,7 @@ public:
  */
 class LocalTimeOffsetDescriptor : public Descriptor {
 public:
-    LocalTimeOffsetDescriptor(vector<uint8_t> &data);
+    LocalTimeOffsetDescriptor(const DescriptorView &view);
     LocalTimeOffsetDescriptor() : Descriptor(DESCRIPTOR_TAG) {}
 
     const unsigned int static DESCRIPTOR_TAG                  = 0x58;
@@ -317,16 +430,31 @@ public:
     struct tm timeOffset;
     struct tm timeOfChange;
     struct tm nextOffset;
+
+    int32_t timeOffsetSeconds;      // signed by the polarity
+    int64_t timeOfChangeUTC;        // seconds since 1970
+    int32_t nextOffsetSeconds;      // signed by the polarity
 };
 
 namespace DateTime {
     const static uint8_t DATETIME_SIZE = 5;
-    const static uint8_t TIME_SIZE = 2;
+    const static uint8_t TIME_SIZE = 3;
+    const static int64_t SECONDS_PER_DAY = 86400;
+    const static int64_t MJD_UNIX_EPOCH = 40587;     // MJD of 1970-01-01
+
+    /**
+     * Converts two digits of the binary coded decimal number.
+     * @param value Number in BCD
+     * @return Converted number
+     */
+    constexpr unsigned int fromBCD(uint8_t value) {
+        return (value >> 4) * 10 + (value & 0x0F);
+    }
 
-    struct tm parseDateTime(vector<uint8_t> &data);
-    struct tm parseTime(vector<uint8_t> &data);
-    int toHex(unsigned int number);
-    struct tm offset(struct tm& timeToOffset, struct tm &offsetTime);
+    int64_t parseDateTime(const uint8_t *data);
+    int32_t parseTime(const uint8_t *data);
+    struct tm toDateTime(int64_t timestamp);
+    struct tm toTime(int32_t seconds);
 }
 
 #endif // DESCRIPTORS_H
@@ -0,0 +1,229 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          EPGStore.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s indexovaným programovým průvodcem.
+ *
+ ******************************************************************************/
+
+/**
+ * @file EPGStore.cpp
+ *
+ * @brief Module with the indexed electronic program guide.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iterator>
+
+#include "EPGStore.h"
+
+using namespace std;
+
+/**
+ * Constructs empty program guide.
+ */
+EPGStore::EPGStore() : indexedEvents(0) {}
+
+/**
+ * Decides into which guide go the events of the table.
+ * @param tableID ID of the EIT.
+ * @return Type of the guide, NOT_INDEXED for EITs of the other transport streams.
+ */
+EPGStore::GuideType EPGStore::guideType(uint8_t tableID) {
+    if (tableID == EventInformationTable::EIT_PRESENT_TABLE_ID) {
+        return PRESENT_FOLLOWING;
+    }
+
+    if (tableID >= EventInformationTable::EIT_SCHEDULE_STARTTABLE_ID && tableID <= EventInformationTable::EIT_SCHEDULE_ENDTABLE_ID) {
+        return SCHEDULE;
+    }
+
+    return NOT_INDEXED;
+}
+
+/**
+ * @param EIT Section of the EIT.
+ * @return Key of the section which is unique within the transport stream.
+ */
+uint32_t EPGStore::sectionKey(const EventInformationTable &EIT) {
+    return (uint32_t)EIT.serviceID << 16 | (uint32_t)EIT.tableID << 8 | EIT.sectionNumber;
+}
+
+/**
+ * Drops reference of the section, section without any indexed event is freed.
+ * @param section Stored section.
+ */
+void EPGStore::release(SectionIterator section) {
+    if (--section->references == 0) {
+        forget(section);
+    }
+}
+
+/**
+ * Frees the section, none of its events may be indexed.
+ * @param section Stored section.
+ */
+void EPGStore::forget(SectionIterator section) {
+    unordered_map<uint32_t, SectionIterator>::iterator latest = sections.find(sectionKey(section->table));
+    if (latest != sections.end() && latest->second == section) {
+        sections.erase(latest);
+    }
+    tables.erase(section);
+}
+
+/**
+ * Removes events of the section which are still indexed from it and frees the section.
+ * @param section Stored section which has been superseded.
+ * @param guide Guide into which the section has been indexed.
+ */
+void EPGStore::unindex(SectionIterator section, Guide &guide) {
+    for (const Event &event : section->table.events) {
+        unordered_map<uint16_t, TimeKey>::iterator found = guide.byEventID.find(event.eventID);
+        if (found == guide.byEventID.end()) {
+            continue;
+        }
+
+        map<TimeKey, IndexedEvent>::iterator stored = guide.byTime.find(found->second);
+        if (stored->second.owner != section) {
+            continue;
+        }
+
+        guide.byTime.erase(stored);
+        guide.byEventID.erase(found);
+        indexedEvents--;
+        section->references--;
+    }
+
+    forget(section);
+}
+
+/**
+ * Indexes events of the EIT section. New version of the section replaces events
+ * of the previous one, event from the other section is replaced only when it comes
+ * with the other version of the table.
+ * @param EIT Section of the EIT, it is kept by the store if any of its events is indexed.
+ * @return Number of the new or updated events.
+ */
+size_t EPGStore::put(EventInformationTable &&EIT) {
+    GuideType type = guideType(EIT.tableID);
+    if (type == NOT_INDEXED) {
+        return 0;
+    }
+
+    Guide &guide = services[EIT.serviceID].guides[type];
+
+    unordered_map<uint32_t, SectionIterator>::iterator previous = sections.find(sectionKey(EIT));
+    if (previous != sections.end()) {
+        if (previous->second->table.versionNumber == EIT.versionNumber) {
+            return 0;
+        }
+        unindex(previous->second, guide);
+    }
+
+    tables.push_back(StoredSection(move(EIT)));
+    SectionIterator section = prev(tables.end());
+    const EventInformationTable &table = section->table;
+
+    size_t updated = 0;
+    for (const Event &event : table.events) {
+        TimeKey timeKey(event.startTimeUTC, event.eventID);
+
+        unordered_map<uint16_t, TimeKey>::iterator found = guide.byEventID.find(event.eventID);
+        if (found != guide.byEventID.end()) {
+            map<TimeKey, IndexedEvent>::iterator stored = guide.byTime.find(found->second);
+            if (stored->second.versionNumber == table.versionNumber) {
+                continue;
+            }
+
+            SectionIterator owner = stored->second.owner;
+            guide.byTime.erase(stored);
+            found->second = timeKey;
+            release(owner);
+        } else {
+            guide.byEventID.insert(make_pair(event.eventID, timeKey));
+            indexedEvents++;
+        }
+
+        IndexedEvent indexed = {&event, table.versionNumber, section};
+        guide.byTime[timeKey] = indexed;
+        section->references++;
+        updated++;
+    }
+
+    // Nothing points into the section
+    if (updated == 0) {
+        tables.pop_back();
+        return 0;
+    }
+
+    sections[sectionKey(table)] = section;
+    return updated;
+}
+
+/**
+ * Removes all events.
+ */
+void EPGStore::clear() {
+    services.clear();
+    sections.clear();
+    tables.clear();
+    indexedEvents = 0;
+}
+
+/**
+ * Returns events of the service ordered by their start time.
+ * @param serviceID ID of the service.
+ * @param type Type of the guide.
+ * @return Events owned by the store.
+ */
+vector<const Event *> EPGStore::events(uint16_t serviceID, GuideType type) const {
+    vector<const Event *> result;
+
+    map<uint16_t, ServiceGuides>::const_iterator service = services.find(serviceID);
+    if (service == services.end()) {
+        return result;
+    }
+
+    const Guide &guide = service->second.guides[type];
+    result.reserve(guide.byTime.size());
+    for (const pair<const TimeKey, IndexedEvent> &indexed : guide.byTime) {
+        result.push_back(indexed.second.event);
+    }
+
+    return result;
+}
+
+/**
+ * @param serviceID ID of the service.
+ * @return Present and following events of the service ordered by their start time.
+ */
+vector<const Event *> EPGStore::presentFollowing(uint16_t serviceID) const {
+    return events(serviceID, PRESENT_FOLLOWING);
+}
+
+/**
+ * @param serviceID ID of the service.
+ * @return Scheduled events of the service ordered by their start time.
+ */
+vector<const Event *> EPGStore::schedule(uint16_t serviceID) const {
+    return events(serviceID, SCHEDULE);
+}
+
+/**
+ * @return Number of the distinct events in all guides.
+ */
+size_t EPGStore::eventsCount() const {
+    return indexedEvents;
+}
+
+/**
+ * @return Number of the services with any EIT section.
+ */
+size_t EPGStore::servicesCount() const {
+    return services.size();
+}
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          EPGStore.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s indexovaným programovým průvodcem.
+ *
+ ******************************************************************************/
+
+/**
+ * @file EPGStore.h
+ *
+ * @brief Module with the indexed electronic program guide.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef EPGSTORE_H
+#define EPGSTORE_H
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+#include <cstddef>
+
+#include "EventInformationTable.h"
+
+using namespace std;
+
+/**
+ * Program guide built from EIT sections as they arrive. Events are indexed by
+ * the service, by the kind of the table (present/following or schedule) and
+ * by their event ID, every event is stored only once. Events of one service
+ * are kept ordered by their start time, so the lists are served without sorting.
+ * Section is kept only while some of its events is indexed, new version of the section
+ * replaces the previous one, so the memory is bounded by the number of the sections.
+ */
+class EPGStore {
+public:
+    EPGStore();
+
+    size_t put(EventInformationTable &&EIT);
+    void clear();
+
+    vector<const Event *> presentFollowing(uint16_t serviceID) const;
+    vector<const Event *> schedule(uint16_t serviceID) const;
+
+    size_t eventsCount() const;
+    size_t servicesCount() const;
+
+protected:
+    enum GuideType {
+        PRESENT_FOLLOWING   = 0,
+        SCHEDULE            = 1,
+        GUIDE_TYPES         = 2,
+        NOT_INDEXED         = -1
+    };
+
+    typedef pair<int64_t, uint16_t> TimeKey;    // start time and event ID
+
+    /**
+     * Section with the number of its indexed events
+     */
+    struct StoredSection {
+        StoredSection(EventInformationTable &&EIT) : table(move(EIT)), references(0) {}
+
+        EventInformationTable table;
+        size_t references;
+    };
+
+    typedef list<StoredSection>::iterator SectionIterator;
+
+    /**
+     * Event with the version of its table and the section which owns it
+     */
+    struct IndexedEvent {
+        const Event *event;
+        uint8_t versionNumber;
+        SectionIterator owner;
+    };
+
+    /**
+     * Events of one kind of the table for one service
+     */
+    struct Guide {
+        map<TimeKey, IndexedEvent> byTime;
+        unordered_map<uint16_t, TimeKey> byEventID;
+    };
+
+    /**
+     * All guides of the service
+     */
+    struct ServiceGuides {
+        Guide guides[GUIDE_TYPES];
+    };
+
+    list<StoredSection> tables;                 // owners of the indexed events
+    unordered_map<uint32_t, SectionIterator> sections;  // the latest stored version of the section
+    map<uint16_t, ServiceGuides> services;
+    size_t indexedEvents;
+
+    static GuideType guideType(uint8_t tableID);
+    static uint32_t sectionKey(const EventInformationTable &EIT);
+    void unindex(SectionIterator section, Guide &guide);
+    void release(SectionIterator section);
+    void forget(SectionIterator section);
+    vector<const Event *> events(uint16_t serviceID, GuideType type) const;
+};
+
+#endif // EPGSTORE_H
@@ -24,11 +24,13 @@
 #include "EventInformationTable.h"
 
 /**
- * Constructs event from the data vector.
- * @param data Vector with the event.
+ * Constructs event from the data of the section.
+ * @param data Data with the event.
+ * @param size Size of the data till the end of the event loop.
+ * @param arena Arena of the table.
  */
-Event::Event(vector<uint8_t> &data) {
-    if (data.size() < EVENT_HEADER_SIZE) {
+Event::Event(const uint8_t *data, size_t size, Arena *arena) {
+    if (size < EVENT_HEADER_SIZE + DescriptorLoop::DESCRIPTOR_LOOP_HEADER_SIZE) {
         throw runtime_error ("Unable to read header of transport stream, insufficient size of data!");
     }
 
@@ -38,21 +40,20 @@ Event::Event(vector<uint8_t> &data) {
     eventID |= data[1];
     readLength += 2;
 
-    vector<uint8_t> dateTimeData(&data[readLength], &data[data.size()]);
-    startTime = DateTime::parseDateTime(dateTimeData);
-    readLength += 5;
+    startTimeUTC = DateTime::parseDateTime(data + readLength);
+    startTime = DateTime::toDateTime(startTimeUTC);
+    readLength += DateTime::DATETIME_SIZE;
 
-    vector<uint8_t> timeData(&data[readLength], &data[data.size()]);
-    duration = DateTime::parseTime(timeData);
-    readLength += 2;
+    durationSeconds = DateTime::parseTime(data + readLength);
+    duration = DateTime::toTime(durationSeconds);
+    readLength += DateTime::TIME_SIZE;
 
     runningStatus = (RunningStatus)((data[readLength] & 0xE0) >> 5);
     freeCAMode = data[readLength] & 0x10;
     readLength++;
 
-    vector<uint8_t> descriptorsData(&data[EVENT_HEADER_SIZE], &data[data.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    descriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(data + EVENT_HEADER_SIZE, size - EVENT_HEADER_SIZE, arena);
+    descriptors = move(descriptorLoop.descriptors);
 
     totalLength = EVENT_HEADER_SIZE + descriptorLoop.totalLength;
 }
@@ -62,6 +63,7 @@ Event::Event(vector<uint8_t> &data) {
  * @param table SIT table which contains EIT.
  */
 EventInformationTable::EventInformationTable(ServiceInformationTable &table)
+    : arena(new Arena()), events(ArenaAllocator<Event>(arena.get()))
 {
     if (table.section.size() < EIT_HEADER_SIZE + ServiceInformationTable::PSI_CRC_SIZE) {
         throw runtime_error ("Unable to read header of EIT, insufficient size of SIT section!");
@@ -93,11 +95,9 @@ EventInformationTable::EventInformationTable(ServiceInformationTable &table)
     /* Read event loop */
 
     uint16_t tableEnd = table.section.size() - ServiceInformationTable::PSI_CRC_SIZE;
-    vector<uint8_t> eventData(&table.section[EIT_HEADER_SIZE], &table.section[tableEnd]);
-    while (!eventData.empty()) {
-        Event event(eventData);
-        events.push_back(event);
-        eventData.erase(eventData.begin(), eventData.begin() + event.totalLength);
+    for (uint16_t readSize = EIT_HEADER_SIZE; readSize < tableEnd; ) {
+        events.emplace_back(&table.section[readSize], tableEnd - readSize, arena.get());
+        readSize += events.back().totalLength;
     }
 }
 
@@ -110,3 +110,34 @@ shared_ptr<EventInformationTable> EventInformationTable::fromPacketStream(MPEG2I
     shared_ptr<ServiceInformationTable> sit = ServiceInformationTable::fromPacketStream(stream, EventInformationTable::EIT_PID);
     return (sit.get() != 0)? shared_ptr<EventInformationTable>(new EventInformationTable(*sit)) : 0;
 }
+
+/**
+ * Replaces the table by the other one. Members are swapped with the copy, so the replaced
+ * members are destroyed together with the copy before their arena is released.
+ * @param other Table which replaces this one.
+ * @return Reference to this table.
+ */
+EventInformationTable &EventInformationTable::operator=(EventInformationTable other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * Exchanges contents of the tables, arenas are exchanged together with the members they own.
+ * @param other Table with which to exchange the contents.
+ */
+void EventInformationTable::swap(EventInformationTable &other) {
+    using std::swap;
+    swap(tableID, other.tableID);
+    swap(serviceID, other.serviceID);
+    swap(versionNumber, other.versionNumber);
+    swap(currentNextIndicator, other.currentNextIndicator);
+    swap(sectionNumber, other.sectionNumber);
+    swap(lastSectionNumber, other.lastSectionNumber);
+    swap(transportStreamID, other.transportStreamID);
+    swap(originalNetworkID, other.originalNetworkID);
+    swap(segmentLastSectionNumber, other.segmentLastSectionNumber);
+    swap(lastTableID, other.lastTableID);
+    swap(arena, other.arena);
+    swap(events, other.events);
+}
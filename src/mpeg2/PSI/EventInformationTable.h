@@ -50,12 +50,14 @@ protected:
     const unsigned int static EVENT_HEADER_SIZE        = 10;
 public:
 
-    Event(vector<uint8_t> &data);
+    Event(const uint8_t *data, size_t size, Arena *arena);
 
     uint16_t eventID;
 
     struct tm startTime;
     struct tm duration;
+    int64_t startTimeUTC;       // seconds since 1970
+    int32_t durationSeconds;
 
     RunningStatus runningStatus;
     bool freeCAMode;
@@ -70,18 +72,30 @@ public:
 class EventInformationTable
 {
 protected:
-    const unsigned int static EIT_PID                   = 0x0012;
     const unsigned int static EIT_HEADER_SIZE           = 11;
 
 public:
+    const unsigned int static EIT_PID                   = 0x0012;
+
     EventInformationTable(ServiceInformationTable &table);
     EventInformationTable() {}
+    EventInformationTable(const EventInformationTable &) = default;
+    EventInformationTable(EventInformationTable &&) = default;
+    EventInformationTable &operator=(EventInformationTable other);
+
+    void swap(EventInformationTable &other);
 
     static shared_ptr<EventInformationTable> fromPacketStream(MPEG2InputStream &stream);
 
+    const unsigned int static EIT_FIRST_TABLE_ID          = 0x4E;
+    const unsigned int static EIT_LAST_TABLE_ID           = 0x6F;
     const unsigned int static EIT_PRESENT_TABLE_ID        = 0x4E;
     const unsigned int static EIT_SCHEDULE_STARTTABLE_ID  = 0x50;
     const unsigned int static EIT_SCHEDULE_ENDTABLE_ID    = 0x5F;
+    const unsigned int static EIT_ACTUAL_FILTER_ID        = 0x40;   // table IDs 0x40 - 0x5F, EITs of the actual TS
+    const unsigned int static EIT_ACTUAL_FILTER_MASK      = 0xE0;
+    const unsigned int static EIT_SEGMENT_SIZE            = 8;      // sections in one segment of the schedule
+    const unsigned int static EIT_SEGMENT_LAST_OFFSET     = 9;      // segment_last_section_number in the section
 
     uint8_t tableID;
     uint16_t serviceID;
@@ -94,7 +108,8 @@ public:
     uint8_t segmentLastSectionNumber;
     uint8_t lastTableID;
 
-    vector<Event> events;
+    shared_ptr<Arena> arena;    // memory of the events and their descriptors
+    vector<Event, ArenaAllocator<Event>> events;
 };
 
 #endif // EVENTINFORMATIONTABLE_H
@@ -25,15 +25,17 @@
 using namespace std;
 
 /**
- * Constructs transport stream from the data vector.
- * @param data Vector with the transport stream.
+ * Constructs transport stream from the data of the section.
+ * @param data Data with the transport stream.
+ * @param size Size of the data till the end of the transport stream loop.
+ * @param arena Arena of the table.
  */
-TransportStream::TransportStream(vector<uint8_t> &data) {
-    if (data.size() < STREAM_HEADER_SIZE) {
+TransportStream::TransportStream(const uint8_t *data, size_t size, Arena *arena) {
+    if (size < STREAM_HEADER_SIZE) {
         throw runtime_error ("Unable to read header of transport stream, insufficient size of data!");
     }
 
-    uint8_t *dataPtr = &data[0];
+    const uint8_t *dataPtr = data;
 
     transportStreamID = *dataPtr++ << 8;
     transportStreamID |= *dataPtr++;
@@ -41,9 +43,8 @@ TransportStream::TransportStream(vector<uint8_t> &data) {
     originalNetworkID = *dataPtr++ << 8;
     originalNetworkID |= *dataPtr++;
 
-    vector<uint8_t> descriptorsData(&data[STREAM_HEADER_SIZE], &data[data.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    descriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(data + STREAM_HEADER_SIZE, size - STREAM_HEADER_SIZE, arena);
+    descriptors = move(descriptorLoop.descriptors);
 
     totalLength = STREAM_HEADER_SIZE + descriptorLoop.totalLength;
 }
@@ -53,6 +54,17 @@ TransportStream::TransportStream(vector<uint8_t> &data) {
  * @param table SIT table which contains NIT.
  */
 NetworkInformationTable::NetworkInformationTable(ServiceInformationTable &table)
+    : NetworkInformationTable(table, shared_ptr<Arena>(new Arena()))
+{
+}
+
+/**
+ * Constructs NIT from the general SIT, memory of the NIT is taken from the passed arena.
+ * @param table SIT table which contains NIT.
+ * @param arena Arena which is shared with the other sections of the NIT.
+ */
+NetworkInformationTable::NetworkInformationTable(ServiceInformationTable &table, const shared_ptr<Arena> &arena)
+    : arena(arena), descriptors(arena.get()), streams(ArenaAllocator<TransportStream>(arena.get()))
 {
     if (table.section.size() < NIT_HEADER_SIZE) {
         throw runtime_error ("Unable to read header of NIT, insufficient size of SIT section!");
@@ -75,9 +87,8 @@ NetworkInformationTable::NetworkInformationTable(ServiceInformationTable &table)
 
     /* Read descriptor loop */
 
-    vector<uint8_t> descriptorsData(&table.section[NIT_HEADER_SIZE], &table.section[table.section.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    descriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(&table.section[NIT_HEADER_SIZE], table.section.size() - NIT_HEADER_SIZE, arena.get());
+    descriptors = move(descriptorLoop.descriptors);
 
     /* Read length of the transport stream loop */
 
@@ -92,11 +103,29 @@ NetworkInformationTable::NetworkInformationTable(ServiceInformationTable &table)
 
     /* Read transport stream loop */
 
-    vector<uint8_t> streamsData(&table.section[readSize], &table.section[readSize + streamsLength]);
-    while (!streamsData.empty()) {
-        TransportStream stream(streamsData);
-        streams.push_back(stream);
-        streamsData.erase(streamsData.begin(), streamsData.begin() + stream.totalLength);
+    size_t streamsEnd = readSize + streamsLength;
+    for (size_t streamStart = readSize; streamStart < streamsEnd; ) {
+        streams.emplace_back(&table.section[streamStart], streamsEnd - streamStart, arena.get());
+        streamStart += streams.back().totalLength;
+    }
+}
+
+/**
+ * Constructs NIT from all its sections, descriptors and transport streams of the sections are joined
+ * in the arena of the first section.
+ * @param sections Sections of the NIT ordered by their numbers.
+ */
+NetworkInformationTable::NetworkInformationTable(vector<ServiceInformationTable> &sections)
+{
+    if (sections.empty()) {
+        throw runtime_error ("Unable to construct NIT without any section!");
+    }
+
+    *this = NetworkInformationTable(sections[0]);
+    for (size_t i = 1; i < sections.size(); i++) {
+        NetworkInformationTable section(sections[i], arena);
+        descriptors.append(section.descriptors);
+        streams.insert(streams.end(), section.streams.begin(), section.streams.end());
     }
 }
 
@@ -119,3 +148,31 @@ shared_ptr<NetworkInformationTable> NetworkInformationTable::fromPacketStream(MP
     shared_ptr<ServiceInformationTable> sit = ServiceInformationTable::fromPacketStream(stream, pid);
     return (sit.get() != 0)? shared_ptr<NetworkInformationTable>(new NetworkInformationTable(*sit)) : 0;
 }
+
+/**
+ * Replaces the table by the other one. Members are swapped with the copy, so the replaced
+ * members are destroyed together with the copy before their arena is released.
+ * @param other Table which replaces this one.
+ * @return Reference to this table.
+ */
+NetworkInformationTable &NetworkInformationTable::operator=(NetworkInformationTable other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * Exchanges contents of the tables, arenas are exchanged together with the members they own.
+ * @param other Table with which to exchange the contents.
+ */
+void NetworkInformationTable::swap(NetworkInformationTable &other) {
+    using std::swap;
+    swap(networkID, other.networkID);
+    swap(versionNumber, other.versionNumber);
+    swap(currentNextIndicator, other.currentNextIndicator);
+    swap(sectionNumber, other.sectionNumber);
+    swap(lastSectionNumber, other.lastSectionNumber);
+    swap(tableID, other.tableID);
+    swap(arena, other.arena);
+    swap(descriptors, other.descriptors);
+    swap(streams, other.streams);
+}
@@ -36,7 +36,7 @@ class TransportStream {
 protected:
     const unsigned int static STREAM_HEADER_SIZE        = 4;
 public:
-    TransportStream(vector<uint8_t> &data);
+    TransportStream(const uint8_t *data, size_t size, Arena *arena);
 
     uint16_t transportStreamID;
     uint16_t originalNetworkID;
@@ -54,9 +54,17 @@ class NetworkInformationTable
 protected:
     const uint16_t static NIT_HEADER_SIZE           = 5;
 
+    NetworkInformationTable(ServiceInformationTable &table, const shared_ptr<Arena> &arena);
+
 public:
     NetworkInformationTable() {}
+    NetworkInformationTable(const NetworkInformationTable &) = default;
+    NetworkInformationTable(NetworkInformationTable &&) = default;
+    NetworkInformationTable &operator=(NetworkInformationTable other);
+
+    void swap(NetworkInformationTable &other);
     NetworkInformationTable(ServiceInformationTable &table);
+    NetworkInformationTable(vector<ServiceInformationTable> &sections);
 
     static shared_ptr<NetworkInformationTable> fromPacketStream(MPEG2InputStream &stream);
     static shared_ptr<NetworkInformationTable> fromPacketStream(MPEG2InputStream &stream, uint16_t pid);
@@ -72,8 +80,9 @@ public:
     uint8_t lastSectionNumber;
     uint8_t tableID;
 
+    shared_ptr<Arena> arena;    // memory of the streams and the descriptors
     Descriptors descriptors;
-    vector<TransportStream> streams;
+    vector<TransportStream, ArenaAllocator<TransportStream>> streams;
 };
 
 #endif // NETWORKINFORMATIONTABLE_H
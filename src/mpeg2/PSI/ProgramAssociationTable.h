@@ -39,10 +39,11 @@ class ProgramAssociationTable
 {
 protected:
     const unsigned int static PAT_HEADER_SIZE   = 5;
+
+public:
     const uint16_t static PAT_PID               = 0x0000;
     const uint8_t static PAT_TABLE_ID           = 0x00;
 
-public:
     uint16_t transportStreamID;
     uint8_t versionNumber;
     bool currentNextIndicator;
@@ -25,15 +25,17 @@
 using namespace std;
 
 /**
- * Constructs program stream from the data vector.
- * @param data Vector with the program stream.
+ * Constructs program stream from the data of the section.
+ * @param data Data with the program stream.
+ * @param size Size of the data till the end of the program stream loop.
+ * @param arena Arena of the table.
  */
-ProgramStream::ProgramStream(vector<uint8_t> &data) {
-    if (data.size() < STREAM_HEADER_SIZE) {
+ProgramStream::ProgramStream(const uint8_t *data, size_t size, Arena *arena) {
+    if (size < STREAM_HEADER_SIZE) {
         throw runtime_error ("Unable to read header of program stream, insufficient size of data!");
     }
 
-    uint8_t *dataPtr = &data[0];
+    const uint8_t *dataPtr = data;
 
     /* Read Program stream header */
 
@@ -44,9 +46,8 @@ ProgramStream::ProgramStream(vector<uint8_t> &data) {
 
     /* Read descriptors */
 
-    vector<uint8_t> descriptorsData(&data[STREAM_HEADER_SIZE], &data[data.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    ESDescriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(data + STREAM_HEADER_SIZE, size - STREAM_HEADER_SIZE, arena);
+    ESDescriptors = move(descriptorLoop.descriptors);
 
     totalLength = STREAM_HEADER_SIZE + descriptorLoop.totalLength;
 }
@@ -56,6 +57,7 @@ ProgramStream::ProgramStream(vector<uint8_t> &data) {
  * @param table SIT table which contains PMT.
  */
 ProgramMapTable::ProgramMapTable(ServiceInformationTable &table)
+    : arena(new Arena()), programDescriptors(arena.get()), streams(ArenaAllocator<ProgramStream>(arena.get()))
 {
     if (table.section.size() < PMT_HEADER_SIZE + ServiceInformationTable::PSI_CRC_SIZE) {
         throw runtime_error ("Unable to read header of SDT, insufficient size of SIT section!");
@@ -85,19 +87,16 @@ ProgramMapTable::ProgramMapTable(ServiceInformationTable &table)
 
     /* Read PMT descriptors */
 
-    vector<uint8_t> descriptorsData(&table.section[PMT_HEADER_SIZE], &table.section[table.section.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    programDescriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(&table.section[PMT_HEADER_SIZE], table.section.size() - PMT_HEADER_SIZE, arena.get());
+    programDescriptors = move(descriptorLoop.descriptors);
 
     /* Read program stream loop */
 
     uint16_t tableStart = PMT_HEADER_SIZE + descriptorLoop.totalLength;
     uint16_t tableEnd = table.section.size() - ServiceInformationTable::PSI_CRC_SIZE;
-    vector<uint8_t> streamData(&table.section[tableStart], &table.section[tableEnd]);
-    while (!streamData.empty()) {
-        ProgramStream stream(streamData);
-        streams.push_back(stream);
-        streamData.erase(streamData.begin(), streamData.begin() + stream.totalLength);
+    for (uint16_t readSize = tableStart; readSize < tableEnd; ) {
+        streams.emplace_back(&table.section[readSize], tableEnd - readSize, arena.get());
+        readSize += streams.back().totalLength;
     }
 }
 
@@ -111,3 +110,33 @@ shared_ptr<ProgramMapTable> ProgramMapTable::fromPacketStream(MPEG2InputStream &
     shared_ptr<ServiceInformationTable> sit = ServiceInformationTable::fromPacketStream(stream, pid);
     return (sit.get() != 0)? shared_ptr<ProgramMapTable>(new ProgramMapTable(*sit)) : 0;
 }
+
+/**
+ * Replaces the table by the other one. Members are swapped with the copy, so the replaced
+ * members are destroyed together with the copy before their arena is released.
+ * @param other Table which replaces this one.
+ * @return Reference to this table.
+ */
+ProgramMapTable &ProgramMapTable::operator=(ProgramMapTable other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * Exchanges contents of the tables, arenas are exchanged together with the members they own.
+ * @param other Table with which to exchange the contents.
+ */
+void ProgramMapTable::swap(ProgramMapTable &other) {
+    using std::swap;
+    swap(tableID, other.tableID);
+    swap(tablePID, other.tablePID);
+    swap(programNumber, other.programNumber);
+    swap(versionNumber, other.versionNumber);
+    swap(currentNextIndicator, other.currentNextIndicator);
+    swap(sectionNumber, other.sectionNumber);
+    swap(lastSectionNumber, other.lastSectionNumber);
+    swap(PCR_PID, other.PCR_PID);
+    swap(arena, other.arena);
+    swap(programDescriptors, other.programDescriptors);
+    swap(streams, other.streams);
+}
@@ -58,7 +58,7 @@ public:
         DOLBY_AC3_AUDIO                  = 0x81
     } StreamType;
 
-    ProgramStream(vector<uint8_t> &data);
+    ProgramStream(const uint8_t *data, size_t size, Arena *arena);
 
     StreamType streamType;
     uint16_t elementaryPID;
@@ -75,10 +75,15 @@ class ProgramMapTable
 {
 protected:
     const unsigned int static PMT_HEADER_SIZE        = 7;
-    const uint8_t static PMT_TABLE_ID                = 0x02;
 public:
+    const uint8_t static PMT_TABLE_ID                = 0x02;
     ProgramMapTable(ServiceInformationTable &table);
     ProgramMapTable() {}
+    ProgramMapTable(const ProgramMapTable &) = default;
+    ProgramMapTable(ProgramMapTable &&) = default;
+    ProgramMapTable &operator=(ProgramMapTable other);
+
+    void swap(ProgramMapTable &other);
 
     static shared_ptr<ProgramMapTable> fromPacketStream(MPEG2InputStream &stream, uint16_t pid);
 
@@ -91,8 +96,9 @@ public:
     uint8_t sectionNumber;
     uint8_t lastSectionNumber;
     uint16_t PCR_PID;
+    shared_ptr<Arena> arena;    // memory of the streams and the descriptors
     Descriptors programDescriptors;
-    vector<ProgramStream> streams;
+    vector<ProgramStream, ArenaAllocator<ProgramStream>> streams;
 };
 
 #endif // PROGRAMMAPTABLE_H
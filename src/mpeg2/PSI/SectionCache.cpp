@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          SectionCache.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s pamětí již zpracovaných sekcí PSI tabulek.
+ *
+ ******************************************************************************/
+
+/**
+ * @file SectionCache.cpp
+ *
+ * @brief Module with the cache of already processed sections of PSI tables.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include "SectionCache.h"
+
+/**
+ * Constructs empty cache.
+ */
+SectionCache::SectionCache() : repeated(0) {}
+
+/**
+ * Tests whether the section can be cached. Only current sections with the long syntax
+ * are cached, next versions are not applicable yet.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ * @return True if section can be cached, otherwise false.
+ */
+bool SectionCache::isCacheable(const uint8_t *section, size_t size) {
+    return size >= LONG_HEADER_SIZE + CRC_SIZE && (section[1] & 0x80) && (section[5] & 0x01);
+}
+
+/**
+ * Reads key of the section from its header.
+ * @param PID PID of the section.
+ * @param section Whole section including its header.
+ * @return Key of the section.
+ */
+SectionKey SectionCache::sectionKey(uint16_t PID, const uint8_t *section) {
+    SectionKey key;
+    key.PID = PID;
+    key.tableID = section[0];
+    key.tableIDExtension = section[3] << 8 | section[4];
+    key.sectionNumber = section[6];
+    return key;
+}
+
+/**
+ * Packs key of the section into one number.
+ * @param key Key of the section.
+ * @return Packed key.
+ */
+uint64_t SectionCache::packKey(const SectionKey &key) {
+    return (uint64_t)key.PID << 32 | (uint64_t)key.tableID << 24 | (uint64_t)key.tableIDExtension << 8 | key.sectionNumber;
+}
+
+/**
+ * Reads version and CRC of the section.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ * @return Entry of the cache.
+ */
+SectionCache::Entry SectionCache::sectionEntry(const uint8_t *section, size_t size) {
+    const uint8_t *crc = section + size - CRC_SIZE;
+
+    Entry entry;
+    entry.versionNumber = (section[5] >> 1) & 0x1F;
+    entry.crc = (uint32_t)crc[0] << 24 | (uint32_t)crc[1] << 16 | (uint32_t)crc[2] << 8 | crc[3];
+    return entry;
+}
+
+/**
+ * Tests whether the same section has been already processed. It is called before
+ * the CRC is verified, corrupted repetition is skipped as well as the correct one.
+ * @param PID PID of the section.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ * @return True if section has the same version and CRC as the cached one, otherwise false.
+ */
+bool SectionCache::isUnchanged(uint16_t PID, const uint8_t *section, size_t size) {
+    if (!isCacheable(section, size)) {
+        return false;
+    }
+
+    unordered_map<uint64_t, Entry>::const_iterator it = entries.find(packKey(sectionKey(PID, section)));
+    if (it == entries.end()) {
+        return false;
+    }
+
+    Entry entry = sectionEntry(section, size);
+    if (it->second.versionNumber != entry.versionNumber || it->second.crc != entry.crc) {
+        return false;
+    }
+
+    repeated++;
+    return true;
+}
+
+/**
+ * Notifies about the verified section which is not in the cache or differs from the cached one.
+ * It is called before the section is parsed, the cache itself is not changed.
+ * @param PID PID of the section.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ */
+void SectionCache::notifyChange(uint16_t PID, const uint8_t *section, size_t size) const {
+    if (!callback || !isCacheable(section, size)) {
+        return;
+    }
+
+    SectionKey key = sectionKey(PID, section);
+    Entry entry = sectionEntry(section, size);
+
+    Change change = SECTION_NEW;
+    unordered_map<uint64_t, Entry>::const_iterator it = entries.find(packKey(key));
+    if (it != entries.end()) {
+        if (it->second.versionNumber == entry.versionNumber && it->second.crc == entry.crc) {
+            return;
+        }
+        change = (it->second.versionNumber != entry.versionNumber)? SECTION_VERSION : SECTION_CONTENT;
+    }
+
+    callback(key, entry.versionNumber, change);
+}
+
+/**
+ * Stores the verified section into the cache.
+ * @param PID PID of the section.
+ * @param section Whole section including its header.
+ * @param size Size of the section.
+ */
+void SectionCache::update(uint16_t PID, const uint8_t *section, size_t size) {
+    if (!isCacheable(section, size)) {
+        return;
+    }
+
+    entries[packKey(sectionKey(PID, section))] = sectionEntry(section, size);
+}
+
+/**
+ * Forgets all cached sections.
+ */
+void SectionCache::clear() {
+    entries.clear();
+    repeated = 0;
+}
+
+/**
+ * Sets function which is called when new or changed section is going to be parsed.
+ * @param callback Function which is notified about the changes.
+ */
+void SectionCache::setChangeCallback(ChangeCallback callback) {
+    this->callback = callback;
+}
+
+/**
+ * @return Number of the cached sections.
+ */
+size_t SectionCache::sectionsCount() const {
+    return entries.size();
+}
+
+/**
+ * @return Number of the repeated sections which have been recognized.
+ */
+unsigned long SectionCache::repeatedSections() const {
+    return repeated;
+}
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          SectionCache.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s pamětí již zpracovaných sekcí PSI tabulek.
+ *
+ ******************************************************************************/
+
+/**
+ * @file SectionCache.h
+ *
+ * @brief Module with the cache of already processed sections of PSI tables.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SECTIONCACHE_H
+#define SECTIONCACHE_H
+
+#include <functional>
+#include <unordered_map>
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Identification of the section within the multiplex.
+ */
+struct SectionKey {
+    uint16_t PID;
+    uint8_t tableID;
+    uint16_t tableIDExtension;
+    uint8_t sectionNumber;
+};
+
+/**
+ * Cache of the sections with the long syntax. It remembers version and CRC of every
+ * section by its key, so repeated sections can be recognized before they are parsed.
+ * New and changed sections are announced by the change callback before they are parsed.
+ */
+class SectionCache {
+public:
+    enum Change {
+        SECTION_NEW,            // section has not been seen yet
+        SECTION_VERSION,        // version number has changed
+        SECTION_CONTENT         // same version, but different CRC
+    };
+
+    typedef function<void (const SectionKey &key, uint8_t versionNumber, Change change)> ChangeCallback;
+
+    const static unsigned int LONG_HEADER_SIZE  = 8;
+    const static unsigned int CRC_SIZE          = 4;
+
+    SectionCache();
+
+    bool isUnchanged(uint16_t PID, const uint8_t *section, size_t size);
+    void notifyChange(uint16_t PID, const uint8_t *section, size_t size) const;
+    void update(uint16_t PID, const uint8_t *section, size_t size);
+    void clear();
+
+    void setChangeCallback(ChangeCallback callback);
+    size_t sectionsCount() const;
+    unsigned long repeatedSections() const;
+
+protected:
+    /**
+     * Remembered state of the section.
+     */
+    struct Entry {
+        uint8_t versionNumber;
+        uint32_t crc;
+    };
+
+    unordered_map<uint64_t, Entry> entries;
+    unsigned long repeated;
+    ChangeCallback callback;
+
+    static bool isCacheable(const uint8_t *section, size_t size);
+    static SectionKey sectionKey(uint16_t PID, const uint8_t *section);
+    static uint64_t packKey(const SectionKey &key);
+    static Entry sectionEntry(const uint8_t *section, size_t size);
+};
+
+#endif // SECTIONCACHE_H
@@ -23,15 +23,17 @@
 #include "ServiceDescriptionTable.h"
 
 /**
- * Constructs service from the data vector.
- * @param data Vector with the service.
+ * Constructs service from the data of the section.
+ * @param data Data with the service.
+ * @param size Size of the data till the end of the service loop.
+ * @param arena Arena of the table.
  */
-Service::Service(vector<uint8_t> &data) {
-    if (data.size() < SERVICE_HEADER_SIZE) {
+Service::Service(const uint8_t *data, size_t size, Arena *arena) {
+    if (size < SERVICE_HEADER_SIZE) {
         throw runtime_error ("Unable to read header of service, insufficient size of data!");
     }
 
-    uint8_t *dataPtr = &data[0];
+    const uint8_t *dataPtr = data;
 
     /* Read service header */
 
@@ -46,9 +48,8 @@ Service::Service(vector<uint8_t> &data) {
 
     /* Read service descriptors */
 
-    vector<uint8_t> descriptorsData(&data[SERVICE_HEADER_SIZE], &data[data.size()]);
-    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
-    descriptors = descriptorLoop.descriptors;
+    DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(data + SERVICE_HEADER_SIZE, size - SERVICE_HEADER_SIZE, arena);
+    descriptors = move(descriptorLoop.descriptors);
 
     totalLength = SERVICE_HEADER_SIZE + descriptorLoop.totalLength;
 }
@@ -58,6 +59,17 @@ Service::Service(vector<uint8_t> &data) {
  * @param table SIT table which contains SDT.
  */
 ServiceDescriptionTable::ServiceDescriptionTable(ServiceInformationTable &table)
+    : ServiceDescriptionTable(table, shared_ptr<Arena>(new Arena()))
+{
+}
+
+/**
+ * Constructs SDT from the general SIT, memory of the SDT is taken from the passed arena.
+ * @param table SIT table which contains SDT.
+ * @param arena Arena which is shared with the other sections of the SDT.
+ */
+ServiceDescriptionTable::ServiceDescriptionTable(ServiceInformationTable &table, const shared_ptr<Arena> &arena)
+    : arena(arena), services(ArenaAllocator<Service>(arena.get()))
 {
     if (table.section.size() < SDT_HEADER_SIZE + ServiceInformationTable::PSI_CRC_SIZE) {
         throw runtime_error ("Unable to read header of SDT, insufficient size of SIT section!");
@@ -88,11 +100,26 @@ ServiceDescriptionTable::ServiceDescriptionTable(ServiceInformationTable &table)
     /* Read SDT descriptors */
 
     uint16_t tableEnd = table.section.size() - ServiceInformationTable::PSI_CRC_SIZE;
-    vector<uint8_t> serviceData(&table.section[SDT_HEADER_SIZE], &table.section[tableEnd]);
-    while (!serviceData.empty()) {
-        Service service(serviceData);
-        services.push_back(service);
-        serviceData.erase(serviceData.begin(), serviceData.begin() + service.totalLength);
+    for (uint16_t readSize = SDT_HEADER_SIZE; readSize < tableEnd; ) {
+        services.emplace_back(&table.section[readSize], tableEnd - readSize, arena.get());
+        readSize += services.back().totalLength;
+    }
+}
+
+/**
+ * Constructs SDT from all its sections, services of the sections are joined in the arena of the first section.
+ * @param sections Sections of the SDT ordered by their numbers.
+ */
+ServiceDescriptionTable::ServiceDescriptionTable(vector<ServiceInformationTable> &sections)
+{
+    if (sections.empty()) {
+        throw runtime_error ("Unable to construct SDT without any section!");
+    }
+
+    *this = ServiceDescriptionTable(sections[0]);
+    for (size_t i = 1; i < sections.size(); i++) {
+        ServiceDescriptionTable section(sections[i], arena);
+        services.insert(services.end(), section.services.begin(), section.services.end());
     }
 }
 
@@ -105,3 +132,31 @@ shared_ptr<ServiceDescriptionTable> ServiceDescriptionTable::fromPacketStream(MP
     shared_ptr<ServiceInformationTable> sit = ServiceInformationTable::fromPacketStream(stream, ServiceDescriptionTable::SDT_PID);
     return (sit.get() != 0)? shared_ptr<ServiceDescriptionTable>(new ServiceDescriptionTable(*sit)) : 0;
 }
+
+/**
+ * Replaces the table by the other one. Members are swapped with the copy, so the replaced
+ * members are destroyed together with the copy before their arena is released.
+ * @param other Table which replaces this one.
+ * @return Reference to this table.
+ */
+ServiceDescriptionTable &ServiceDescriptionTable::operator=(ServiceDescriptionTable other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * Exchanges contents of the tables, arenas are exchanged together with the members they own.
+ * @param other Table with which to exchange the contents.
+ */
+void ServiceDescriptionTable::swap(ServiceDescriptionTable &other) {
+    using std::swap;
+    swap(transportStreamID, other.transportStreamID);
+    swap(versionNumber, other.versionNumber);
+    swap(currentNextIndicator, other.currentNextIndicator);
+    swap(sectionNumber, other.sectionNumber);
+    swap(lastSectionNumber, other.lastSectionNumber);
+    swap(originalNetworkID, other.originalNetworkID);
+    swap(tableID, other.tableID);
+    swap(arena, other.arena);
+    swap(services, other.services);
+}
@@ -37,7 +37,7 @@ class Service {
 protected:
     const unsigned int static SERVICE_HEADER_SIZE        = 3;
 public:
-    Service(vector<uint8_t> &data);
+    Service(const uint8_t *data, size_t size, Arena *arena);
 
     uint16_t serviceID;
     bool EITScheduleFlag;
@@ -56,11 +56,20 @@ public:
 class ServiceDescriptionTable
 {
 protected:
-    const uint16_t static SDT_PID                    = 0x0011;
     const unsigned int static SDT_HEADER_SIZE        = 8;
+
+    ServiceDescriptionTable(ServiceInformationTable &table, const shared_ptr<Arena> &arena);
 public:
+    const uint16_t static SDT_PID                    = 0x0011;
+
     ServiceDescriptionTable(ServiceInformationTable &table);
+    ServiceDescriptionTable(vector<ServiceInformationTable> &sections);
     ServiceDescriptionTable() {}
+    ServiceDescriptionTable(const ServiceDescriptionTable &) = default;
+    ServiceDescriptionTable(ServiceDescriptionTable &&) = default;
+    ServiceDescriptionTable &operator=(ServiceDescriptionTable other);
+
+    void swap(ServiceDescriptionTable &other);
 
     static shared_ptr<ServiceDescriptionTable> fromPacketStream(MPEG2InputStream &stream);
 
@@ -75,7 +84,8 @@ public:
     uint16_t originalNetworkID;
     uint8_t tableID;
 
-    vector<Service> services;
+    shared_ptr<Arena> arena;    // memory of the services and their descriptors
+    vector<Service, ArenaAllocator<Service>> services;
 };
 
 #endif // SERVICEDESCRIPTIONTABLE_H
@@ -22,6 +22,7 @@
 #define PSITABLE_H
 
 #include <memory>
+#include <vector>
 
 #include "../streams/MPEG2InputStream.h"
 
@@ -62,6 +63,14 @@ public:
     const unsigned int static PSI_MINSIZE           = 13;
     const unsigned int static PSI_HEADER_SIZE       = 3;
     const unsigned int static PSI_CRC_SIZE          = 4;
+    const unsigned int static PSI_LONG_HEADER_SIZE  = 5;
+
+    bool hasLongHeader() const;
+    uint16_t tableIDExtension() const;
+    uint8_t versionNumber() const;
+    bool currentNextIndicator() const;
+    uint8_t sectionNumber() const;
+    uint8_t lastSectionNumber() const;
 
     uint16_t pid;
     uint8_t tableID;
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          TableAssembler.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro skládání PSI tabulek z více sekcí.
+ *
+ ******************************************************************************/
+
+/**
+ * @file TableAssembler.cpp
+ *
+ * @brief Module for assembling PSI tables from more sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include "TableAssembler.h"
+#include "EventInformationTable.h"
+
+/**
+ * Constructs empty assembler.
+ * @param storeSections True if sections should be stored, otherwise only the received
+ * section numbers are tracked.
+ */
+TableAssembler::TableAssembler(bool storeSections) : storeSections(storeSections) {}
+
+/**
+ * Packs table ID and its extension into the key of the sub-table.
+ * @param tableID Table ID.
+ * @param tableIDExtension Extension of the table ID.
+ * @return Key of the sub-table.
+ */
+uint32_t TableAssembler::tableKey(uint8_t tableID, uint16_t tableIDExtension) {
+    return (uint32_t)tableID << 16 | tableIDExtension;
+}
+
+/**
+ * Tests whether the sections of the table are divided into the segments.
+ * @param tableID Table ID.
+ * @return True for EIT tables, otherwise false.
+ */
+bool TableAssembler::isSegmented(uint8_t tableID) {
+    return tableID >= EventInformationTable::EIT_FIRST_TABLE_ID && tableID <= EventInformationTable::EIT_LAST_TABLE_ID;
+}
+
+/**
+ * Tests whether all sections of the sub-table are present. Segmented table is complete
+ * when every segment has all sections up to its segment last section number.
+ * @param table Sub-table.
+ * @return True if the table is complete, otherwise false.
+ */
+bool TableAssembler::isComplete(const SubTable &table) {
+    if (!table.segmented) {
+        for (unsigned int i = 0; i <= table.lastSectionNumber; i++) {
+            if (!table.received[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const unsigned int SEGMENT_SIZE = EventInformationTable::EIT_SEGMENT_SIZE;
+    for (unsigned int segment = 0; segment <= table.lastSectionNumber / SEGMENT_SIZE; segment++) {
+        // Last section of the segment is known from any of its sections
+        unsigned int first = segment * SEGMENT_SIZE;
+        unsigned int i = first;
+        while (i < first + SEGMENT_SIZE && !table.received[i]) {
+            i++;
+        }
+        if (i == first + SEGMENT_SIZE) {
+            return false;
+        }
+
+        unsigned int last = min<unsigned int>(table.segmentLastSection[segment], first + SEGMENT_SIZE - 1);
+        for (i = first; i <= last; i++) {
+            if (!table.received[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Stores the section into its sub-table. Sections of the new version replace the old ones.
+ * @param section Section with the long header.
+ * @return Result of storing the section.
+ */
+TableAssembler::Result TableAssembler::put(const ServiceInformationTable &section) {
+    if (!section.hasLongHeader() || !section.currentNextIndicator()) {
+        return SECTION_IGNORED;
+    }
+
+    bool segmented = isSegmented(section.tableID);
+    if (segmented && section.section.size() <= EventInformationTable::EIT_SEGMENT_LAST_OFFSET) {
+        return SECTION_IGNORED;
+    }
+
+    uint8_t sectionNumber = section.sectionNumber();
+    if (sectionNumber > section.lastSectionNumber()) {
+        return SECTION_IGNORED;
+    }
+
+    pair<map<uint32_t, SubTable>::iterator, bool> inserted = tables.insert(make_pair(tableKey(section.tableID, section.tableIDExtension()), SubTable()));
+    SubTable &table = inserted.first->second;
+
+    /* New sub-table or new version of it */
+    if (inserted.second || table.versionNumber != section.versionNumber() || table.lastSectionNumber != section.lastSectionNumber()) {
+        table.versionNumber = section.versionNumber();
+        table.lastSectionNumber = section.lastSectionNumber();
+        table.segmented = segmented;
+        table.complete = false;
+        table.received.reset();
+        table.sections.clear();
+    }
+
+    if (table.received[sectionNumber]) {
+        return SECTION_IGNORED;
+    }
+
+    table.received[sectionNumber] = true;
+    if (storeSections) {
+        table.sections.insert(make_pair(sectionNumber, section));
+    }
+    if (segmented) {
+        table.segmentLastSection[sectionNumber / EventInformationTable::EIT_SEGMENT_SIZE] = section.section[EventInformationTable::EIT_SEGMENT_LAST_OFFSET];
+    }
+
+    if (table.complete) {
+        return SECTION_STORED;
+    }
+
+    table.complete = isComplete(table);
+    return table.complete? TABLE_COMPLETE : SECTION_STORED;
+}
+
+/**
+ * Forgets all sub-tables.
+ */
+void TableAssembler::clear() {
+    tables.clear();
+}
+
+/**
+ * Returns sections of the sub-table ordered by their numbers.
+ * @param table Sub-table.
+ * @return Sections of the sub-table.
+ */
+vector<ServiceInformationTable> TableAssembler::orderedSections(const SubTable &table) {
+    vector<ServiceInformationTable> result;
+    result.reserve(table.sections.size());
+    for (const pair<const uint8_t, ServiceInformationTable> &keyVal : table.sections) {
+        result.push_back(keyVal.second);
+    }
+    return result;
+}
+
+/**
+ * Returns stored sections of the sub-table.
+ * @param tableID Table ID.
+ * @param tableIDExtension Extension of the table ID.
+ * @return Sections ordered by their numbers, empty if sub-table is not known
+ * or sections are not stored.
+ */
+vector<ServiceInformationTable> TableAssembler::sections(uint8_t tableID, uint16_t tableIDExtension) const {
+    map<uint32_t, SubTable>::const_iterator it = tables.find(tableKey(tableID, tableIDExtension));
+    return (it != tables.end())? orderedSections(it->second) : vector<ServiceInformationTable>();
+}
+
+/**
+ * Returns stored sections of the first sub-table with the table ID, it is used when
+ * the table could not be completed.
+ * @param tableID Table ID.
+ * @return Sections ordered by their numbers, empty if there is no such sub-table
+ * or sections are not stored.
+ */
+vector<ServiceInformationTable> TableAssembler::firstSections(uint8_t tableID) const {
+    map<uint32_t, SubTable>::const_iterator it = tables.lower_bound(tableKey(tableID, 0));
+    if (it == tables.end() || (it->first >> 16) != tableID) {
+        return vector<ServiceInformationTable>();
+    }
+    return orderedSections(it->second);
+}
+
+/**
+ * Tests whether the sub-table is complete.
+ * @param tableID Table ID.
+ * @param tableIDExtension Extension of the table ID.
+ * @return True if all its sections are present, otherwise false.
+ */
+bool TableAssembler::isComplete(uint8_t tableID, uint16_t tableIDExtension) const {
+    map<uint32_t, SubTable>::const_iterator it = tables.find(tableKey(tableID, tableIDExtension));
+    return it != tables.end() && it->second.complete;
+}
+
+/**
+ * @return True if all known sub-tables are complete, otherwise false.
+ */
+bool TableAssembler::allComplete() const {
+    for (const pair<const uint32_t, SubTable> &keyVal : tables) {
+        if (!keyVal.second.complete) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @return Number of the known sub-tables.
+ */
+size_t TableAssembler::tablesCount() const {
+    return tables.size();
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          TableAssembler.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro skládání PSI tabulek z více sekcí.
+ *
+ ******************************************************************************/
+
+/**
+ * @file TableAssembler.h
+ *
+ * @brief Module for assembling PSI tables from more sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef TABLEASSEMBLER_H
+#define TABLEASSEMBLER_H
+
+#include <bitset>
+#include <map>
+#include <vector>
+
+#include "ServiceInformationTable.h"
+
+using namespace std;
+
+/**
+ * Assembles tables from their sections. Every sub-table (table ID and its extension)
+ * keeps the sections of its current version, each section is stored only once.
+ * Table is complete when all sections up to the last section number are present,
+ * sections of EIT are counted by the segments of the schedule. Assembler which does not
+ * store the sections only tracks the completeness of the sub-tables.
+ */
+class TableAssembler {
+public:
+    enum Result {
+        SECTION_IGNORED,        // section is not applicable or it is already stored
+        SECTION_STORED,         // new section, table is not complete yet
+        TABLE_COMPLETE          // section completed the table
+    };
+
+    const static unsigned int MAX_SECTIONS          = 256;
+
+    explicit TableAssembler(bool storeSections = true);
+
+    Result put(const ServiceInformationTable &section);
+    void clear();
+
+    vector<ServiceInformationTable> sections(uint8_t tableID, uint16_t tableIDExtension) const;
+    vector<ServiceInformationTable> firstSections(uint8_t tableID) const;
+    bool isComplete(uint8_t tableID, uint16_t tableIDExtension) const;
+    bool allComplete() const;
+    size_t tablesCount() const;
+
+protected:
+    /**
+     * Sections of one version of the sub-table.
+     */
+    struct SubTable {
+        uint8_t versionNumber;
+        uint8_t lastSectionNumber;
+        bool segmented;
+        bool complete;
+        bitset<MAX_SECTIONS> received;
+        uint8_t segmentLastSection[MAX_SECTIONS / 8];
+        map<uint8_t, ServiceInformationTable> sections;      // empty if sections are not stored
+    };
+
+    bool storeSections;
+    map<uint32_t, SubTable> tables;
+
+    static uint32_t tableKey(uint8_t tableID, uint16_t tableIDExtension);
+    static bool isSegmented(uint8_t tableID);
+    static bool isComplete(const SubTable &table);
+    static vector<ServiceInformationTable> orderedSections(const SubTable &table);
+};
+
+#endif // TABLEASSEMBLER_H
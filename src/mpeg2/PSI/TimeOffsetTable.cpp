@@ -44,13 +44,13 @@ TimeOffsetTable::TimeOffsetTable(ServiceInformationTable &table)
 
     /* Read TOT header */
 
-    timeUTC = DateTime::parseDateTime(table.section);
+    timestampUTC = DateTime::parseDateTime(&table.section[0]);
+    timeUTC = DateTime::toDateTime(timestampUTC);
 
     /* Read TOT descriptors */
 
     if (table.section.size() > TOT_HEADER_SIZE) {
-        vector<uint8_t> descriptorsData(&table.section[TOT_HEADER_SIZE], &table.section[table.section.size()]);
-        DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(descriptorsData);
+        DescriptorLoop descriptorLoop = DescriptorFactory::readDescriptorLoop(&table.section[TOT_HEADER_SIZE], table.section.size() - TOT_HEADER_SIZE);
         descriptors = descriptorLoop.descriptors;
     }
 }
@@ -38,8 +38,8 @@ class TimeOffsetTable
 {
 protected:
     const uint16_t static TOT_HEADER_SIZE   = 5;
-    const uint8_t static TOT_TABLE_ID       = 0x73;
 public:
+    const uint8_t static TOT_TABLE_ID       = 0x73;
     TimeOffsetTable() {}
     TimeOffsetTable(ServiceInformationTable &table);
 
@@ -48,6 +48,7 @@ public:
     const uint16_t static TOT_PID           = 0x0014;
 
     struct tm timeUTC;
+    int64_t timestampUTC;       // seconds since 1970
     Descriptors descriptors;
 };
 
@@ -0,0 +1,459 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MP2Decoder.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s dekodérem zvuku MPEG-1 Layer II.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MP2Decoder.cpp
+ *
+ * @brief Module with the decoder of the MPEG-1 Layer II audio.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include <cstring>
+#include <cmath>
+
+#include "MP2Decoder.h"
+
+using namespace std;
+
+/**
+ * Bitrates of the Layer II in kbps for MPEG-1 and MPEG-2 LSF, index 0 is free format.
+ */
+static const unsigned int BITRATES[2][15] = {
+    { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+    { 0,  8, 16, 24, 32, 40, 48,  56,  64,  80,  96, 112, 128, 144, 160 }
+};
+
+/**
+ * Sampling frequencies for MPEG-1 and MPEG-2 LSF.
+ */
+static const unsigned int SAMPLE_RATES[2][3] = {
+    { 44100, 48000, 32000 },
+    { 22050, 24000, 16000 }
+};
+
+/**
+ * Class of the quantization (ISO 11172-3, Table 3-B.4).
+ */
+struct QuantizationClass {
+    unsigned int levels;
+    unsigned int bits;          // bits of the codeword, grouped codeword holds three samples
+    bool grouped;
+};
+
+static const QuantizationClass QUANTIZATION_CLASSES[17] = {
+    { 3, 5, true }, { 5, 7, true }, { 7, 3, false }, { 9, 10, true },
+    { 15, 4, false }, { 31, 5, false }, { 63, 6, false }, { 127, 7, false },
+    { 255, 8, false }, { 511, 9, false }, { 1023, 10, false }, { 2047, 11, false },
+    { 4095, 12, false }, { 8191, 13, false }, { 16383, 14, false }, { 32767, 15, false },
+    { 65535, 16, false }
+};
+
+/**
+ * Classes of the quantization selected by the allocation values 1, 2, ... of the subband.
+ */
+struct AllocationRow {
+    unsigned int bits;
+    unsigned char classes[15];
+};
+
+static const AllocationRow ROW_A0 = { 4, { 0, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 } };
+static const AllocationRow ROW_A1 = { 4, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16 } };
+static const AllocationRow ROW_A2 = { 3, { 0, 1, 2, 3, 4, 5, 16 } };
+static const AllocationRow ROW_A3 = { 2, { 0, 1, 16 } };
+static const AllocationRow ROW_C0 = { 4, { 0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 } };
+static const AllocationRow ROW_C1 = { 3, { 0, 1, 3, 4, 5, 6, 7 } };
+static const AllocationRow ROW_L0 = { 4, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 } };
+static const AllocationRow ROW_L2 = { 2, { 0, 1, 3 } };
+
+/**
+ * Table of the bit allocation (ISO 11172-3, Table 3-B.2 and ISO 13818-3, Table B.1).
+ */
+struct AllocationTable {
+    unsigned int sblimit;
+    const AllocationRow *rows[30];
+};
+
+#define ROWS_3(row) &row, &row, &row
+#define ROWS_4(row) &row, &row, &row, &row
+#define ROWS_8(row) ROWS_4(row), ROWS_4(row)
+
+static const AllocationTable TABLE_A = { 27, {
+    ROWS_3(ROW_A0), ROWS_8(ROW_A1), ROWS_8(ROW_A2), ROWS_4(ROW_A2), ROWS_4(ROW_A3)
+} };
+static const AllocationTable TABLE_B = { 30, {
+    ROWS_3(ROW_A0), ROWS_8(ROW_A1), ROWS_8(ROW_A2), ROWS_4(ROW_A2), ROWS_4(ROW_A3), ROWS_3(ROW_A3)
+} };
+static const AllocationTable TABLE_C = { 8, {
+    &ROW_C0, &ROW_C0, ROWS_4(ROW_C1), &ROW_C1, &ROW_C1
+} };
+static const AllocationTable TABLE_D = { 12, {
+    &ROW_C0, &ROW_C0, ROWS_8(ROW_C1), &ROW_C1, &ROW_C1
+} };
+static const AllocationTable TABLE_LSF = { 30, {
+    ROWS_4(ROW_L0), ROWS_4(ROW_C1), ROWS_3(ROW_C1), ROWS_8(ROW_L2), ROWS_8(ROW_L2), ROWS_3(ROW_L2)
+} };
+
+/**
+ * Selects the table of the bit allocation for the frame.
+ * @param header Header of the frame.
+ * @return Table of the bit allocation.
+ */
+static const AllocationTable &allocationTable(const MP2FrameHeader &header) {
+    if (header.lsf) {
+        return TABLE_LSF;
+    }
+
+    unsigned int channelBitrate = header.bitrate / header.channels / 1000;
+    if (channelBitrate <= 48) {
+        return (header.sampleRate == 32000)? TABLE_D : TABLE_C;
+    } else if (channelBitrate <= 80) {
+        return TABLE_A;
+    }
+    return (header.sampleRate == 48000)? TABLE_A : TABLE_B;
+}
+
+/**
+ * Scale factors, 2^(1 - index / 3).
+ */
+struct ScaleFactors {
+    ScaleFactors() {
+        for (unsigned int i = 0; i < 63; i++) {
+            values[i] = pow(2.0, 1.0 - i / 3.0);
+        }
+        values[63] = 0;
+    }
+
+    float values[64];
+};
+
+static const ScaleFactors SCALE_FACTORS;
+
+/**
+ * Reader of the bits of the frame, bits behind the frame are read as zeros.
+ */
+class BitReader {
+public:
+    BitReader(const uint8_t *data, size_t size) : data(data), bitsCount(size * 8), bitPos(0) {}
+
+    unsigned int read(unsigned int bits) {
+        unsigned int value = 0;
+        for (unsigned int i = 0; i < bits; i++, bitPos++) {
+            value <<= 1;
+            if (bitPos < bitsCount) {
+                value |= (data[bitPos >> 3] >> (7 - (bitPos & 7))) & 1;
+            }
+        }
+        return value;
+    }
+
+private:
+    const uint8_t *data;
+    size_t bitsCount;
+    size_t bitPos;
+};
+
+/**
+ * Constructs decoder without any data.
+ */
+MP2Decoder::MP2Decoder() : bufferPos(0), headerValid(false), skipped(0), frames(0) {}
+
+/**
+ * Parses header of the Layer II frame.
+ * @param data At least 4 bytes of the frame.
+ * @param header Parsed header.
+ * @return True if header is valid Layer II header, otherwise false.
+ */
+bool MP2Decoder::parseHeader(const uint8_t *data, MP2FrameHeader &header) {
+    /* Sync word, MPEG-1 or MPEG-2 and the Layer II */
+    if (data[0] != 0xFF || (data[1] & 0xF0) != 0xF0 || ((data[1] >> 1) & 0x03) != 0x02) {
+        return false;
+    }
+
+    unsigned int bitrateIndex = data[2] >> 4;
+    unsigned int sampleRateIndex = (data[2] >> 2) & 0x03;
+    if (bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3 || (data[3] & 0x03) == 0x02) {
+        return false;
+    }
+
+    header.lsf = (data[1] & 0x08) == 0;
+    header.protection = (data[1] & 0x01) == 0;
+    header.padding = (data[2] & 0x02) != 0;
+    header.bitrateIndex = bitrateIndex;
+    header.bitrate = BITRATES[header.lsf][bitrateIndex] * 1000;
+    header.sampleRate = SAMPLE_RATES[header.lsf][sampleRateIndex];
+    header.mode = static_cast<MP2FrameHeader::Mode>(data[3] >> 6);
+    header.modeExtension = (data[3] >> 4) & 0x03;
+    header.channels = (header.mode == MP2FrameHeader::MONO)? 1 : 2;
+    header.frameSize = 144 * header.bitrate / header.sampleRate + (header.padding? 1 : 0);
+
+    return true;
+}
+
+/**
+ * Appends data of the elementary stream.
+ * @param data Audio data.
+ * @param size Size of the data.
+ */
+void MP2Decoder::put(const uint8_t *data, size_t size) {
+    compact();
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+/**
+ * Removes decoded data from the buffer.
+ */
+void MP2Decoder::compact() {
+    if (bufferPos > 0 && bufferPos * 2 >= buffer.size()) {
+        buffer.erase(buffer.begin(), buffer.begin() + bufferPos);
+        bufferPos = 0;
+    }
+}
+
+/**
+ * Decodes next frame from the data put so far. Frame is decoded when the header
+ * of the following frame confirms it, so false sync words in the data are skipped.
+ * @param pcm Buffer for SAMPLES_PER_FRAME * MAX_CHANNELS interleaved samples.
+ * @param final True if no more data will be put, the last frame is decoded without confirmation.
+ * @return Number of the samples per channel, 0 if there is no complete frame.
+ */
+unsigned int MP2Decoder::decode(int16_t *pcm, bool final) {
+    while (buffer.size() - bufferPos >= HEADER_SIZE) {
+        const uint8_t *data = &buffer[bufferPos];
+        size_t available = buffer.size() - bufferPos;
+
+        MP2FrameHeader frameHeader;
+        if (!parseHeader(data, frameHeader)) {
+            const void *next = memchr(data + 1, 0xFF, available - 1);
+            size_t skip = next? static_cast<const uint8_t *>(next) - data : available;
+            skipped += skip;
+            bufferPos += skip;
+            continue;
+        }
+
+        if (available < frameHeader.frameSize + (final? 0 : HEADER_SIZE)) {
+            if (!final) {
+                return 0;
+            }
+            // Incomplete frame at the end of the stream
+            skipped += available;
+            bufferPos = buffer.size();
+            return 0;
+        }
+
+        /* Header of the next frame must have the same format */
+        if (available >= frameHeader.frameSize + HEADER_SIZE) {
+            MP2FrameHeader nextHeader;
+            if (!parseHeader(data + frameHeader.frameSize, nextHeader) || nextHeader.lsf != frameHeader.lsf ||
+                    nextHeader.sampleRate != frameHeader.sampleRate) {
+                skipped++;
+                bufferPos++;
+                continue;
+            }
+        }
+
+        bufferPos += frameHeader.frameSize;
+        if (!decodeFrame(data, frameHeader, pcm)) {
+            skipped += frameHeader.frameSize;
+            continue;
+        }
+
+        header = frameHeader;
+        headerValid = true;
+        frames++;
+        return SAMPLES_PER_FRAME;
+    }
+
+    return 0;
+}
+
+/**
+ * Decodes one frame (ISO 11172-3, 2.4.3.3).
+ * @param frame Data of the frame.
+ * @param header Header of the frame.
+ * @param pcm Interleaved output samples.
+ * @return True on success, otherwise false.
+ */
+bool MP2Decoder::decodeFrame(const uint8_t *frame, const MP2FrameHeader &header, int16_t *pcm) {
+    const AllocationTable &table = allocationTable(header);
+    const unsigned int channels = header.channels;
+    const unsigned int sblimit = table.sblimit;
+
+    unsigned int bound = sblimit;
+    if (header.mode == MP2FrameHeader::JOINT_STEREO) {
+        bound = min(sblimit, (header.modeExtension + 1) * 4);
+    }
+
+    BitReader reader(frame, header.frameSize);
+    reader.read(HEADER_SIZE * 8);
+    if (header.protection) {
+        reader.read(16);
+    }
+
+    /* Bit allocation */
+    const QuantizationClass *allocation[MAX_CHANNELS][SUBBANDS] = {};
+    for (unsigned int sb = 0; sb < sblimit; sb++) {
+        const AllocationRow &row = *table.rows[sb];
+        for (unsigned int ch = 0; ch < ((sb < bound)? channels : 1); ch++) {
+            unsigned int value = reader.read(row.bits);
+            allocation[ch][sb] = (value > 0)? &QUANTIZATION_CLASSES[row.classes[value - 1]] : 0;
+        }
+        if (sb >= bound && channels == 2) {
+            allocation[1][sb] = allocation[0][sb];
+        }
+    }
+
+    /* Scale factor selection information */
+    unsigned int scfsi[MAX_CHANNELS][SUBBANDS] = {};
+    for (unsigned int sb = 0; sb < sblimit; sb++) {
+        for (unsigned int ch = 0; ch < channels; ch++) {
+            if (allocation[ch][sb]) {
+                scfsi[ch][sb] = reader.read(2);
+            }
+        }
+    }
+
+    /* Scale factors of three parts of the frame */
+    float scaleFactors[MAX_CHANNELS][SUBBANDS][3] = {};
+    for (unsigned int sb = 0; sb < sblimit; sb++) {
+        for (unsigned int ch = 0; ch < channels; ch++) {
+            if (!allocation[ch][sb]) {
+                continue;
+            }
+
+            unsigned int index[3];
+            switch (scfsi[ch][sb]) {
+            case 0:
+                index[0] = reader.read(6);
+                index[1] = reader.read(6);
+                index[2] = reader.read(6);
+                break;
+            case 1:
+                index[0] = index[1] = reader.read(6);
+                index[2] = reader.read(6);
+                break;
+            case 2:
+                index[0] = index[1] = index[2] = reader.read(6);
+                break;
+            default:
+                index[0] = reader.read(6);
+                index[1] = index[2] = reader.read(6);
+                break;
+            }
+
+            for (unsigned int part = 0; part < 3; part++) {
+                scaleFactors[ch][sb][part] = SCALE_FACTORS.values[index[part]];
+            }
+        }
+    }
+
+    /* Samples, every granule has three samples of each subband */
+    alignas(16) float samples[MAX_CHANNELS][3][SUBBANDS];
+    float output[SUBBANDS];
+
+    for (unsigned int gr = 0; gr < GRANULES; gr++) {
+        unsigned int part = gr / 4;
+        memset(samples, 0, sizeof(samples));
+
+        for (unsigned int sb = 0; sb < sblimit; sb++) {
+            for (unsigned int ch = 0; ch < ((sb < bound)? channels : 1); ch++) {
+                const QuantizationClass *quantization = allocation[ch][sb];
+                if (!quantization) {
+                    continue;
+                }
+
+                /* Read three codes, grouped codes share one codeword */
+                unsigned int codes[3];
+                if (quantization->grouped) {
+                    unsigned int codeword = reader.read(quantization->bits);
+                    for (unsigned int s = 0; s < 3; s++) {
+                        codes[s] = codeword % quantization->levels;
+                        codeword /= quantization->levels;
+                    }
+                } else {
+                    for (unsigned int s = 0; s < 3; s++) {
+                        codes[s] = reader.read(quantization->bits);
+                    }
+                }
+
+                /* Requantization, (2 * code + 1 - levels) / levels */
+                for (unsigned int s = 0; s < 3; s++) {
+                    float fraction = float(2 * (int)codes[s] + 1 - (int)quantization->levels) / quantization->levels;
+                    samples[ch][s][sb] = fraction * scaleFactors[ch][sb][part];
+
+                    // Intensity stereo, both channels share the samples with own scale factors
+                    if (sb >= bound && channels == 2) {
+                        samples[1][s][sb] = fraction * scaleFactors[1][sb][part];
+                    }
+                }
+            }
+        }
+
+        /* Synthesis of 96 samples of each channel */
+        for (unsigned int ch = 0; ch < channels; ch++) {
+            for (unsigned int s = 0; s < 3; s++) {
+                synthesis[ch].synthesize(samples[ch][s], output);
+
+                int16_t *out = pcm + ((gr * 3 + s) * SUBBANDS) * channels + ch;
+                for (unsigned int j = 0; j < SUBBANDS; j++) {
+                    float value = output[j] * 32768.0f;
+                    value = max(-32768.0f, min(32767.0f, value));
+                    out[j * channels] = (int16_t)lrintf(value);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clears buffered data and history of the filterbanks.
+ */
+void MP2Decoder::reset() {
+    buffer.clear();
+    bufferPos = 0;
+    headerValid = false;
+    for (unsigned int ch = 0; ch < MAX_CHANNELS; ch++) {
+        synthesis[ch].reset();
+    }
+}
+
+/**
+ * @return Number of the channels of the last decoded frame, 0 if no frame has been decoded.
+ */
+unsigned int MP2Decoder::channels() const {
+    return headerValid? header.channels : 0;
+}
+
+/**
+ * @return Sampling frequency of the last decoded frame, 0 if no frame has been decoded.
+ */
+unsigned int MP2Decoder::sampleRate() const {
+    return headerValid? header.sampleRate : 0;
+}
+
+/**
+ * @return Number of the bytes which were not part of any decoded frame.
+ */
+unsigned long long MP2Decoder::skippedBytes() const {
+    return skipped;
+}
+
+/**
+ * @return Number of the decoded frames.
+ */
+unsigned long MP2Decoder::framesCount() const {
+    return frames;
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MP2Decoder.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s dekodérem zvuku MPEG-1 Layer II.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MP2Decoder.h
+ *
+ * @brief Module with the decoder of the MPEG-1 Layer II audio.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MP2DECODER_H
+#define MP2DECODER_H
+
+#include <vector>
+
+#include <cstdint>
+#include <cstddef>
+
+#include "PolyphaseSynthesis.h"
+
+using namespace std;
+
+/**
+ * Header of the audio frame.
+ */
+struct MP2FrameHeader {
+    enum Mode {
+        STEREO          = 0,
+        JOINT_STEREO    = 1,
+        DUAL_CHANNEL    = 2,
+        MONO            = 3
+    };
+
+    bool lsf;                   // MPEG-2 lower sampling frequencies
+    bool protection;            // frame contains CRC
+    bool padding;
+    unsigned int bitrateIndex;
+    unsigned int bitrate;       // bits per second
+    unsigned int sampleRate;    // Hz
+    Mode mode;
+    unsigned int modeExtension;
+    unsigned int channels;
+    unsigned int frameSize;     // bytes including header
+};
+
+/**
+ * Decoder of the MPEG-1 and MPEG-2 LSF Layer II audio. Data are put into
+ * the decoder as they are recieved, decoder finds the frames in them
+ * and decodes them one by one into 16-bit interleaved PCM samples.
+ */
+class MP2Decoder {
+public:
+    const static unsigned int HEADER_SIZE       = 4;
+    const static unsigned int SAMPLES_PER_FRAME = 1152;
+    const static unsigned int MAX_CHANNELS      = 2;
+    const static unsigned int MAX_FRAME_SIZE    = 1729;
+
+    MP2Decoder();
+
+    static bool parseHeader(const uint8_t *data, MP2FrameHeader &header);
+
+    void put(const uint8_t *data, size_t size);
+    unsigned int decode(int16_t *pcm, bool final = false);
+    void reset();
+
+    unsigned int channels() const;
+    unsigned int sampleRate() const;
+    unsigned long long skippedBytes() const;
+    unsigned long framesCount() const;
+
+protected:
+    const static unsigned int SUBBANDS          = 32;
+    const static unsigned int GRANULES          = 12;
+
+    vector<uint8_t> buffer;
+    size_t bufferPos;
+    MP2FrameHeader header;
+    bool headerValid;
+    unsigned long long skipped;
+    unsigned long frames;
+    PolyphaseSynthesis synthesis[MAX_CHANNELS];
+
+    bool decodeFrame(const uint8_t *frame, const MP2FrameHeader &header, int16_t *pcm);
+    void compact();
+};
+
+#endif // MP2DECODER_H
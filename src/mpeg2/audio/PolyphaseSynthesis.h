@@ -0,0 +1,47 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          PolyphaseSynthesis.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul se syntézní bankou filtrů MPEG audia.
+ *
+ ******************************************************************************/
+
+/**
+ * @file PolyphaseSynthesis.h
+ *
+ * @brief Module with the synthesis filterbank of the MPEG audio.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef POLYPHASESYNTHESIS_H
+#define POLYPHASESYNTHESIS_H
+
+using namespace std;
+
+/**
+ * Polyphase synthesis filterbank of the MPEG audio (ISO 11172-3, 2.4.3.2.2).
+ * It transforms 32 subband samples into 32 PCM samples of one channel.
+ * Matrixing and windowing are vectorized with SSE when it is available.
+ */
+class PolyphaseSynthesis {
+public:
+    const static unsigned int SUBBANDS      = 32;
+    const static unsigned int WINDOW_SIZE   = 512;
+    const static unsigned int BUFFER_SIZE   = 1024;
+
+    PolyphaseSynthesis();
+
+    void reset();
+    void synthesize(const float *subbandSamples, float *pcm);
+
+protected:
+    alignas(16) float V[BUFFER_SIZE];
+    unsigned int offset;
+};
+
+#endif // POLYPHASESYNTHESIS_H
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          WaveFileWriter.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro průběžný zápis zvuku do souboru .wav.
+ *
+ ******************************************************************************/
+
+/**
+ * @file WaveFileWriter.cpp
+ *
+ * @brief Module for the continuous writing of the audio into .wav file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+
+#include "WaveFileWriter.h"
+
+using namespace std;
+
+/**
+ * Constructs writer which is not opened yet.
+ */
+WaveFileWriter::WaveFileWriter()
+    : channels(0), sampleRate(0), bitsPerSample(0), dataBytes(0) {}
+
+/**
+ * Completes the file if it is still opened.
+ */
+WaveFileWriter::~WaveFileWriter() {
+    close();
+}
+
+/**
+ * Stores value in the little endian order.
+ * @param dest Destination of the value.
+ * @param value Value to be stored.
+ * @param bytes Number of the bytes of the value.
+ */
+void WaveFileWriter::putLittleEndian(uint8_t *dest, uint32_t value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; i++) {
+        dest[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+/**
+ * Writes RIFF header at the beginning of the file.
+ * @param dataSize Size of the PCM data.
+ */
+void WaveFileWriter::writeHeader(uint32_t dataSize) {
+    uint8_t header[HEADER_SIZE];
+    unsigned int blockAlign = channels * bitsPerSample / 8;
+
+    copy_n("RIFF", 4, header);
+    putLittleEndian(header + 4, (dataSize > 0xFFFFFFFF - 36)? 0xFFFFFFFF : dataSize + 36, 4);
+    copy_n("WAVEfmt ", 8, header + 8);
+    putLittleEndian(header + 16, 16, 4);                            // size of the format chunk
+    putLittleEndian(header + 20, 1, 2);                             // PCM
+    putLittleEndian(header + 22, channels, 2);
+    putLittleEndian(header + 24, sampleRate, 4);
+    putLittleEndian(header + 28, sampleRate * blockAlign, 4);
+    putLittleEndian(header + 32, blockAlign, 2);
+    putLittleEndian(header + 34, bitsPerSample, 2);
+    copy_n("data", 4, header + 36);
+    putLittleEndian(header + 40, dataSize, 4);
+
+    output.write((const char *)header, HEADER_SIZE);
+}
+
+/**
+ * Opens the file and writes its header.
+ * @param filename Name of the .wav file.
+ * @param channels Number of the channels.
+ * @param sampleRate Sample rate in Hz.
+ * @param bitsPerSample Bits of one sample, 8 or 16.
+ * @return True on success, otherwise false.
+ */
+bool WaveFileWriter::open(const string &filename, unsigned int channels, unsigned int sampleRate, unsigned int bitsPerSample) {
+    close();
+
+    output.open(filename, ios::out | ios::binary | ios::trunc);
+    if (!output) {
+        return false;
+    }
+
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+    this->bitsPerSample = bitsPerSample;
+    dataBytes = 0;
+
+    writeHeader(0);
+    return output.good();
+}
+
+/**
+ * Appends samples into the file, samples are in the native byte order.
+ * @param samples Interleaved samples.
+ * @param size Size of the samples in bytes.
+ */
+void WaveFileWriter::write(const void *samples, size_t size) {
+    if (!output.is_open()) {
+        return;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if (bitsPerSample == 16) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(samples);
+        uint8_t swapped[4096];
+        for (size_t done = 0; done < size; ) {
+            size_t chunk = min(size - done, sizeof(swapped)) & ~(size_t)1;
+            if (chunk == 0) {
+                break;
+            }
+            for (size_t i = 0; i < chunk; i += 2) {
+                swapped[i] = bytes[done + i + 1];
+                swapped[i + 1] = bytes[done + i];
+            }
+            output.write((const char *)swapped, chunk);
+            done += chunk;
+        }
+        dataBytes += size;
+        return;
+    }
+#endif
+
+    output.write(static_cast<const char *>(samples), size);
+    dataBytes += size;
+}
+
+/**
+ * Completes sizes in the header and closes the file.
+ * @return True if file has been written successfully, otherwise false.
+ */
+bool WaveFileWriter::close() {
+    if (!output.is_open()) {
+        return false;
+    }
+
+    output.seekp(0, ios::beg);
+    writeHeader((dataBytes > 0xFFFFFFFF)? 0xFFFFFFFF : dataBytes);
+
+    bool good = output.good();
+    output.close();
+    return good;
+}
+
+/**
+ * @return True if the file is opened.
+ */
+bool WaveFileWriter::isOpen() const {
+    return output.is_open();
+}
+
+/**
+ * @return Number of the channels of the opened file.
+ */
+unsigned int WaveFileWriter::channelsCount() const {
+    return channels;
+}
+
+/**
+ * @return Sample rate of the opened file in Hz.
+ */
+unsigned int WaveFileWriter::samplesPerSecond() const {
+    return sampleRate;
+}
+
+/**
+ * @return Size of the PCM data written so far.
+ */
+unsigned long long WaveFileWriter::dataSize() const {
+    return dataBytes;
+}
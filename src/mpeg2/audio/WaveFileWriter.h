@@ -0,0 +1,66 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          WaveFileWriter.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro průběžný zápis zvuku do souboru .wav.
+ *
+ ******************************************************************************/
+
+/**
+ * @file WaveFileWriter.h
+ *
+ * @brief Module for the continuous writing of the audio into .wav file.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef WAVEFILEWRITER_H
+#define WAVEFILEWRITER_H
+
+#include <string>
+#include <fstream>
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Writes PCM samples into .wav file as they are decoded. Header is written
+ * when the file is opened and its sizes are completed when the file is closed.
+ */
+class WaveFileWriter {
+public:
+    const static unsigned int HEADER_SIZE       = 44;
+
+    WaveFileWriter();
+    ~WaveFileWriter();
+
+    WaveFileWriter(const WaveFileWriter &) = delete;
+    WaveFileWriter &operator=(const WaveFileWriter &) = delete;
+
+    bool open(const string &filename, unsigned int channels, unsigned int sampleRate, unsigned int bitsPerSample);
+    void write(const void *samples, size_t size);
+    bool close();
+
+    bool isOpen() const;
+    unsigned int channelsCount() const;
+    unsigned int samplesPerSecond() const;
+    unsigned long long dataSize() const;
+
+protected:
+    ofstream output;
+    unsigned int channels;
+    unsigned int sampleRate;
+    unsigned int bitsPerSample;
+    unsigned long long dataBytes;
+
+    void writeHeader(uint32_t dataSize);
+    static void putLittleEndian(uint8_t *dest, uint32_t value, unsigned int bytes);
+};
+
+#endif // WAVEFILEWRITER_H
@@ -18,159 +18,75 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
-#include <algorithm>
-
-#include <bass.h>
+#include <iostream>
+#include <sstream>
 
 #include "MPEG2AudioFileStream.h"
 
 /**
- * Initialization variable
- */
-bool MPEG2AudioFileStream::bass_initialized = false;
-
-#ifdef _BIG_ENDIAN
-inline DWORD le_32(DWORD v)
-{
-    return (v>>24)|((v>>8)&0xff00)|((v&0xff00)<<8)|(v<<24);
-}
-inline WORD le_16(WORD v)
-{
-    return (v>>8)|(v<<8);
-}
-#else
-#define le_32(v) (v)
-#define le_16(v) (v)
-#endif
-
-/**
- * Writes vector of data into .wav file
- *
- * @param filename Name of the file where to put audio data
- * @param data Audio data vector.
+ * Decodes all complete frames and appends their samples into .wav file.
+ * File is opened with the format of the first frame, frames with other format are dropped.
+ * Frames are dropped also when the file cannot be created, the failure is reported once.
+ * @param final True if no more data will come.
  */
-void MPEG2AudioFileStream::writeWaw(string filename, vector<uint8_t> &data) {
-    BASS_CHANNELINFO info;
-    DWORD p;
-    FILE *fp;
-    short buf[10000];
-    WAVEFORMATEX wf;
-
-    bool bass_wasInitialized = bass_initialized;
-    bass_initialized = (!bass_initialized)? BASS_Init(-1 ,44100, 0, 0, NULL) : true;
+void MPEG2AudioFileStream::decodeFrames(bool final) {
+    int16_t pcm[MP2Decoder::SAMPLES_PER_FRAME * MP2Decoder::MAX_CHANNELS];
 
-    /* Open stream for reading from the buffer. */
-    HSTREAM chan = BASS_StreamCreateFile(TRUE, &data[0], 0, data.size(), BASS_STREAM_DECODE);
-
-    if (chan == 0) {
-        goto writeWawReturn;
-    }
-
-    /* Open file for writing audio data. */
-
-    if (!(fp = fopen(filename.c_str(), "wb"))) {
-        goto writeWawReturn;
-    }
+    while (unsigned int samples = decoder.decode(pcm, final)) {
+        if (waveFailed) {
+            droppedFrames++;
+            continue;
+        }
 
-    /* Write WAV header */
-    BASS_ChannelGetInfo(chan,&info);
-
-    wf.wFormatTag = 1;
-    wf.nChannels = info.chans;
-    wf.wBitsPerSample = (info.flags&BASS_SAMPLE_8BITS?8:16);
-    wf.nBlockAlign = wf.nChannels * wf.wBitsPerSample / 8;
-    wf.nSamplesPerSec = info.freq;
-    wf.nAvgBytesPerSec = wf.nSamplesPerSec * wf.nBlockAlign;
-
-#ifdef _BIG_ENDIAN // swap byte order
-    wf.wFormatTag = le_16(wf.wFormatTag);
-    wf.nChannels = le_16(wf.nChannels);
-    wf.wBitsPerSample = le_16(wf.wBitsPerSample);
-    wf.nBlockAlign = le_16(wf.nBlockAlign);
-    wf.nSamplesPerSec = le_32(wf.nSamplesPerSec);
-    wf.nAvgBytesPerSec = le_32(wf.nAvgBytesPerSec);
-#endif
-    fwrite("RIFF\0\0\0\0WAVEfmt \20\0\0\0", 20, 1, fp);
-    fwrite(&wf, 16, 1, fp);
-    fwrite("data\0\0\0\0", 8, 1, fp);
-
-    /* Write .wav audio data */
-
-    while (BASS_ChannelIsActive(chan)) {
-        int c = BASS_ChannelGetData(chan, buf, 20000);
-#ifdef _BIG_ENDIAN
-        if (!(info.flags&BASS_SAMPLE_8BITS)) // swap 16-bit byte order
-            for (p=0; p < c / 2; p++) buf[p] = le_16(buf[p]);
-#endif
-        fwrite(buf,1,c,fp);
-    }
+        if (!wave.isOpen()) {
+            if (!wave.open(filename, decoder.channels(), decoder.sampleRate(), BITS_PER_SAMPLE)) {
+                // Streams are processed by the worker threads, so the message is written at once
+                ostringstream message;
+                message << "Unable to create file \"" << filename << "\" for writing audio!" << endl;
+                cerr << message.str();
+
+                waveFailed = true;
+                droppedFrames++;
+                continue;
+            }
+        } else if (wave.channelsCount() != decoder.channels() || wave.samplesPerSecond() != decoder.sampleRate()) {
+            droppedFrames++;
+            continue;
+        }
 
-    /* Complete WAV header */
-    fflush(fp);
-    p = ftell(fp);
-    fseek(fp, 4, SEEK_SET);
-    putw(le_32(p-8), fp);
-    fflush(fp);
-    fseek(fp, 40, SEEK_SET);
-    putw(le_32(p - 44), fp);
-    fflush(fp);
-    fclose(fp);
-
-    BASS_StreamFree(chan);
-
-writeWawReturn:
-    if (!bass_wasInitialized && bass_initialized) {
-        BASS_Free();
-        bass_initialized = false;
+        wave.write(pcm, samples * decoder.channels() * sizeof(int16_t));
     }
 }
 
-/**
- * Callback method which is called if new chunk of audio is available
- * @param packetStream Audio elementary stream
- */
-void MPEG2AudioFileStream::onPacketRecieved(const PacketElementaryStream &) {
-}
-
 /**
  * Callback method that is called by service base class - delivers recieved fragment.
- * Appending of the data into file is done here.
+ * Decoding of the audio into file is done here.
  * @param streamFragment PES fragment.
  */
 void MPEG2AudioFileStream::onFragmentRecieved(const PacketElementaryStreamFragment &streamFragment) {
-    /*if (!audioHaderFound) {
-        auto it = search(streamFragment.streamData.begin(), streamFragment.streamData.end(), PacketElementaryStream::PES_DATA_HEADER_PREFIX.begin(), PacketElementaryStream::PES_DATA_HEADER_PREFIX.end());
-        auto itCopy = it;
-
-        audioHaderFound = itCopy != streamFragment.streamData.end();
-        audioHaderFound = (audioHaderFound)? itCopy + PacketElementaryStream::PES_DATA_HEADER_PREFIX.size() + 1 != streamFragment.streamData.end() : false;
-
-        if (audioHaderFound) {
-            vector<uint8_t> data(it, streamFragment.streamData.end());
-            write(data);
-        }
-    } else {
-        write(streamFragment.streamData);
-    }*/
-    write(streamFragment.streamData);
+    write(streamFragment.data, streamFragment.size);
 }
 
 /**
- * Writes audio data to file.
- * @param streamData Data to be written into the file
+ * Decodes audio data into the file.
+ * @param data Data to be written into the file
+ * @param size Size of the data.
  */
-void MPEG2AudioFileStream::write(const vector<uint8_t> &streamData) {
-    if (!streamData.empty()) {
-        data.resize(data.size() + streamData.size());
-        copy(streamData.begin(), streamData.end(), &data[data.size() - streamData.size()]);
+void MPEG2AudioFileStream::write(const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return;
     }
+
+    decoder.put(data, size);
+    decodeFrames(false);
 }
 
 /**
  * Constructs audio file output stream
  * @param PID PID which identifies the service stream of the audio
  */
-MPEG2AudioFileStream::MPEG2AudioFileStream(uint16_t PID) : MPEG2ServiceStream(PID), audioHaderFound(false) {
+MPEG2AudioFileStream::MPEG2AudioFileStream(uint16_t PID) : MPEG2ServiceStream(PID),
+    waveFailed(false), droppedFrames(0) {
 
 }
 
@@ -183,18 +99,27 @@ void MPEG2AudioFileStream::open(string &filename) {
 }
 
 /**
- * Closes audio stream.
+ * Decodes the rest of the audio and completes the .wav file. Dropped frames are reported.
  */
 void MPEG2AudioFileStream::close() {
-    if (!data.empty()) {
-        writeWaw(filename, data);
+    MPEG2ServiceStream::close();
+    decodeFrames(true);
+    decoder.reset();
+
+    if (wave.isOpen() && !wave.close()) {
+        cerr << "Unable to complete file \"" << filename << "\" with audio!" << endl;
+        waveFailed = true;
+    }
+
+    if (droppedFrames > 0) {
+        cerr << droppedFrames << " audio frames were not written into file \"" << filename << "\"!" << endl;
     }
 }
 
 /**
  * Tests state of the audio stream.
- * @return True if stream is sucessufuly opened, otherwise false.
+ * @return True if the audio could not be written into the file, otherwise false.
  */
 bool MPEG2AudioFileStream::operator!(void) const {
-    return true;
+    return waveFailed;
 }
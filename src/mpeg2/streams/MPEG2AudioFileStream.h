@@ -22,22 +22,26 @@
 #define MPEG2AUDIOFILESTREAM_H
 
 #include "MPEG2ServiceStream.h"
+#include "../audio/MP2Decoder.h"
+#include "../audio/WaveFileWriter.h"
 
 /**
- * Class for saving audio packets into file.
+ * Class for saving audio packets into file. Audio is decoded continuously
+ * as the packets are recieved and PCM samples are appended into .wav file.
  */
 class MPEG2AudioFileStream : public MPEG2ServiceStream {
 protected:
-    static bool bass_initialized;
-    vector<uint8_t> data;
-    string filename;
-    bool audioHaderFound;
+    const static unsigned int BITS_PER_SAMPLE       = 16;
 
-    static void writeWaw(string filename, vector<uint8_t> &data);
+    string filename;
+    MP2Decoder decoder;
+    WaveFileWriter wave;
+    bool waveFailed;
+    unsigned long droppedFrames;        // frames which could not be written into the file
 
-    virtual void onPacketRecieved(const PacketElementaryStream &packetStream) override;
     virtual void onFragmentRecieved(const PacketElementaryStreamFragment &streamFragment) override;
-    void write(const vector<uint8_t> &streamData);
+    void write(const uint8_t *data, size_t size);
+    void decodeFrames(bool final);
 public:
     MPEG2AudioFileStream(uint16_t PID);
 
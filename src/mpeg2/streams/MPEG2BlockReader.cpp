@@ -0,0 +1,224 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2BlockReader.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro čtení souboru po velkých zarovnaných blocích.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2BlockReader.cpp
+ *
+ * @brief Module which reads the file in large aligned chunks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <stdexcept>
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+    #include <malloc.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include "MPEG2BlockReader.h"
+
+using namespace std;
+
+/**
+ * Constructs reader and allocates its buffer.
+ * @param chunkSize Demanded size of the chunk, it is rounded up to the multiple of CHUNK_UNIT.
+ * @param directIO True if the file should be read without the page cache (O_DIRECT), if supported.
+ */
+MPEG2BlockReader::MPEG2BlockReader(size_t chunkSize, bool directIO)
+    : fd(-1), directIO(directIO), endReached(false), buffer(0), bufferSize(0), dataStart(0), dataSize(0)
+{
+    bufferSize = ((chunkSize + CHUNK_UNIT - 1) / CHUNK_UNIT) * CHUNK_UNIT;
+    bufferSize = (bufferSize == 0)? CHUNK_UNIT : bufferSize;
+
+    void *memory = 0;
+#if defined(_WIN32)
+    memory = _aligned_malloc(CARRY_SIZE + bufferSize, BLOCK_ALIGNMENT);
+#else
+    if (posix_memalign(&memory, BLOCK_ALIGNMENT, CARRY_SIZE + bufferSize) != 0) {
+        memory = 0;
+    }
+#endif
+    if (!memory) {
+        throw runtime_error ("Unable to allocate buffer for reading the file!");
+    }
+    buffer = static_cast<uint8_t *>(memory);
+    dataStart = buffer + CARRY_SIZE;
+}
+
+/**
+ * Closes the file and frees the buffer.
+ */
+MPEG2BlockReader::~MPEG2BlockReader() {
+    close();
+#if defined(_WIN32)
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
+
+/**
+ * Opens the file for reading.
+ * @param filename Name of the file.
+ * @return True on success, otherwise false.
+ */
+bool MPEG2BlockReader::open(const string &filename) {
+    close();
+
+#if defined(_WIN32)
+    fd = ::_open(filename.c_str(), _O_RDONLY | _O_BINARY);
+    directIO = false;
+#else
+    #ifdef O_DIRECT
+    if (directIO) {
+        fd = ::open(filename.c_str(), O_RDONLY | O_DIRECT);
+    }
+    #else
+    directIO = false;
+    #endif
+
+    // File system does not support direct access, read it through the cache
+    if (fd < 0) {
+        directIO = false;
+        fd = ::open(filename.c_str(), O_RDONLY);
+    }
+#endif
+
+    return fd >= 0;
+}
+
+/**
+ * Closes the file.
+ */
+void MPEG2BlockReader::close() {
+    if (fd >= 0) {
+#if defined(_WIN32)
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+    fd = -1;
+    dataSize = 0;
+    endReached = false;
+}
+
+/**
+ * @return True if file is opened.
+ */
+bool MPEG2BlockReader::isOpen() const {
+    return fd >= 0;
+}
+
+/**
+ * Moves reading to the beginning of the file.
+ * @return True on success, otherwise false.
+ */
+bool MPEG2BlockReader::rewind() {
+    dataSize = 0;
+    endReached = false;
+#if defined(_WIN32)
+    return fd >= 0 && ::_lseek(fd, 0, SEEK_SET) == 0;
+#else
+    return fd >= 0 && ::lseek(fd, 0, SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * Reads demanded number of bytes, reading stops only at the end of the file.
+ * @param dest Destination buffer.
+ * @param size Number of bytes to be read.
+ * @return Number of bytes which were read.
+ */
+size_t MPEG2BlockReader::readFully(uint8_t *dest, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+#if defined(_WIN32)
+        int count = ::_read(fd, dest + total, size - total);
+#else
+        ssize_t count = ::read(fd, dest + total, size - total);
+#endif
+        if (count <= 0) {
+            break;
+        }
+        total += count;
+
+        // Short read with O_DIRECT is possible only at the end of the file
+        if (directIO && count % BLOCK_ALIGNMENT != 0) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * Reads next chunk of the file into the buffer.
+ * @param keepBytes Number of bytes from the end of the current chunk which are moved in front of the new chunk.
+ * @return Number of bytes in the buffer including the kept bytes, zero at the end of the file.
+ */
+size_t MPEG2BlockReader::readChunk(size_t keepBytes) {
+    if (keepBytes > CARRY_SIZE || keepBytes > dataSize) {
+        throw runtime_error ("Too many bytes to be kept from the previous chunk!");
+    }
+
+    uint8_t *readArea = buffer + CARRY_SIZE;
+    uint8_t *newStart = readArea - keepBytes;
+    memmove(newStart, dataStart + dataSize - keepBytes, keepBytes);
+    dataStart = newStart;
+    dataSize = keepBytes;
+
+    if (fd < 0 || endReached) {
+        endReached = true;
+        return dataSize;
+    }
+
+    size_t count = readFully(readArea, bufferSize);
+    endReached = count < bufferSize;
+    dataSize += count;
+    return dataSize;
+}
+
+/**
+ * @return True if the whole file has been read.
+ */
+bool MPEG2BlockReader::atEnd() const {
+    return endReached;
+}
+
+/**
+ * @return Pointer to the data of the current chunk.
+ */
+const uint8_t *MPEG2BlockReader::data() const {
+    return dataStart;
+}
+
+/**
+ * @return Number of bytes in the current chunk.
+ */
+size_t MPEG2BlockReader::size() const {
+    return dataSize;
+}
+
+/**
+ * @return Size of the buffer for one chunk.
+ */
+size_t MPEG2BlockReader::chunkSize() const {
+    return bufferSize;
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2BlockReader.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro čtení souboru po velkých zarovnaných blocích.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2BlockReader.h
+ *
+ * @brief Module which reads the file in large aligned chunks.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2BLOCKREADER_H
+#define MPEG2BLOCKREADER_H
+
+#include <string>
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Class which reads the file in chunks whose size is multiple of the MPEG2 packet size
+ * and of the block size of the disk, so the file can be read also with O_DIRECT.
+ * The end of the previous chunk can be kept in the carry area in front of the chunk,
+ * so the packets which cross the chunk border are still continuous in memory.
+ * Every reader owns its buffer.
+ */
+class MPEG2BlockReader {
+public:
+    const static size_t BLOCK_ALIGNMENT         = 4096;
+    const static size_t CHUNK_UNIT              = 192512;       // lcm(188, 4096)
+    const static size_t DEFAULT_CHUNK_SIZE      = 16 * CHUNK_UNIT;
+    const static size_t CARRY_SIZE              = BLOCK_ALIGNMENT;
+
+    MPEG2BlockReader(size_t chunkSize = DEFAULT_CHUNK_SIZE, bool directIO = false);
+    MPEG2BlockReader(const MPEG2BlockReader &) = delete;
+    MPEG2BlockReader &operator=(const MPEG2BlockReader &) = delete;
+    ~MPEG2BlockReader();
+
+    bool open(const string &filename);
+    void close();
+    bool isOpen() const;
+
+    bool rewind();
+    size_t readChunk(size_t keepBytes = 0);
+    bool atEnd() const;
+
+    const uint8_t *data() const;
+    size_t size() const;
+    size_t chunkSize() const;
+
+protected:
+    int fd;
+    bool directIO;
+    bool endReached;
+    uint8_t *buffer;
+    size_t bufferSize;
+    const uint8_t *dataStart;
+    size_t dataSize;
+
+    size_t readFully(uint8_t *dest, size_t size);
+};
+
+#endif // MPEG2BLOCKREADER_H
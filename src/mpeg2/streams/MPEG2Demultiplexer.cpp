@@ -0,0 +1,381 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2Demultiplexer.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro rozdělování packetů vstupního streamu podle PID.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2Demultiplexer.cpp
+ *
+ * @brief Module which routes packets of the input stream by their PID.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "MPEG2Demultiplexer.h"
+
+using namespace std;
+
+/**
+ * Constructs demultiplexer of the input stream.
+ * @param is Input stream with the MPEG2 packets.
+ */
+MPEG2Demultiplexer::MPEG2Demultiplexer(MPEG2InputStream &is)
+    : is(is), deferredPackets(0), deferUnknown(true), packetsCount(0), statistics(clock), stopRequested(false), reason(NOT_STOPPED),
+      maxPackets(0), maxPCRTime(0)
+{
+    fill(handlers, handlers + PID_COUNT, (PacketStream *)0);
+    fill(countedPackets, countedPackets + PID_COUNT, 0);
+}
+
+/**
+ * Registers the stream for the packets with its PID.
+ * Stream replaces the counting of the packets with its PID.
+ * @param stream Stream to which will be put packets with its PID.
+ */
+void MPEG2Demultiplexer::addStream(shared_ptr<PacketStream> stream) {
+    uint16_t PID = stream->getPID() & (PID_COUNT - 1);
+    streamsMap[PID] = stream;
+    handlers[PID] = stream.get();
+    countedPackets[PID] = 0;
+}
+
+/**
+ * Tests whether some stream is registered for the PID, or its packets are counted.
+ * @param PID PID of the stream.
+ * @return True if stream is registered, otherwise false.
+ */
+bool MPEG2Demultiplexer::hasStream(uint16_t PID) const {
+    PID &= PID_COUNT - 1;
+    return handlers[PID] || countedPackets[PID] > 0;
+}
+
+/**
+ * Returns stream registered for the PID.
+ * @param PID PID of the stream.
+ * @return Registered stream, or null pointer if there is no stream for the PID.
+ */
+shared_ptr<PacketStream> MPEG2Demultiplexer::getStream(uint16_t PID) const {
+    StreamsMap::const_iterator streamIter = streamsMap.find(PID);
+    return (streamIter != streamsMap.end())? streamIter->second : shared_ptr<PacketStream>();
+}
+
+/**
+ * Returns all registered streams.
+ * @return Map of the streams by their PID.
+ */
+const MPEG2Demultiplexer::StreamsMap &MPEG2Demultiplexer::streams() const {
+    return streamsMap;
+}
+
+/**
+ * Holds back packets with the PID until the stream for them is attached.
+ * @param PID PID of the stream.
+ * @return True if stream has been deferred, false if there is already registered stream for the PID.
+ */
+bool MPEG2Demultiplexer::deferStream(uint16_t PID) {
+    if (hasStream(PID)) {
+        return false;
+    }
+
+    deferredStreams[PID].requested = true;
+    return true;
+}
+
+/**
+ * Registers the stream and puts into it all packets which have been held back for its PID.
+ * @param stream Stream to be attached.
+ */
+void MPEG2Demultiplexer::attachStream(shared_ptr<PacketStream> stream) {
+    addStream(stream);
+
+    map<uint16_t, DeferredStream>::iterator deferredIter = deferredStreams.find(stream->getPID());
+    if (deferredIter == deferredStreams.end()) {
+        return;
+    }
+
+    deque<MPEG2Packet> packets;
+    packets.swap(deferredIter->second.packets);
+    deferredStreams.erase(deferredIter);
+    deferredPackets -= packets.size();
+
+    for (const MPEG2Packet &packet : packets) {
+        putPacket(*stream, packet.view());
+    }
+}
+
+/**
+ * Enables or disables holding back packets of the PIDs without registered stream.
+ * When disabled, the packets held back for streams, which were not explicitly deferred,
+ * are put into the counting streams.
+ * @param deferUnknown True if packets of unknown PIDs should be held back.
+ */
+void MPEG2Demultiplexer::setDeferUnknown(bool deferUnknown) {
+    this->deferUnknown = deferUnknown;
+    if (!deferUnknown) {
+        flushDeferred(false);
+    }
+}
+
+/**
+ * Puts all packets, which have been held back, into the counting streams.
+ */
+void MPEG2Demultiplexer::flushDeferred() {
+    flushDeferred(true);
+}
+
+/**
+ * Puts packets, which have been held back, into the counting streams.
+ * @param requested True if also explicitly deferred streams should be flushed.
+ */
+void MPEG2Demultiplexer::flushDeferred(bool requested) {
+    map<uint16_t, DeferredStream>::iterator deferredIter = deferredStreams.begin();
+    while (deferredIter != deferredStreams.end()) {
+        uint16_t PID = deferredIter->first;
+        bool flush = requested || !deferredIter->second.requested;
+        ++deferredIter;
+
+        if (flush) {
+            attachStream(shared_ptr<PacketStream>(new PacketStream(PID)));
+        }
+    }
+}
+
+/**
+ * Puts packet into the stream and reports failures.
+ * @param stream Stream to which to put the packet.
+ * @param packet Packet to be put.
+ */
+void MPEG2Demultiplexer::putPacket(PacketStream &stream, const MPEG2PacketView &packet) {
+    try {
+        stream << packet;
+    } catch (const exception& error) {
+        reportError(currentFrameNo(), error);
+    }
+}
+
+/**
+ * Returns number of the packet which is being routed.
+ * @return Number of the packet from the beginning of the input stream.
+ */
+long MPEG2Demultiplexer::currentFrameNo() {
+    return is.currentFrameNo();
+}
+
+/**
+ * Reports failure of the packet processing.
+ * @param frameNo Number of the packet.
+ * @param error Reason of the failure.
+ */
+void MPEG2Demultiplexer::reportError(long frameNo, const exception &error) {
+    cerr << "Packet " << frameNo << ": Internal error occured when reading MPEG2 packet!" << endl;
+    cerr << "Reason: " << error.what() << endl;
+}
+
+/**
+ * Routes the packet into the stream registered for its PID.
+ * @param packet Packet to be routed.
+ */
+void MPEG2Demultiplexer::dispatch(const MPEG2PacketView &packet) {
+    uint16_t PID = packet.PID();
+    packetsCount++;
+
+    if (packet.hasPCR()) {
+        try {
+            clock.put(packetsCount - 1, packet);
+        } catch (const exception& error) {
+            reportError(currentFrameNo(), error);
+        }
+    }
+    statistics.put(packet);
+    if (timeStatistics) {
+        timeStatistics->put(packet);
+    }
+
+    if (maxPackets > 0 || maxPCRTime > 0) {
+        checkBudget(packet);
+    }
+
+    PacketStream *handler = handlers[PID];
+    if (handler) {
+        putPacket(*handler, packet);
+        return;
+    }
+
+    if (countedPackets[PID] > 0) {
+        countedPackets[PID]++;
+        return;
+    }
+
+    /* Hold back the packet until its stream is resolved */
+    map<uint16_t, DeferredStream>::iterator deferredIter = deferredStreams.find(PID);
+    if (deferUnknown && deferredIter == deferredStreams.end()) {
+        deferredIter = deferredStreams.insert(pair<uint16_t, DeferredStream>(PID, DeferredStream())).first;
+    }
+
+    if (deferredIter != deferredStreams.end()) {
+        deferredIter->second.packets.push_back(MPEG2Packet(packet));
+        deferredPackets++;
+
+        // Streams were not resolved in time, do not hold back more packets
+        if (deferredPackets > DEFERRED_MAXPACKETS) {
+            cerr << "Packet " << currentFrameNo() << ": Too many packets held back until the PSI tables are read, the unresolved streams will be only counted!" << endl;
+            setDeferUnknown(false);
+            flushDeferred();
+        }
+        return;
+    }
+
+    /* Packet of unknown stream is only counted */
+    countedPackets[PID]++;
+}
+
+/**
+ * Creates the counting streams for the PIDs whose packets were only counted.
+ */
+void MPEG2Demultiplexer::createCountingStreams() {
+    for (unsigned int PID = 0; PID < PID_COUNT; PID++) {
+        if (countedPackets[PID] > 0) {
+            addStream(shared_ptr<PacketStream>(new PacketStream(PID, countedPackets[PID])));
+        }
+    }
+}
+
+/**
+ * Returns number of the packets which were routed, it is the total number of the packets
+ * of all streams when the demultiplexer is closed.
+ * @return Number of the routed packets.
+ */
+long MPEG2Demultiplexer::processedPackets() const {
+    return packetsCount;
+}
+
+/**
+ * Sets PID whose PCR is the reference time of the statistics and the time budget.
+ * @param PCR_PID PCR_PID of the program from its PMT.
+ */
+void MPEG2Demultiplexer::setReferencePID(uint16_t PCR_PID) {
+    clock.setReferencePID(PCR_PID);
+}
+
+/**
+ * @return Time of the multiplex recovered from PCRs of the routed packets.
+ */
+const MPEG2ClockRecovery &MPEG2Demultiplexer::clockRecovery() const {
+    return clock;
+}
+
+/**
+ * @return Bitrates of the routed packets measured by the recovered time.
+ */
+const MPEG2BitrateStatistics &MPEG2Demultiplexer::bitrateStatistics() const {
+    return statistics;
+}
+
+/**
+ * Starts collecting of the statistics of the streams in the time buckets, it should be called before run.
+ * @param bucketSeconds Width of the bucket in seconds.
+ * @param bucketsCount Maximal number of the kept buckets, the oldest ones are dropped.
+ */
+void MPEG2Demultiplexer::enableStreamStatistics(double bucketSeconds, size_t bucketsCount) {
+    timeStatistics.reset(new MPEG2StreamStatistics(clock, bucketSeconds, bucketsCount));
+}
+
+/**
+ * @return Statistics of the streams in the time buckets, null if they are not enabled.
+ */
+const MPEG2StreamStatistics *MPEG2Demultiplexer::streamStatistics() const {
+    return timeStatistics.get();
+}
+
+/**
+ * Stops the processing when the budget is exhausted. Time is taken from the recovered
+ * clock of the reference PID, so it agrees with the clock on the discontinuities.
+ * @param packet Packet which is being routed, the clock has been already advanced by it.
+ */
+void MPEG2Demultiplexer::checkBudget(const MPEG2PacketView &packet) {
+    if (maxPackets > 0 && packetsCount >= maxPackets) {
+        reason = (reason == NOT_STOPPED)? PACKET_BUDGET : reason;
+        stopRequested = true;
+    }
+
+    if (maxPCRTime == 0 || !packet.hasPCR() || packet.PID() != clock.referencePID()) {
+        return;
+    }
+
+    if (clock.currentTime(packet.PID()) >= maxPCRTime) {
+        reason = (reason == NOT_STOPPED)? TIME_BUDGET : reason;
+        stopRequested = true;
+    }
+}
+
+/**
+ * Requests end of the processing, it is stopped after the packet which is being routed.
+ */
+void MPEG2Demultiplexer::stop() {
+    reason = (reason == NOT_STOPPED)? STOP_REQUESTED : reason;
+    stopRequested = true;
+}
+
+/**
+ * @return Reason why the processing ended before the end of the input.
+ */
+MPEG2Demultiplexer::StopReason MPEG2Demultiplexer::stopReason() const {
+    return reason;
+}
+
+/**
+ * Sets maximal number of the packets which are processed.
+ * @param maxPackets Number of the packets, zero for the whole input.
+ */
+void MPEG2Demultiplexer::setPacketBudget(long maxPackets) {
+    this->maxPackets = maxPackets;
+}
+
+/**
+ * Sets maximal time of the stream which is processed, time is measured by PCR.
+ * @param maxSeconds Time in seconds, zero for the whole input.
+ */
+void MPEG2Demultiplexer::setTimeBudget(double maxSeconds) {
+    maxPCRTime = (maxSeconds > 0)? (uint64_t)(maxSeconds * MPEG2PacketView::PCR_CLOCK) : 0;
+}
+
+/**
+ * @return Time of the stream processed so far measured by the recovered clock of the reference PID.
+ */
+double MPEG2Demultiplexer::elapsedSeconds() const {
+    int PID = clock.referencePID();
+    return (PID != -1)? clock.duration(PID) : 0;
+}
+
+/**
+ * Processes the whole input stream and pushes its packets into the corresponding streams.
+ */
+void MPEG2Demultiplexer::run() {
+    for (MPEG2InputStream::iterator &it = is.current(); it != is.end() && !stopRequested; ++it) {
+        dispatch(*it);
+    }
+}
+
+/**
+ * Closes the measurement of the bitrates and all registered streams.
+ */
+void MPEG2Demultiplexer::close() {
+    flushDeferred();
+    createCountingStreams();
+    statistics.close();
+
+    for (const pair<const uint16_t, shared_ptr<PacketStream> > &keyVal : streamsMap) {
+        keyVal.second->close();
+    }
+}
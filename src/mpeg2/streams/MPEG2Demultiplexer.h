@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2Demultiplexer.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro rozdělování packetů vstupního streamu podle PID.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2Demultiplexer.h
+ *
+ * @brief Module which routes packets of the input stream by their PID.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2DEMULTIPLEXER_H
+#define MPEG2DEMULTIPLEXER_H
+
+#include <map>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+
+#include "MPEG2InputStream.h"
+#include "MPEG2PacketStream.h"
+#include "../MPEG2Packet.h"
+#include "../MPEG2ClockRecovery.h"
+#include "../MPEG2BitrateStatistics.h"
+#include "../MPEG2StreamStatistics.h"
+
+/**
+ * Class which reads the input stream in one pass and routes every packet
+ * into the packet stream registered for its PID. Streams may be registered
+ * also during the processing, e.g. from the callbacks of the section streams.
+ *
+ * Packets of the PIDs, which are not known yet, are held back until the stream
+ * for them is attached, so no data is lost while the PSI tables are discovered.
+ *
+ * Streams are looked up in the flat table indexed by PID. Packets of the PIDs
+ * without any stream are only counted and the counting streams for them
+ * are created when the demultiplexer is closed.
+ *
+ * Processing can be stopped before the end of the input, either on request
+ * or when the budget of the packets or of the PCR time is exhausted.
+ */
+class MPEG2Demultiplexer {
+public:
+    typedef map<uint16_t, shared_ptr<PacketStream> > StreamsMap;
+
+    /**
+     * Reason why the processing ended before the end of the input.
+     */
+    enum StopReason {
+        NOT_STOPPED,
+        STOP_REQUESTED,
+        PACKET_BUDGET,
+        TIME_BUDGET
+    };
+
+    MPEG2Demultiplexer(MPEG2InputStream &is);
+    virtual ~MPEG2Demultiplexer() {}
+
+    virtual void addStream(shared_ptr<PacketStream> stream);
+    bool hasStream(uint16_t PID) const;
+    shared_ptr<PacketStream> getStream(uint16_t PID) const;
+    const StreamsMap &streams() const;
+
+    bool deferStream(uint16_t PID);
+    void attachStream(shared_ptr<PacketStream> stream);
+    void setDeferUnknown(bool deferUnknown);
+    void flushDeferred();
+
+    virtual void run();
+    virtual void close();
+
+    void stop();
+    StopReason stopReason() const;
+    void setPacketBudget(long maxPackets);
+    void setTimeBudget(double maxSeconds);
+    double elapsedSeconds() const;
+
+    long processedPackets() const;
+    void setReferencePID(uint16_t PCR_PID);
+    const MPEG2ClockRecovery &clockRecovery() const;
+    const MPEG2BitrateStatistics &bitrateStatistics() const;
+    void enableStreamStatistics(double bucketSeconds, size_t bucketsCount = MPEG2StreamStatistics::DEFAULT_BUCKETS);
+    const MPEG2StreamStatistics *streamStatistics() const;
+
+    const static size_t DEFERRED_MAXPACKETS     = 131072;
+    const static unsigned int PID_COUNT         = 8192;
+
+protected:
+    /**
+     * Packets held back for the stream which has not been attached yet.
+     */
+    struct DeferredStream {
+        DeferredStream() : requested(false) {}
+
+        deque<MPEG2Packet> packets;
+        bool requested;
+    };
+
+    MPEG2InputStream &is;
+    StreamsMap streamsMap;
+    PacketStream *handlers[PID_COUNT];
+    long countedPackets[PID_COUNT];
+    map<uint16_t, DeferredStream> deferredStreams;
+    size_t deferredPackets;
+    bool deferUnknown;
+    long packetsCount;
+    MPEG2ClockRecovery clock;
+    MPEG2BitrateStatistics statistics;
+    unique_ptr<MPEG2StreamStatistics> timeStatistics;  // only on demand
+
+    bool stopRequested;
+    StopReason reason;
+    long maxPackets;
+    uint64_t maxPCRTime;
+
+    void dispatch(const MPEG2PacketView &packet);
+    void checkBudget(const MPEG2PacketView &packet);
+    virtual void putPacket(PacketStream &stream, const MPEG2PacketView &packet);
+    virtual long currentFrameNo();
+    virtual void reportError(long frameNo, const exception &error);
+    void flushDeferred(bool requested);
+    void createCountingStreams();
+};
+
+#endif // MPEG2DEMULTIPLEXER_H
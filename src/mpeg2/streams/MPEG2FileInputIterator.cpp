@@ -18,60 +18,79 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
+#include <typeinfo>
+
 #include "MPEG2FileInputIterator.h"
 
 using namespace std;
 
 /**
- * Buffer for storing MPEG2 packets.
+ * Constructs new file intput iterator which reads packets from the block reader.
+ * Iterator without reader points to the end of the file.
+ * @param reader Block reader of the file, it should point to the beginning of the file.
  */
-static vector<uint8_t> __MPEG2FileInputIterator_buffer(MPEG2Packet::PACKET_SIZE);
-
-/**
- * Reads MPEG2 packet from the file.
- * @param is Input stream from which is read MPEG2 packet.
- * @param packet New packet from the input stream.
- * @return Reference to the current stream.
- */
-istream &operator>>( istream  &is, MPEG2Packet &packet ) {
-
-    is.read((char *)&__MPEG2FileInputIterator_buffer[0], MPEG2Packet::PACKET_SIZE);
-    if (is) {
-        packet = MPEG2Packet(__MPEG2FileInputIterator_buffer);
+MPEG2FileInputIterator::MPEG2FileInputIterator(MPEG2BlockReader *reader)
+    : reader(reader), chunkEnd(0), packetNo(0) {
+    if (reader) {
+        chunkEnd = reader->data() + reader->size();
+        locatePacket(reader->data());
     }
-    return is;
 }
 
 /**
- * Constructs new file intput iterator from the input stream iterator.
- * @param mpeg2Iter Input stream iterator.
+ * Locates the packet at the position, loads next chunks if the packet is not inside the current one.
+ * Iterator points to the end if there is no more packet.
+ * @param position Expected position of the packet.
  */
-MPEG2FileInputIterator::MPEG2FileInputIterator(istream_iterator<MPEG2Packet> mpeg2Iter)
-    : mpeg2Iter(mpeg2Iter) {}
+void MPEG2FileInputIterator::locatePacket(const uint8_t *position) {
+    while (reader) {
+        switch (packetSync.synchronize(position, chunkEnd, reader->atEnd())) {
+        case MPEG2PacketSync::PACKET_FOUND:
+            packetView = MPEG2PacketView(position);
+            return;
+        case MPEG2PacketSync::END_OF_DATA:
+            reader = 0;
+            chunkEnd = 0;
+            packetView = MPEG2PacketView();
+            return;
+        case MPEG2PacketSync::NEED_MORE_DATA:
+            // Unfinished packet is moved in front of the next chunk
+            size_t keepBytes = (position < chunkEnd)? chunkEnd - position : 0;
+            reader->readChunk(keepBytes);
+            position = reader->data();
+            chunkEnd = reader->data() + reader->size();
+            break;
+        }
+    }
+}
 
 /**
  * Incremants the file input iterator.
  * @return Returns value of the new iterator.
  */
 MPEG2InputIterator& MPEG2FileInputIterator::operator++() {
-    mpeg2Iter++;
+    if (!reader) {
+        return *this;
+    }
+
+    packetNo++;
+    locatePacket(packetView.bytes() + packetSync.packetSize());
     return *this;
 }
 
 /**
- * Dereferences current value.
  * @return Current value where iterator points.
  */
-const MPEG2Packet& MPEG2FileInputIterator::operator*() const {
-    return *mpeg2Iter;
+const MPEG2PacketView& MPEG2FileInputIterator::operator*() const {
+    return packetView;
 }
 
 /**
  * Returns pointer to the value, where iterator points.
  * @return Pointer to the current value.
  */
-const MPEG2Packet* MPEG2FileInputIterator::operator->() const {
-    return &(*mpeg2Iter);
+const MPEG2PacketView* MPEG2FileInputIterator::operator->() const {
+    return &packetView;
 }
 
 /**
@@ -82,8 +101,24 @@ const MPEG2Packet* MPEG2FileInputIterator::operator->() const {
 bool MPEG2FileInputIterator::operator==(const MPEG2InputIterator& rhs) const {
     if (typeid(*this) == typeid(rhs)) {
         const MPEG2InputIterator *prhs = &rhs;
-        return mpeg2Iter == static_cast<const MPEG2FileInputIterator *>(prhs)->mpeg2Iter;
+        const MPEG2FileInputIterator *other = static_cast<const MPEG2FileInputIterator *>(prhs);
+        return reader == other->reader && (!reader || packetNo == other->packetNo);
     }
 
     return false;
 }
+
+/**
+ * Returns number of the packet from the beginning of the file.
+ * @return Number of the packet.
+ */
+long MPEG2FileInputIterator::packetNumber() const {
+    return packetNo;
+}
+
+/**
+ * @return Synchronizer of the packets with the detected packet size and statistics.
+ */
+const MPEG2PacketSync &MPEG2FileInputIterator::sync() const {
+    return packetSync;
+}
@@ -21,28 +21,37 @@
 #ifndef MPEG2FILEINPUTITERATOR_H
 #define MPEG2FILEINPUTITERATOR_H
 
-#include <iterator>
-
 #include "MPEG2InputIterator.h"
+#include "MPEG2BlockReader.h"
+#include "MPEG2PacketSync.h"
 
 using namespace std;
 
-istream &operator>>( istream  &is, MPEG2Packet &packet );
-
 /**
- * Class representing MPEG2 iterator from the file.
+ * Class representing MPEG2 iterator from the file. Packets are read
+ * from the chunk which is loaded by the block reader, the sync bytes
+ * of the packets are checked and the sync is recovered when it is lost.
  */
 class MPEG2FileInputIterator: public MPEG2InputIterator {
 public:
-    MPEG2FileInputIterator(istream_iterator<MPEG2Packet> mpeg2Iter);
+    MPEG2FileInputIterator(MPEG2BlockReader *reader = 0);
 
     virtual MPEG2InputIterator& operator++() override;
-    virtual const MPEG2Packet& operator*() const override;
-    virtual const MPEG2Packet* operator->() const override;
+    virtual const MPEG2PacketView& operator*() const override;
+    virtual const MPEG2PacketView* operator->() const override;
     virtual bool operator==(const MPEG2InputIterator& rhs) const override;
 
+    long packetNumber() const;
+    const MPEG2PacketSync &sync() const;
+
 protected:
-    istream_iterator<MPEG2Packet> mpeg2Iter;
+    MPEG2BlockReader *reader;
+    const uint8_t *chunkEnd;
+    long packetNo;
+    MPEG2PacketView packetView;
+    MPEG2PacketSync packetSync;
+
+    void locatePacket(const uint8_t *position);
 };
 
 #endif // MPEG2FILEINPUTITERATOR_H
@@ -24,17 +24,49 @@ using namespace std;
 
 /**
  * Constructs file input stream
+ * @param chunkSize Size of the chunks in which is the file read.
+ * @param directIO True if the file should be read without the page cache, if supported.
  */
-MPEG2FileInputStream::MPEG2FileInputStream()
-    : endInputIter(MPEG2FileInputIterator(istream_iterator<MPEG2Packet>())) {}
+MPEG2FileInputStream::MPEG2FileInputStream(size_t chunkSize, bool directIO)
+    : reader(chunkSize, directIO) {}
+
+/**
+ * Opens the file with the transport stream.
+ * @param filename Name of the file.
+ * @return True on success, otherwise false.
+ */
+bool MPEG2FileInputStream::open(const string &filename) {
+    if (!reader.open(filename)) {
+        return false;
+    }
+
+    currInputFileIter = MPEG2FileInputIterator(&reader);
+    return true;
+}
+
+/**
+ * Closes the file.
+ */
+void MPEG2FileInputStream::close() {
+    reader.close();
+    currInputFileIter = MPEG2FileInputIterator();
+}
+
+/**
+ * Tests if stream is opened.
+ * @return True if stream is not opened, otherwise false.
+ */
+bool MPEG2FileInputStream::operator!(void) const {
+    return !reader.isOpen();
+}
 
 /**
  * Resets stream to the beginning
  */
 void MPEG2FileInputStream::reset() {
-    clear();
-    seekg(0, ios::beg) ;
-    currInputFileIter = shared_ptr<MPEG2FileInputIterator>(new MPEG2FileInputIterator(istream_iterator<MPEG2Packet>(*this)));
+    if (reader.rewind()) {
+        currInputFileIter = MPEG2FileInputIterator(&reader);
+    }
 }
 
 /**
@@ -42,10 +74,7 @@ void MPEG2FileInputStream::reset() {
  * @return Current iterator
  */
 MPEG2InputStream::iterator & MPEG2FileInputStream::current() {
-    if (!currInputFileIter) {
-        currInputFileIter = shared_ptr<MPEG2FileInputIterator>(new MPEG2FileInputIterator(istream_iterator<MPEG2Packet>(*this)));
-    }
-    return *currInputFileIter;
+    return currInputFileIter;
 }
 
 /**
@@ -61,7 +90,21 @@ MPEG2InputStream::iterator & MPEG2FileInputStream::end() {
  * @return Number of the packet from the beginning
  */
 long MPEG2FileInputStream::currentFrameNo() {
-    return tellg() / MPEG2Packet::PACKET_SIZE;
+    return currInputFileIter.packetNumber();
+}
+
+/**
+ * @return Detected size of the packets in the file.
+ */
+unsigned int MPEG2FileInputStream::packetSize() {
+    return currInputFileIter.sync().packetSize();
+}
+
+/**
+ * @return Number of the bytes which were skipped to regain the sync.
+ */
+unsigned long long MPEG2FileInputStream::skippedBytes() {
+    return currInputFileIter.sync().skippedBytes();
 }
 
 /**
@@ -70,6 +113,9 @@ long MPEG2FileInputStream::currentFrameNo() {
  * @return Reference to the current stream.
  */
 MPEG2InputStream & MPEG2FileInputStream::operator>>( MPEG2Packet &packet ) {
-    *this >> packet;
+    if (currInputFileIter != endInputIter) {
+        packet = MPEG2Packet(*currInputFileIter);
+        ++currInputFileIter;
+    }
     return *this;
 }
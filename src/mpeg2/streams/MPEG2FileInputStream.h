@@ -21,9 +21,9 @@
 #ifndef MPEG2FILEINPUTSTREAM_H
 #define MPEG2FILEINPUTSTREAM_H
 
-#include <fstream>
-#include <memory>
+#include <string>
 
+#include "MPEG2BlockReader.h"
 #include "MPEG2FileInputIterator.h"
 #include "MPEG2DefaultInputStream.h"
 
@@ -32,18 +32,25 @@ using namespace std;
 /**
  * Class representing MPEG2 stream from the file.
  */
-class MPEG2FileInputStream: public MPEG2DefaultInputStream, public ifstream {
+class MPEG2FileInputStream: public MPEG2DefaultInputStream {
 public:
-    MPEG2FileInputStream();
+    MPEG2FileInputStream(size_t chunkSize = MPEG2BlockReader::DEFAULT_CHUNK_SIZE, bool directIO = false);
+
+    bool open(const string &filename);
+    void close();
+    bool operator!(void) const;
 
     virtual void reset() override;
     virtual iterator &current() override;
     virtual iterator &end() override;
     virtual long currentFrameNo() override;
+    virtual unsigned int packetSize() override;
+    virtual unsigned long long skippedBytes() override;
     virtual MPEG2InputStream &operator>>( MPEG2Packet &packet ) override;
 
 protected:
-    shared_ptr<MPEG2FileInputIterator> currInputFileIter;
+    MPEG2BlockReader reader;
+    MPEG2FileInputIterator currInputFileIter;
     MPEG2FileInputIterator endInputIter;
 };
 
@@ -35,11 +35,11 @@ public:
         return *this;
     }
 
-    virtual const MPEG2Packet& operator*() const {
+    virtual const MPEG2PacketView& operator*() const {
         return defaultPacket;
     }
 
-    virtual const MPEG2Packet* operator->() const {
+    virtual const MPEG2PacketView* operator->() const {
         return &defaultPacket;
     }
 
@@ -58,7 +58,7 @@ public:
     }
 
 protected:
-    mutable MPEG2Packet defaultPacket;
+    MPEG2PacketView defaultPacket;
 };
 
 #endif // MPEG2INPUTITERATOR_H
@@ -36,6 +36,8 @@ public:
     virtual iterator &current() = 0;
     virtual iterator &end() = 0;
     virtual long currentFrameNo() = 0;
+    virtual unsigned int packetSize() = 0;
+    virtual unsigned long long skippedBytes() = 0;
     virtual MPEG2InputStream &operator>>( MPEG2Packet &packet ) = 0;
 };
 
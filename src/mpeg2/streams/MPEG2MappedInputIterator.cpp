@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2MappedInputIterator.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul implementující iterátor nad souborem mapovaným do paměti.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2MappedInputIterator.cpp
+ *
+ * @brief Module which implements iterator over the file mapped into memory.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <typeinfo>
+
+#include "MPEG2MappedInputIterator.h"
+
+using namespace std;
+
+/**
+ * Constructs iterator which does not point into any file.
+ */
+MPEG2MappedInputIterator::MPEG2MappedInputIterator()
+    : dataEnd(0), packetNo(0) {}
+
+/**
+ * Locates the packet at the position. If there is no more packet, iterator points to the end of the data.
+ * @param position Expected position of the packet.
+ */
+void MPEG2MappedInputIterator::locatePacket(const uint8_t *position) {
+    if (packetSync.synchronize(position, dataEnd, true) != MPEG2PacketSync::PACKET_FOUND) {
+        position = dataEnd;
+    }
+    packetView = MPEG2PacketView(position);
+}
+
+/**
+ * Incremants the iterator, moves it to the next packet.
+ * @return Returns value of the new iterator.
+ */
+MPEG2InputIterator& MPEG2MappedInputIterator::operator++() {
+    if (position() != dataEnd) {
+        packetNo++;
+        locatePacket(packetView.bytes() + packetSync.packetSize());
+    }
+    return *this;
+}
+
+/**
+ * @return Current value where iterator points.
+ */
+const MPEG2PacketView& MPEG2MappedInputIterator::operator*() const {
+    return packetView;
+}
+
+/**
+ * Returns pointer to the value, where iterator points.
+ * @return Pointer to the current value.
+ */
+const MPEG2PacketView* MPEG2MappedInputIterator::operator->() const {
+    return &packetView;
+}
+
+/**
+ * Test for equal.
+ * @param rhs Second iterator against which to compare.
+ * @return True if both iterators are the same, otherwise false.
+ */
+bool MPEG2MappedInputIterator::operator==(const MPEG2InputIterator& rhs) const {
+    if (typeid(*this) == typeid(rhs)) {
+        const MPEG2InputIterator *prhs = &rhs;
+        return position() == static_cast<const MPEG2MappedInputIterator *>(prhs)->position();
+    }
+
+    return false;
+}
+
+/**
+ * @return Pointer to the packet where iterator points.
+ */
+const uint8_t *MPEG2MappedInputIterator::position() const {
+    return packetView.bytes();
+}
+
+/**
+ * Moves iterator to the first packet of the data.
+ * @param begin Beginning of the data.
+ * @param end End of the data.
+ */
+void MPEG2MappedInputIterator::assign(const uint8_t *begin, const uint8_t *end) {
+    dataEnd = end;
+    packetNo = 0;
+    packetSync.reset();
+    locatePacket(begin);
+}
+
+/**
+ * Returns number of the packet from the beginning of the data.
+ * @return Number of the packet.
+ */
+long MPEG2MappedInputIterator::packetNumber() const {
+    return packetNo;
+}
+
+/**
+ * @return Synchronizer of the packets with the detected packet size and statistics.
+ */
+const MPEG2PacketSync &MPEG2MappedInputIterator::sync() const {
+    return packetSync;
+}
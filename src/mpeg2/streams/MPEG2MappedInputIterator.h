@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2MappedInputIterator.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul implementující iterátor nad souborem mapovaným do paměti.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2MappedInputIterator.h
+ *
+ * @brief Module which implements iterator over the file mapped into memory.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2MAPPEDINPUTITERATOR_H
+#define MPEG2MAPPEDINPUTITERATOR_H
+
+#include "MPEG2InputIterator.h"
+#include "MPEG2PacketSync.h"
+
+using namespace std;
+
+/**
+ * Class representing MPEG2 iterator over the file mapped into memory.
+ * The sync bytes of the packets are checked and the sync is recovered when it is lost.
+ */
+class MPEG2MappedInputIterator: public MPEG2InputIterator {
+public:
+    MPEG2MappedInputIterator();
+
+    virtual MPEG2InputIterator& operator++() override;
+    virtual const MPEG2PacketView& operator*() const override;
+    virtual const MPEG2PacketView* operator->() const override;
+    virtual bool operator==(const MPEG2InputIterator& rhs) const override;
+
+    const uint8_t *position() const;
+    void assign(const uint8_t *begin, const uint8_t *end);
+    long packetNumber() const;
+    const MPEG2PacketSync &sync() const;
+
+protected:
+    const uint8_t *dataEnd;
+    long packetNo;
+    MPEG2PacketView packetView;
+    MPEG2PacketSync packetSync;
+
+    void locatePacket(const uint8_t *position);
+};
+
+#endif // MPEG2MAPPEDINPUTITERATOR_H
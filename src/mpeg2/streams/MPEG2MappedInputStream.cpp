@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2MappedInputStream.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul implementující vstupní stream ze souboru mapovaného do paměti.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2MappedInputStream.cpp
+ *
+ * @brief Module which implements input stream from the file mapped into memory.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "MPEG2MappedInputStream.h"
+
+using namespace std;
+
+/**
+ * Constructs stream which is not opened yet.
+ */
+MPEG2MappedInputStream::MPEG2MappedInputStream()
+    : mapping(0), mappingSize(0) {}
+
+/**
+ * Unmaps the file.
+ */
+MPEG2MappedInputStream::~MPEG2MappedInputStream() {
+    close();
+}
+
+/**
+ * Maps the file into memory.
+ * @param filename Name of the file with the transport stream.
+ * @return True on success, false if the file could not be mapped.
+ */
+bool MPEG2MappedInputStream::open(const string &filename) {
+    close();
+
+#if defined(_WIN32)
+    (void)filename;
+    return false;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *addr = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // mapping holds its own reference to the file
+
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    madvise(addr, fileStat.st_size, MADV_SEQUENTIAL);
+
+    mapping = static_cast<uint8_t *>(addr);
+    mappingSize = fileStat.st_size;
+
+    currInputIter.assign(mapping, mapping + mappingSize);
+    endInputIter.assign(mapping + mappingSize, mapping + mappingSize);
+
+    return true;
+#endif
+}
+
+/**
+ * Unmaps the file.
+ */
+void MPEG2MappedInputStream::close() {
+#if !defined(_WIN32)
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+
+    mapping = 0;
+    mappingSize = 0;
+    currInputIter.assign(0, 0);
+    endInputIter.assign(0, 0);
+}
+
+/**
+ * Tests if file is mapped.
+ * @return True if stream is not opened, otherwise false.
+ */
+bool MPEG2MappedInputStream::operator!(void) const {
+    return mapping == 0;
+}
+
+/**
+ * Resets stream to the beginning
+ */
+void MPEG2MappedInputStream::reset() {
+    currInputIter.assign(mapping, mapping + mappingSize);
+}
+
+/**
+ * Returns current iterator
+ * @return Current iterator
+ */
+MPEG2InputStream::iterator & MPEG2MappedInputStream::current() {
+    return currInputIter;
+}
+
+/**
+ * Returns iterator which points to the end
+ * @return Iterator which points to the end
+ */
+MPEG2InputStream::iterator & MPEG2MappedInputStream::end() {
+    return endInputIter;
+}
+
+/**
+ * Returns number of the packet from the beginning
+ * @return Number of the packet from the beginning
+ */
+long MPEG2MappedInputStream::currentFrameNo() {
+    return currInputIter.packetNumber();
+}
+
+/**
+ * @return Detected size of the packets in the file.
+ */
+unsigned int MPEG2MappedInputStream::packetSize() {
+    return currInputIter.sync().packetSize();
+}
+
+/**
+ * @return Number of the bytes which were skipped to regain the sync.
+ */
+unsigned long long MPEG2MappedInputStream::skippedBytes() {
+    return currInputIter.sync().skippedBytes();
+}
+
+/**
+ * Copies current MPEG2 packet and moves to the next one.
+ * @param packet New packet from the input stream.
+ * @return Reference to the current stream.
+ */
+MPEG2InputStream & MPEG2MappedInputStream::operator>>( MPEG2Packet &packet ) {
+    if (currInputIter != endInputIter) {
+        packet = MPEG2Packet(*currInputIter);
+        ++currInputIter;
+    }
+    return *this;
+}
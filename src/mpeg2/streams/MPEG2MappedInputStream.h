@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2MappedInputStream.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul implementující vstupní stream ze souboru mapovaného do paměti.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2MappedInputStream.h
+ *
+ * @brief Module which implements input stream from the file mapped into memory.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2MAPPEDINPUTSTREAM_H
+#define MPEG2MAPPEDINPUTSTREAM_H
+
+#include <string>
+
+#include "MPEG2MappedInputIterator.h"
+#include "MPEG2DefaultInputStream.h"
+
+using namespace std;
+
+/**
+ * Class representing MPEG2 stream from the file which is mapped into memory.
+ * Packets are not copied, iterators point directly into the mapping.
+ */
+class MPEG2MappedInputStream: public MPEG2DefaultInputStream {
+public:
+    MPEG2MappedInputStream();
+    MPEG2MappedInputStream(const MPEG2MappedInputStream &) = delete;
+    MPEG2MappedInputStream &operator=(const MPEG2MappedInputStream &) = delete;
+    virtual ~MPEG2MappedInputStream();
+
+    bool open(const string &filename);
+    void close();
+    bool operator!(void) const;
+
+    virtual void reset() override;
+    virtual iterator &current() override;
+    virtual iterator &end() override;
+    virtual long currentFrameNo() override;
+    virtual unsigned int packetSize() override;
+    virtual unsigned long long skippedBytes() override;
+    virtual MPEG2InputStream &operator>>( MPEG2Packet &packet ) override;
+
+protected:
+    uint8_t *mapping;
+    size_t mappingSize;
+    MPEG2MappedInputIterator currInputIter;
+    MPEG2MappedInputIterator endInputIter;
+};
+
+#endif // MPEG2MAPPEDINPUTSTREAM_H
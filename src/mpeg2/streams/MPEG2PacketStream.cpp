@@ -20,26 +20,21 @@
 
 #include "MPEG2PacketStream.h"
 
-/**
- * Counter of the total number of packets.
- */
-long PacketStream::_processedPackets = 0;
-
 /**
  * Puts new MPEG2 packet into the stream.
  * @return Reference to the current stream.
  */
-PacketStream &PacketStream::put(const MPEG2Packet &) {
+PacketStream &PacketStream::put(const MPEG2PacketView &) {
     _packetsInStream++;
-    _processedPackets++;
     return *this;
 }
 
 /**
  * Constructs output packet stream.
  * @param PID PID of the packets which will be put into this stream.
+ * @param packetsInStream Number of the packets which were already counted for this stream.
  */
-PacketStream::PacketStream(uint16_t PID) : _packetsInStream(0), PID(PID) {}
+PacketStream::PacketStream(uint16_t PID, long packetsInStream) : _packetsInStream(packetsInStream), PID(PID) {}
 
 /**
  * Closes output stream
@@ -54,14 +49,6 @@ long PacketStream::packetsInStream() {
     return _packetsInStream;
 }
 
-/**
- * Returns number of the packets which were processed by this class.
- * @return Number of the packets which were processed by this class.
- */
-long PacketStream::processedPackets() {
-    return _processedPackets;
-}
-
 /**
  * Returns PID of the stream.
  * @return PID of the stream.
@@ -77,18 +64,19 @@ uint16_t PacketStream::getPID() {
  * @param codeRate Code rate
  * @param constellation Constellation
  * @param guardinterval Guard interval
+ * @param processedPackets Total number of the packets of the multiplex
  * @return Bitrate of the stream
  */
-BitratePerPID PacketStream::calculateBitRate(const Bandwidth &bandwidth, const CodeRate &codeRate, const Constellation &constellation, const GuardInterval &guardinterval) {
+BitratePerPID PacketStream::calculateBitRate(const Bandwidth &bandwidth, const CodeRate &codeRate, const Constellation &constellation, const GuardInterval &guardinterval, long processedPackets) {
     double maxBitRate = (423.0 / 544) * bandwidth.toValue() * codeRate.toValue();
     maxBitRate *= constellation.toValue() * guardinterval.toValue();
     BitratePerPID bitRatePerPID;
     bitRatePerPID.PID = PID;
-    bitRatePerPID.bitrate = maxBitRate * ((double)_packetsInStream / _processedPackets) / 1000000;
+    bitRatePerPID.bitrate = maxBitRate * ((double)_packetsInStream / processedPackets) / 1000000;
     return bitRatePerPID;
 }
 
-PacketStream& PacketStream::operator<< (const MPEG2Packet& packet) {
+PacketStream& PacketStream::operator<< (const MPEG2PacketView& packet) {
     return put(packet);
 }
 
@@ -22,7 +22,7 @@
 #define MPEG2PACKETSTREAM_H
 
 #include "../PSI/Descriptors.h"
-#include "../MPEG2Packet.h"
+#include "../MPEG2PacketView.h"
 
 /**
  * Structore for storing bitrate of the stream
@@ -45,21 +45,20 @@ struct BitratePerPID {
  */
 class PacketStream {
 protected:
-    virtual PacketStream &put(const MPEG2Packet &);
+    virtual PacketStream &put(const MPEG2PacketView &);
 
-    static long _processedPackets;
     mutable long _packetsInStream;
     uint16_t PID;
 public:
-    PacketStream(uint16_t PID);
+    PacketStream(uint16_t PID, long packetsInStream = 0);
 
     virtual void close();
     long packetsInStream();
-    long processedPackets();
     uint16_t getPID();
     BitratePerPID calculateBitRate(const Bandwidth &bandwidth, const CodeRate &codeRate,
-                                   const Constellation &constellation, const GuardInterval &guardinterval);
+                                   const Constellation &constellation, const GuardInterval &guardinterval,
+                                   long processedPackets);
 
-    PacketStream& operator<< (const MPEG2Packet& packet);
+    PacketStream& operator<< (const MPEG2PacketView& packet);
 };
 #endif // MPEG2PACKETSTREAM_H
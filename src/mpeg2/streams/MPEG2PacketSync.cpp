@@ -0,0 +1,176 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2PacketSync.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro synchronizaci na začátky MPEG2 packetů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2PacketSync.cpp
+ *
+ * @brief Module which synchronizes reading to the beginnings of the MPEG2 packets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+
+#include "MPEG2PacketSync.h"
+
+/**
+ * Constructs synchronizer with the unknown size of the packets.
+ */
+MPEG2PacketSync::MPEG2PacketSync() {
+    reset();
+}
+
+/**
+ * Forgets the detected size of the packets and the statistics.
+ */
+void MPEG2PacketSync::reset() {
+    stride = 0;
+    locked = false;
+    skipped = 0;
+    syncLosses = 0;
+}
+
+/**
+ * Locates the packet which should start at the position. If there is not the sync byte,
+ * the data are scanned for the next sync byte.
+ * @param position Expected position of the sync byte, on return position of the packet
+ * or the first byte which should be kept if more data are needed.
+ * @param end End of the available data.
+ * @param final True if no more data will follow.
+ * @return Result of the synchronization.
+ */
+MPEG2PacketSync::Result MPEG2PacketSync::synchronize(const uint8_t *&position, const uint8_t *end, bool final) {
+    if (locked) {
+        // Packet which was started in the previous data has been fully skipped
+        if (position >= end || (size_t)(end - position) < TS_PACKET_SIZE) {
+            return (final)? END_OF_DATA : NEED_MORE_DATA;
+        }
+
+        if (*position == SYNC_BYTE) {
+            // Whole packet including the bytes before next sync byte has to be available
+            return (final || (size_t)(end - position) >= stride)? PACKET_FOUND : NEED_MORE_DATA;
+        }
+
+        locked = false;
+        syncLosses++;
+    }
+
+    return hunt(position, end, final);
+}
+
+/**
+ * Tests whether the sync bytes follow the candidate at the period of the packet size.
+ * @param candidate Candidate for the sync byte.
+ * @param end End of the available data.
+ * @param packetSize Tested size of the packets.
+ * @param final True if no more data will follow, candidate is then confirmed by the available packets.
+ * @param needMore Set to true if there is not enough data to decide.
+ * @return True if the candidate is confirmed.
+ */
+bool MPEG2PacketSync::confirm(const uint8_t *candidate, const uint8_t *end, unsigned int packetSize, bool final, bool &needMore) const {
+    if ((size_t)(end - candidate) < TS_PACKET_SIZE) {
+        needMore = needMore || !final;
+        return false;
+    }
+
+    for (unsigned int i = 1; i < SYNC_CONFIRMATIONS; i++) {
+        const uint8_t *next = candidate + i * packetSize;
+        if (next >= end) {
+            needMore = needMore || !final;
+            return final;
+        }
+
+        if (*next != SYNC_BYTE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Scans data for the sync byte which is repeated at the period of some of the packet sizes.
+ * @param position Position from which to scan, on return position of the packet,
+ * or the first byte which should be kept if more data are needed.
+ * @param end End of the available data.
+ * @param final True if no more data will follow.
+ * @return Result of the synchronization.
+ */
+MPEG2PacketSync::Result MPEG2PacketSync::hunt(const uint8_t *&position, const uint8_t *end, bool final) {
+    const unsigned int packetSizes[] = { stride, TS_PACKET_SIZE, M2TS_PACKET_SIZE, RS_PACKET_SIZE };
+    const uint8_t *candidate = position;
+
+    while (candidate < end) {
+        // memchr is vectorized by the C library, it is much faster than the byte loop
+        candidate = static_cast<const uint8_t *>(memchr(candidate, SYNC_BYTE, end - candidate));
+        if (!candidate) {
+            candidate = end;
+            break;
+        }
+
+        // Confirmation never looks further than the sync bytes of the largest packets
+        bool bounded = (size_t)(end - candidate) > MAX_LOOKAHEAD;
+        const uint8_t *lookaheadEnd = (bounded)? candidate + MAX_LOOKAHEAD : end;
+
+        bool needMore = false;
+        for (unsigned int packetSize : packetSizes) {
+            if (packetSize == 0 || !confirm(candidate, lookaheadEnd, packetSize, final || bounded, needMore)) {
+                continue;
+            }
+
+            // Timestamp of the first M2TS packet is not a garbage
+            size_t skippedNow = candidate - position;
+            if (stride == 0 && packetSize == M2TS_PACKET_SIZE && skippedNow >= M2TS_HEADER_SIZE) {
+                skippedNow -= M2TS_HEADER_SIZE;
+            }
+
+            skipped += skippedNow;
+            stride = packetSize;
+            locked = true;
+            position = candidate;
+            return (final || (size_t)(end - position) >= stride)? PACKET_FOUND : NEED_MORE_DATA;
+        }
+
+        if (needMore) {
+            skipped += candidate - position;
+            position = candidate;
+            return NEED_MORE_DATA;
+        }
+
+        candidate++;
+    }
+
+    skipped += candidate - position;
+    position = candidate;
+    return (final)? END_OF_DATA : NEED_MORE_DATA;
+}
+
+/**
+ * @return Detected size of the packets including the timestamp or parity bytes.
+ */
+unsigned int MPEG2PacketSync::packetSize() const {
+    return (stride == 0)? TS_PACKET_SIZE : stride;
+}
+
+/**
+ * @return Number of the bytes which were skipped to find the sync byte.
+ */
+unsigned long long MPEG2PacketSync::skippedBytes() const {
+    return skipped;
+}
+
+/**
+ * @return Number of the times, when the sync was lost.
+ */
+unsigned long MPEG2PacketSync::lostSyncs() const {
+    return syncLosses;
+}
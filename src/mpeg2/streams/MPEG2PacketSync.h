@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2PacketSync.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro synchronizaci na začátky MPEG2 packetů.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2PacketSync.h
+ *
+ * @brief Module which synchronizes reading to the beginnings of the MPEG2 packets.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2PACKETSYNC_H
+#define MPEG2PACKETSYNC_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Class which locates the sync bytes of the MPEG2 packets in the input data.
+ * Size of the packets (188, 192 bytes of M2TS with timestamp or 204 bytes with
+ * Reed-Solomon parity) is detected from the periodicity of the sync bytes.
+ * When the sync is lost, data are scanned until the sync byte is found again
+ * at the same periodicity, number of the skipped bytes is counted.
+ */
+class MPEG2PacketSync {
+public:
+    const static uint8_t SYNC_BYTE                  = 0x47;
+    const static unsigned int TS_PACKET_SIZE        = 188;
+    const static unsigned int M2TS_PACKET_SIZE      = 192;
+    const static unsigned int RS_PACKET_SIZE        = 204;
+    const static unsigned int M2TS_HEADER_SIZE      = 4;
+    const static unsigned int SYNC_CONFIRMATIONS    = 5;    // sync bytes which have to be found in a row
+    const static unsigned int MAX_LOOKAHEAD         = (SYNC_CONFIRMATIONS - 1) * RS_PACKET_SIZE + TS_PACKET_SIZE;    // bytes inspected to confirm the candidate
+
+    /**
+     * Result of the synchronization.
+     */
+    enum Result {
+        PACKET_FOUND,       // position points to the sync byte of the packet
+        NEED_MORE_DATA,     // bytes from position have to be kept and more data appended after them
+        END_OF_DATA         // there is no other packet
+    };
+
+    MPEG2PacketSync();
+
+    Result synchronize(const uint8_t *&position, const uint8_t *end, bool final);
+    void reset();
+
+    unsigned int packetSize() const;
+    unsigned long long skippedBytes() const;
+    unsigned long lostSyncs() const;
+
+protected:
+    unsigned int stride;
+    bool locked;
+    unsigned long long skipped;
+    unsigned long syncLosses;
+
+    Result hunt(const uint8_t *&position, const uint8_t *end, bool final);
+    bool confirm(const uint8_t *candidate, const uint8_t *end, unsigned int packetSize, bool final, bool &needMore) const;
+};
+
+#endif // MPEG2PACKETSYNC_H
@@ -0,0 +1,350 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2ParallelDemultiplexer.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro rozdělování packetů podle PID ve více vláknech.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2ParallelDemultiplexer.cpp
+ *
+ * @brief Module which routes packets by their PID in the several threads.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <functional>
+#include <algorithm>
+
+#include "MPEG2ParallelDemultiplexer.h"
+#include "MPEG2ServiceStream.h"
+
+using namespace std;
+
+/**
+ * Constructs demultiplexer and starts its worker threads.
+ * @param is Input stream with the MPEG2 packets.
+ * @param threads Total number of the threads, reader and router take two of them,
+ * the rest is used by the workers (at least one).
+ */
+MPEG2ParallelDemultiplexer::MPEG2ParallelDemultiplexer(MPEG2InputStream &is, unsigned int threads)
+    : MPEG2Demultiplexer(is), nextWorker(0), workersRunning(true), readBatches(BATCHES_IN_FLIGHT), nextReadBatch(0),
+      routedBatch(0), routedFrameNo(0), stopReading(false)
+{
+    fill(pidWorkers, pidWorkers + PID_COUNT, (Worker *)0);
+
+    for (ReadBatch &batch : readBatches) {
+        batch.packets.reserve(BATCH_PACKETS);
+        batch.frameNumbers.reserve(BATCH_PACKETS);
+    }
+
+    unsigned int workersCount = (threads > 2)? threads - 2 : 1;
+
+    for (unsigned int i = 0; i < workersCount; i++) {
+        unique_ptr<Worker> worker(new Worker());
+        for (PacketBatch &batch : worker->batches) {
+            batch.packets.reserve(BATCH_PACKETS);
+            batch.copies.reserve(BATCH_PACKETS);
+            batch.streams.reserve(BATCH_PACKETS);
+            batch.frameNumbers.reserve(BATCH_PACKETS);
+            worker->freeBatches.push(&batch);
+        }
+        worker->workerThread = thread(&MPEG2ParallelDemultiplexer::processBatches, this, ref(*worker));
+        workers.push_back(move(worker));
+    }
+}
+
+/**
+ * Stops the worker threads if they are still running.
+ */
+MPEG2ParallelDemultiplexer::~MPEG2ParallelDemultiplexer() {
+    stopWorkers();
+}
+
+/**
+ * @return Number of the worker threads.
+ */
+unsigned int MPEG2ParallelDemultiplexer::workersCount() const {
+    return workers.size();
+}
+
+/**
+ * Registers the stream, service streams are bound to the worker threads.
+ * @param stream Stream to which will be put packets with its PID.
+ */
+void MPEG2ParallelDemultiplexer::addStream(shared_ptr<PacketStream> stream) {
+    MPEG2Demultiplexer::addStream(stream);
+
+    uint16_t PID = stream->getPID() & (PID_COUNT - 1);
+    if (dynamic_cast<MPEG2ServiceStream *>(stream.get())) {
+        pidWorkers[PID] = workers[nextWorker % workers.size()].get();
+        nextWorker++;
+    } else {
+        pidWorkers[PID] = 0;
+    }
+}
+
+/**
+ * Puts packet into the stream, packets of the service streams are passed to their worker.
+ * Packet of the routed read batch is passed as the view, the batch is then held until
+ * the worker processes it. Other packets (e.g. the deferred ones) are copied.
+ * @param stream Stream to which to put the packet.
+ * @param packet Packet to be put.
+ */
+void MPEG2ParallelDemultiplexer::putPacket(PacketStream &stream, const MPEG2PacketView &packet) {
+    Worker *streamWorker = pidWorkers[packet.PID()];
+    if (!workersRunning || !streamWorker) {
+        MPEG2Demultiplexer::putPacket(stream, packet);
+        return;
+    }
+
+    Worker &worker = *streamWorker;
+
+    // Batch of the worker holds only one read batch
+    if (worker.pending && worker.pending->source != routedBatch) {
+        flushWorker(worker, false);
+    }
+
+    if (!worker.pending) {
+        worker.pending = worker.freeBatches.pop();
+        worker.pending->source = routedBatch;
+        if (routedBatch) {
+            routedBatch->users.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    const uint8_t *data = packet.bytes();
+    bool isRouted = routedBatch && !routedBatch->packets.empty() && data >= routedBatch->packets.front().data &&
+                    data <= routedBatch->packets.back().data;
+    if (isRouted) {
+        worker.pending->packets.push_back(packet);
+    } else {
+        worker.pending->copies.push_back(MPEG2Packet(packet));
+        worker.pending->packets.push_back(worker.pending->copies.back().view());
+    }
+    worker.pending->streams.push_back(&stream);
+    worker.pending->frameNumbers.push_back(currentFrameNo());
+
+    if (worker.pending->packets.size() >= BATCH_PACKETS) {
+        flushWorker(worker, false);
+    }
+}
+
+/**
+ * Returns number of the packet which is being routed.
+ * @return Number of the packet from the beginning of the input stream.
+ */
+long MPEG2ParallelDemultiplexer::currentFrameNo() {
+    return routedFrameNo;
+}
+
+/**
+ * Reports failure of the packet processing, reports from the threads are not mixed.
+ * @param frameNo Number of the packet.
+ * @param error Reason of the failure.
+ */
+void MPEG2ParallelDemultiplexer::reportError(long frameNo, const exception &error) {
+    lock_guard<mutex> lock(errorMutex);
+    MPEG2Demultiplexer::reportError(frameNo, error);
+}
+
+/**
+ * Passes the pending batch of the packets to the worker.
+ * @param worker Worker to which to pass the batch.
+ * @param last True if this is the last batch, the worker then finishes.
+ */
+void MPEG2ParallelDemultiplexer::flushWorker(Worker &worker, bool last) {
+    if (!worker.pending && !last) {
+        return;
+    }
+
+    if (!worker.pending) {
+        worker.pending = worker.freeBatches.pop();
+    }
+
+    worker.pending->last = last;
+    worker.queue.push(worker.pending);
+    worker.pending = 0;
+}
+
+/**
+ * Passes the remaining packets to the workers and waits until they finish.
+ */
+void MPEG2ParallelDemultiplexer::stopWorkers() {
+    if (!workersRunning) {
+        return;
+    }
+
+    for (unique_ptr<Worker> &worker : workers) {
+        flushWorker(*worker, true);
+    }
+
+    for (unique_ptr<Worker> &worker : workers) {
+        worker->workerThread.join();
+    }
+
+    workersRunning = false;
+}
+
+/**
+ * Body of the worker thread, puts the packets of the batches into their streams.
+ * @param worker Worker which is run.
+ */
+void MPEG2ParallelDemultiplexer::processBatches(Worker &worker) {
+    bool last = false;
+    while (!last) {
+        PacketBatch *batch = worker.queue.pop();
+
+        for (size_t i = 0; i < batch->packets.size(); i++) {
+            try {
+                *batch->streams[i] << batch->packets[i];
+            } catch (const exception& error) {
+                reportError(batch->frameNumbers[i], error);
+            }
+        }
+
+        if (batch->source) {
+            releaseReadBatch(batch->source);
+        }
+
+        last = batch->last;
+        batch->clear();
+        worker.freeBatches.push(batch);
+    }
+}
+
+/**
+ * Waits until some read batch is released by the router and the workers.
+ * @return Empty batch which is held by the router.
+ */
+MPEG2ParallelDemultiplexer::ReadBatch *MPEG2ParallelDemultiplexer::acquireReadBatch() {
+    for (unsigned int spins = 0; ; spins++) {
+        for (size_t i = 0; i < readBatches.size(); i++) {
+            ReadBatch &batch = readBatches[(nextReadBatch + i) % readBatches.size()];
+            if (batch.users.load(memory_order_acquire) == 0) {
+                nextReadBatch = (nextReadBatch + i + 1) % readBatches.size();
+                batch.clear();
+                batch.users.store(1, memory_order_relaxed);
+                return &batch;
+            }
+        }
+
+        SPSCQueue<ReadBatch *>::backoff(spins);
+    }
+}
+
+/**
+ * Drops one holder of the read batch, batch without holders can be reused by the reader.
+ * @param batch Read batch.
+ */
+void MPEG2ParallelDemultiplexer::releaseReadBatch(ReadBatch *batch) {
+    batch->users.fetch_sub(1, memory_order_release);
+}
+
+/**
+ * Body of the reader thread, reads the input stream in batches of the packets.
+ * @param fullBatches Queue for the read batches.
+ * @param readError Failure of the reading.
+ */
+void MPEG2ParallelDemultiplexer::readPackets(SPSCQueue<ReadBatch *> &fullBatches, exception_ptr &readError) {
+    try {
+        MPEG2InputStream::iterator &it = is.current();
+        bool last = false;
+
+        while (!last) {
+            ReadBatch *batch = acquireReadBatch();
+            while (batch->packets.size() < BATCH_PACKETS && it != is.end()) {
+                batch->frameNumbers.push_back(is.currentFrameNo());
+                batch->packets.push_back(MPEG2Packet(*it));
+                ++it;
+            }
+
+            last = it == is.end() || stopReading;
+            batch->last = last;
+            fullBatches.push(batch);
+        }
+    } catch (...) {
+        readError = current_exception();
+
+        ReadBatch *batch = acquireReadBatch();
+        batch->last = true;
+        fullBatches.push(batch);
+    }
+}
+
+/**
+ * Processes the whole input stream and pushes its packets into the corresponding streams.
+ * Packets passed to the workers may be still processed when the method returns, the streams
+ * are finished by close().
+ */
+void MPEG2ParallelDemultiplexer::run() {
+    SPSCQueue<ReadBatch *> fullBatches(BATCHES_IN_FLIGHT);
+
+    exception_ptr readError;
+    stopReading = false;
+    thread reader(&MPEG2ParallelDemultiplexer::readPackets, this, ref(fullBatches), ref(readError));
+
+    bool last = false;
+    try {
+        while (!last) {
+            ReadBatch *batch = fullBatches.pop();
+
+            routedBatch = batch;
+            for (size_t i = 0; i < batch->packets.size() && !stopRequested; i++) {
+                routedFrameNo = batch->frameNumbers[i];
+                dispatch(batch->packets[i].view());
+            }
+
+            // Batches which are already read are only returned to the reader
+            if (stopRequested) {
+                stopReading = true;
+            }
+
+            for (unique_ptr<Worker> &worker : workers) {
+                flushWorker(*worker, false);
+            }
+
+            last = batch->last;
+            routedBatch = 0;
+            releaseReadBatch(batch);
+        }
+    } catch (...) {
+        for (unique_ptr<Worker> &worker : workers) {
+            flushWorker(*worker, false);
+        }
+        if (routedBatch) {
+            releaseReadBatch(routedBatch);
+            routedBatch = 0;
+        }
+
+        // Let the reader finish, it can wait for the free batch
+        stopReading = true;
+        while (!last) {
+            ReadBatch *batch = fullBatches.pop();
+            last = batch->last;
+            releaseReadBatch(batch);
+        }
+        reader.join();
+        throw;
+    }
+
+    reader.join();
+
+    if (readError) {
+        rethrow_exception(readError);
+    }
+}
+
+/**
+ * Waits for the workers and closes all registered streams.
+ */
+void MPEG2ParallelDemultiplexer::close() {
+    flushDeferred();
+    stopWorkers();
+    MPEG2Demultiplexer::close();
+}
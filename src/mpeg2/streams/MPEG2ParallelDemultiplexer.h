@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2ParallelDemultiplexer.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro rozdělování packetů podle PID ve více vláknech.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2ParallelDemultiplexer.h
+ *
+ * @brief Module which routes packets by their PID in the several threads.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2PARALLELDEMULTIPLEXER_H
+#define MPEG2PARALLELDEMULTIPLEXER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+#include "MPEG2Demultiplexer.h"
+#include "../../threads/SPSCQueue.h"
+
+/**
+ * Demultiplexer which processes the input stream in the pipeline. Reader thread
+ * reads the packets in batches, the thread which calls run() routes them by PID
+ * and the service streams (video and audio) are processed by the worker threads.
+ * Every service stream is bound to one worker, so its packets stay in order.
+ * Section streams and counting streams are processed directly by the router,
+ * because they decide about the routing. Packets are copied only once by the reader,
+ * workers get views into the read batch which is reused when all of them release it.
+ */
+class MPEG2ParallelDemultiplexer : public MPEG2Demultiplexer {
+public:
+    const static unsigned int BATCH_PACKETS         = 512;
+    const static unsigned int BATCHES_IN_FLIGHT     = 8;
+
+    MPEG2ParallelDemultiplexer(MPEG2InputStream &is, unsigned int threads);
+    virtual ~MPEG2ParallelDemultiplexer();
+
+    virtual void addStream(shared_ptr<PacketStream> stream) override;
+    virtual void run() override;
+    virtual void close() override;
+
+    unsigned int workersCount() const;
+
+protected:
+    /**
+     * Batch of the packets read from the input. It is reused by the reader
+     * when the router and all workers which got its packets have released it.
+     */
+    struct ReadBatch {
+        ReadBatch() : users(0), last(false) {}
+
+        void clear() {
+            packets.clear();
+            frameNumbers.clear();
+            last = false;
+        }
+
+        vector<MPEG2Packet> packets;
+        vector<long> frameNumbers;
+        atomic<unsigned int> users;
+        bool last;
+    };
+
+    /**
+     * Batch of the packets which is passed to the worker.
+     */
+    struct PacketBatch {
+        PacketBatch() : source(0), last(false) {}
+
+        void clear() {
+            packets.clear();
+            copies.clear();
+            streams.clear();
+            frameNumbers.clear();
+            source = 0;
+            last = false;
+        }
+
+        vector<MPEG2PacketView> packets;    // views into the source or into the copies
+        vector<MPEG2Packet> copies;         // packets which are not in any read batch
+        vector<PacketStream *> streams;
+        vector<long> frameNumbers;
+        ReadBatch *source;                  // read batch which is held by this batch
+        bool last;
+    };
+
+    /**
+     * Worker thread with its queues of the batches.
+     */
+    struct Worker {
+        Worker() : queue(BATCHES_IN_FLIGHT), freeBatches(BATCHES_IN_FLIGHT), batches(BATCHES_IN_FLIGHT), pending(0) {}
+
+        SPSCQueue<PacketBatch *> queue;
+        SPSCQueue<PacketBatch *> freeBatches;
+        vector<PacketBatch> batches;
+        PacketBatch *pending;
+        thread workerThread;
+    };
+
+    vector<unique_ptr<Worker> > workers;
+    Worker *pidWorkers[PID_COUNT];
+    unsigned int nextWorker;
+    bool workersRunning;
+    vector<ReadBatch> readBatches;          // outlive run(), workers may still read them
+    unsigned int nextReadBatch;
+    ReadBatch *routedBatch;
+    long routedFrameNo;
+    atomic<bool> stopReading;
+    mutex errorMutex;
+
+    virtual void putPacket(PacketStream &stream, const MPEG2PacketView &packet) override;
+    virtual long currentFrameNo() override;
+    virtual void reportError(long frameNo, const exception &error) override;
+
+    ReadBatch *acquireReadBatch();
+    static void releaseReadBatch(ReadBatch *batch);
+    void readPackets(SPSCQueue<ReadBatch *> &fullBatches, exception_ptr &readError);
+    void processBatches(Worker &worker);
+    void flushWorker(Worker &worker, bool last);
+    void stopWorkers();
+};
+
+#endif // MPEG2PARALLELDEMULTIPLEXER_H
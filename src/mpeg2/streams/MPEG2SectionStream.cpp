@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2SectionStream.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro definující třídu výstupního streamu PSI sekcí.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2SectionStream.cpp
+ *
+ * @brief Module which implements class of the output stream of PSI sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <cstring>
+
+#include "MPEG2SectionStream.h"
+#include "../PSI/CRC32.h"
+#include "../PSI/TimeOffsetTable.h"
+
+/**
+ * Constructs new section stream.
+ * @param PID PID of the packets which carry the sections.
+ * @param callback Function which is called for every reassembled section.
+ * @param tableID Table ID of the demanded sections.
+ * @param tableIDMask Bits of the table ID which are compared, zero mask accepts all tables.
+ * @param cache Cache of the processed sections, it can be shared by more streams.
+ */
+MPEG2SectionStream::MPEG2SectionStream(uint16_t PID, SectionCallback callback, uint8_t tableID, uint8_t tableIDMask,
+                                       shared_ptr<SectionCache> cache)
+    : PacketStream(PID), sectionDataSize(0), sectionSize(0), sectionFiltered(false), previousContinuityCounter(-1),
+      tableID(tableID), tableIDMask(tableIDMask), crcErrors(0), callback(callback), cache(cache) {
+}
+
+/**
+ * @return Number of the sections which have been dropped because of the wrong CRC.
+ */
+unsigned long MPEG2SectionStream::invalidSections() const {
+    return crcErrors;
+}
+
+/**
+ * Callback method which is called when the whole section has been reassembled.
+ * @param table Reassembled section.
+ */
+void MPEG2SectionStream::onSectionRecieved(ServiceInformationTable &table) {
+    if (callback) {
+        callback(table);
+    }
+}
+
+/**
+ * Drops partially reassembled section.
+ */
+void MPEG2SectionStream::resetSection() {
+    sectionDataSize = 0;
+    sectionSize = 0;
+    sectionFiltered = false;
+}
+
+/**
+ * Tests whether the section ends by CRC_32 field. Sections with the long syntax
+ * have it always, from the short ones only TOT is protected.
+ * @return True if section has CRC, otherwise false.
+ */
+bool MPEG2SectionStream::hasCRC() const {
+    return (sectionData[1] & 0x80) || sectionData[0] == TimeOffsetTable::TOT_TABLE_ID;
+}
+
+/**
+ * Verifies the reassembled section and delivers it by the callback.
+ * Repeated sections are recognized by the cache before their CRC is computed,
+ * new and changed sections are announced by the cache before the delivery,
+ * section is remembered by the cache only when the callback has not failed.
+ */
+void MPEG2SectionStream::deliverSection() {
+    if (cache && cache->isUnchanged(PID, sectionData, sectionSize)) {
+        resetSection();
+        return;
+    }
+
+    if (hasCRC() && (sectionSize < ServiceInformationTable::PSI_HEADER_SIZE + ServiceInformationTable::PSI_CRC_SIZE ||
+                     !CRC32::isValid(sectionData, sectionSize))) {
+        crcErrors++;
+        resetSection();
+        return;
+    }
+
+    ServiceInformationTable table;
+    table.pid = PID;
+    table.tableID = sectionData[0];
+    table.sectionSyntaxIndicator = sectionData[1] & 0x80;
+    table.sectionLength = sectionSize - ServiceInformationTable::PSI_HEADER_SIZE;
+    table.section.assign(sectionData + ServiceInformationTable::PSI_HEADER_SIZE, sectionData + sectionSize);
+
+    // Change is announced before the consumer parses the section
+    if (cache) {
+        cache->notifyChange(PID, sectionData, sectionSize);
+    }
+
+    // Section is reset before the delivery, so the failure of the consumer does not break reading
+    unsigned int deliveredSize = sectionSize;
+    resetSection();
+    onSectionRecieved(table);
+
+    // Section which could not be parsed is not cached, so its repetition is parsed again
+    if (cache) {
+        cache->update(PID, sectionData, deliveredSize);
+    }
+}
+
+/**
+ * Appends data to the currently reassembled section. If the section is complete,
+ * then it is delivered by the callback. Body of the sections which do not pass
+ * the filter is not copied.
+ * @param data Data to be appended.
+ * @param size Size of the data.
+ * @return Number of the bytes which belong to the section, the rest belongs to the next section.
+ */
+unsigned int MPEG2SectionStream::appendSectionData(const uint8_t *data, unsigned int size) {
+    unsigned int consumed = 0;
+
+    /* Header of the section with its length */
+    while (sectionDataSize < ServiceInformationTable::PSI_HEADER_SIZE && consumed < size) {
+        // Rest of the packet is filled by stuffing bytes
+        if (sectionDataSize == 0 && data[consumed] == STUFFING_BYTE) {
+            resetSection();
+            return size;
+        }
+        sectionData[sectionDataSize++] = data[consumed++];
+    }
+
+    if (sectionDataSize < ServiceInformationTable::PSI_HEADER_SIZE) {
+        return consumed;
+    }
+
+    if (sectionSize == 0) {
+        sectionSize = ((sectionData[1] & 0x0F) << 8 | sectionData[2]) + ServiceInformationTable::PSI_HEADER_SIZE;
+
+        if (sectionSize > SECTION_MAXSIZE || sectionSize <= ServiceInformationTable::PSI_HEADER_SIZE) {
+            resetSection();
+            throw runtime_error ("Invalid length of the section!");
+        }
+
+        sectionFiltered = (sectionData[0] & tableIDMask) == (tableID & tableIDMask);
+    }
+
+    /* Body of the section */
+    unsigned int count = min(size - consumed, sectionSize - sectionDataSize);
+    if (sectionFiltered) {
+        memcpy(sectionData + sectionDataSize, data + consumed, count);
+    }
+    sectionDataSize += count;
+    consumed += count;
+
+    if (sectionDataSize == sectionSize) {
+        if (sectionFiltered) {
+            deliverSection();
+        } else {
+            resetSection();
+        }
+    }
+
+    return consumed;
+}
+
+/**
+ * Inserts new packet into the stream and reassembles sections from its payload.
+ * @param packet Packet which carries PSI section.
+ * @return Reference to the stream.
+ */
+PacketStream &MPEG2SectionStream::put(const MPEG2PacketView &packet) {
+    PacketStream::put(packet);
+
+    // Drop the section when packet probably belongs to it and is corrupted
+    if (packet.transportErrorIndicator()) {
+        resetSection();
+        previousContinuityCounter = -1;
+        return *this;
+    }
+
+    // Continue if packet does not transfer anything useful for us
+    unsigned int payloadSize = packet.payloadSize();
+    if (payloadSize == 0) {
+        return *this;
+    }
+
+    // Drop the section when some packet has been lost
+    int newContinuityCounter = (previousContinuityCounter + 1) % MPEG2Header::CONTINUITY_COUTER_SIZE;
+    if (previousContinuityCounter != -1 && packet.continuityCounter() != newContinuityCounter) {
+        resetSection();
+    }
+    previousContinuityCounter = packet.continuityCounter();
+
+    const uint8_t *pData = packet.payload();
+    const uint8_t *pEnd = pData + payloadSize;
+
+    /* Packet starts new section, the bytes before it finish the previous one */
+    if (packet.payloadUnitStartIndicator()) {
+        uint8_t pointerField = pData[0];
+
+        // Test for length malformation
+        if ((unsigned)(pointerField + 1) >= payloadSize) {
+            resetSection();
+            throw runtime_error ("Pointer field points after the packet end!");
+        }
+
+        if (sectionDataSize > 0) {
+            appendSectionData(&pData[1], pointerField);
+        }
+        resetSection();
+
+        // More sections can follow one after another until the stuffing
+        for (pData += pointerField + 1; pData < pEnd; ) {
+            pData += appendSectionData(pData, pEnd - pData);
+        }
+    }
+    /* Body packets of the section, or trash of the previous section */
+    else if (sectionDataSize > 0) {
+        appendSectionData(pData, payloadSize);
+    }
+
+    return *this;
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          MPEG2SectionStream.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul pro definující třídu výstupního streamu PSI sekcí.
+ *
+ ******************************************************************************/
+
+/**
+ * @file MPEG2SectionStream.h
+ *
+ * @brief Module which implements class of the output stream of PSI sections.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef MPEG2SECTIONSTREAM_H
+#define MPEG2SECTIONSTREAM_H
+
+#include <functional>
+
+#include "MPEG2PacketStream.h"
+#include "../PSI/ServiceInformationTable.h"
+#include "../PSI/SectionCache.h"
+
+/**
+ * Filter which reassembles PSI sections from the packets of one PID. Only sections
+ * whose table ID matches the filter are collected, sections are reassembled into
+ * preallocated buffer and their CRC is verified before they are delivered.
+ * Sections which are already in the cache of the stream are not delivered again.
+ */
+class MPEG2SectionStream : public PacketStream {
+public:
+    typedef function<void (ServiceInformationTable &)> SectionCallback;
+
+    MPEG2SectionStream(uint16_t PID, SectionCallback callback, uint8_t tableID = 0x00, uint8_t tableIDMask = 0x00,
+                       shared_ptr<SectionCache> cache = shared_ptr<SectionCache>());
+
+    unsigned long invalidSections() const;
+
+protected:
+    const unsigned int static SECTION_MAXSIZE       = 4096;
+    const uint8_t static STUFFING_BYTE              = 0xFF;
+
+    uint8_t sectionData[SECTION_MAXSIZE];
+    unsigned int sectionDataSize;
+    unsigned int sectionSize;
+    bool sectionFiltered;
+    int previousContinuityCounter;
+    uint8_t tableID;
+    uint8_t tableIDMask;
+    unsigned long crcErrors;
+    SectionCallback callback;
+    shared_ptr<SectionCache> cache;
+
+    virtual void onSectionRecieved(ServiceInformationTable &table);
+    virtual PacketStream &put(const MPEG2PacketView &packet) override;
+
+    void resetSection();
+    unsigned int appendSectionData(const uint8_t *data, unsigned int size);
+    void deliverSection();
+    bool hasCRC() const;
+};
+
+#endif // MPEG2SECTIONSTREAM_H
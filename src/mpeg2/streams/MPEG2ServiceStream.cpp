@@ -21,9 +21,13 @@
 #include "MPEG2ServiceStream.h"
 
 /**
- * Callback method which is called when new chunk of packets is available
+ * Callback method which is called when whole PES packet has been assembled,
+ * it is called only if the packet callback is set.
+ * @param packet Assembled packet, its data are valid only during the call.
  */
-void MPEG2ServiceStream::onPacketRecieved(const PacketElementaryStream &) {}
+void MPEG2ServiceStream::onPacketRecieved(const PacketElementaryStream &packet) {
+    packetCallback(packet);
+}
 
 /**
  * Callback method which is called when new fragment is available
@@ -35,41 +39,59 @@ void MPEG2ServiceStream::onFragmentRecieved(const PacketElementaryStreamFragment
  * @param packet Service packet.
  * @return Reference to the stream.
  */
-PacketStream &MPEG2ServiceStream::put(const MPEG2Packet &packet) {
+PacketStream &MPEG2ServiceStream::put(const MPEG2PacketView &packet) {
     PacketStream::put(packet);
 
-    const PacketElementaryStreamFragment fragment = PacketElementaryStreamFragment::fromMPEG2Packet(packet);
-    bool isStart = fragment.header->payloadUnitStartIndicator;
-    started = (started)? started : isStart;
-
-    /*if (fragment.header->PID == 0x101 && isStart) {
-        int a = 5;
-    } else if (fragment.header->PID == 0x101 && fragment.header->adaptationFieldControl == AdaptationFieldControl::AdaptationFieldOnly) {
-        int b = 5;
-        b = 1;
-    }*/
-
+    const PacketElementaryStreamFragment fragment(packet);
     onFragmentRecieved(fragment);
 
-    if (started) {
-        if (isStart && !fragments.empty()) {
-            PacketElementaryStream packetStream(fragments);
-            fragments.clear();
+    if (!packetCallback) {
+        return *this;
+    }
 
-            onPacketRecieved(packetStream);
+    /* Packet of the unknown length ends with the start of the next one */
+    if (packet.payloadUnitStartIndicator()) {
+        if (assembler.pending()) {
+            onPacketRecieved(assembler.packet());
         }
+        assembler.start(fragment);
+    } else {
+        assembler.append(fragment);
+    }
 
-        fragments.push_back(fragment);
+    if (assembler.complete()) {
+        onPacketRecieved(assembler.packet());
+        assembler.reset();
     }
 
     return *this;
 }
 
+/**
+ * Sets function which is called for every assembled PES packet. Packets are
+ * assembled only while the callback is set.
+ * @param callback Function which consumes the packets, empty function stops the assembly.
+ */
+void MPEG2ServiceStream::setPacketCallback(PacketCallback callback) {
+    packetCallback = callback;
+    assembler.reset();
+}
+
+/**
+ * Delivers the last packet of the unknown length, it is ended by the end of the stream.
+ */
+void MPEG2ServiceStream::close() {
+    if (packetCallback && assembler.pending()) {
+        onPacketRecieved(assembler.packet());
+    }
+    assembler.reset();
+}
+
 /**
  * Constructs new service stream with the passed PID
  * @param PID PID of the service stream
  */
 MPEG2ServiceStream::MPEG2ServiceStream(uint16_t PID)
-    : PacketStream(PID), started(false) {
+    : PacketStream(PID) {
 
 }
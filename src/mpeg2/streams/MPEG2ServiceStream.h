@@ -21,23 +21,31 @@
 #ifndef MPEG2SERVICESTREAM_H
 #define MPEG2SERVICESTREAM_H
 
+#include <functional>
+
 #include "MPEG2PacketStream.h"
-#include "../PES/PacketElementaryStream.h"
+#include "../PES/PacketElementaryStreamAssembler.h"
 
 /**
- * Class for streaming packets into output stream.
+ * Class for streaming packets into output stream. Whole PES packets are assembled
+ * only when the packet callback is set, otherwise only the fragments are delivered.
  */
 class MPEG2ServiceStream : public PacketStream {
+public:
+    typedef function<void (const PacketElementaryStream &packet)> PacketCallback;
 protected:
-    vector<PacketElementaryStreamFragment> fragments;
-    bool started;
+    PacketElementaryStreamAssembler assembler;
+    PacketCallback packetCallback;
 
-    virtual void onPacketRecieved(const PacketElementaryStream &);
+    virtual void onPacketRecieved(const PacketElementaryStream &packet);
     virtual void onFragmentRecieved(const PacketElementaryStreamFragment &streamFragment);
-    virtual PacketStream &put(const MPEG2Packet &packet);
+    virtual PacketStream &put(const MPEG2PacketView &packet);
 public:
     MPEG2ServiceStream(uint16_t PID);
 
+    void setPacketCallback(PacketCallback callback);
+    virtual void close() override;
+
     virtual void open(string &filename) = 0;
     virtual bool operator!(void) const = 0;
 };
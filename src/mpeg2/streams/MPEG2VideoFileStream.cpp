@@ -22,15 +22,6 @@
 
 #include "MPEG2VideoFileStream.h"
 
-/**
- * Callback method that is called by service base class - delivers PES packet.
- * Appending of the data into file is done here.
- * @param packetStream Video stream.
- */
-void MPEG2VideoFileStream::onPacketRecieved(const PacketElementaryStream &) {
-    //writeBuff(packetStream.streamData);
-}
-
 /**
  * Callback method that is called by service base class - delivers recieved fragment.
  * Appending of the data into file is done here.
@@ -38,36 +29,37 @@ void MPEG2VideoFileStream::onPacketRecieved(const PacketElementaryStream &) {
  */
 void MPEG2VideoFileStream::onFragmentRecieved(const PacketElementaryStreamFragment &streamFragment) {
     if (!sequenceHeaderFound) {
-        auto it = search(streamFragment.streamData.begin(), streamFragment.streamData.end(), PacketElementaryStream::PES_DATA_HEADER_SEQUENCE.begin(), PacketElementaryStream::PES_DATA_HEADER_SEQUENCE.end());
-        sequenceHeaderFound = it != streamFragment.streamData.end();
+        const uint8_t *end = streamFragment.data + streamFragment.size;
+        const uint8_t *it = search(streamFragment.data, end, PacketElementaryStream::PES_DATA_HEADER_SEQUENCE.begin(), PacketElementaryStream::PES_DATA_HEADER_SEQUENCE.end());
+        sequenceHeaderFound = it != end;
 
         if (sequenceHeaderFound) {
-            vector<uint8_t> data(it, streamFragment.streamData.end());
-            writeBuff(data);
+            writeBuff(it, end - it);
         }
     } else {
-        writeBuff(streamFragment.streamData);
+        writeBuff(streamFragment.data, streamFragment.size);
     }
 }
 
 /**
  * Appends data into buffer. If buffer is full, then writes into the file.
  * @param data Data to be appended to the buffer.
+ * @param size Size of the data.
  */
-void MPEG2VideoFileStream::writeBuff(const vector<uint8_t> &data) {
+void MPEG2VideoFileStream::writeBuff(const uint8_t *data, size_t size) {
     /* Buffer is full, flush the buffer. */
-    if (_outputBufferPosition + data.size() > OUTPUT_BUFFER_SIZE) {
+    if (_outputBufferPosition + size > OUTPUT_BUFFER_SIZE) {
         flush();
     }
 
     /* Size of the buffer is not sufficient, save buffer to the file. */
-    if (data.size() > OUTPUT_BUFFER_SIZE) {
-        write(data, data.size());
+    if (size > OUTPUT_BUFFER_SIZE) {
+        write(data, size);
     }
     /* SIze of buffer is sufficient, store data inside it. */
     else {
-        copy(data.begin(), data.end(), &_outputBuffer[_outputBufferPosition]);
-        _outputBufferPosition += data.size();
+        copy(data, data + size, &_outputBuffer[_outputBufferPosition]);
+        _outputBufferPosition += size;
     }
 
 }
@@ -77,8 +69,8 @@ void MPEG2VideoFileStream::writeBuff(const vector<uint8_t> &data) {
  * @param data Data to be added to the file.
  * @param size Size of the data.
  */
-void MPEG2VideoFileStream::write(const vector<uint8_t> &data, int size) {
-    output.write((char *)&data[0], size);
+void MPEG2VideoFileStream::write(const uint8_t *data, size_t size) {
+    output.write((const char *)data, size);
 }
 
 /**
@@ -100,16 +92,17 @@ void MPEG2VideoFileStream::open(string &filename) {
  * Closes video file stream
  */
 void MPEG2VideoFileStream::close() {
+    MPEG2ServiceStream::close();
     flush();
     output.close();
 }
 
 /**
  * Tests if video stream is opened and correctly
- * @return True, if stream is good, otherwise false.
+ * @return True, if stream has failed, otherwise false.
  */
 bool MPEG2VideoFileStream::operator!(void) const {
-    return output;
+    return !output.good();
 }
 
 /**
@@ -117,7 +110,7 @@ bool MPEG2VideoFileStream::operator!(void) const {
  */
 void MPEG2VideoFileStream::flush() {
     if (_outputBufferPosition > 0) {
-        write(_outputBuffer, _outputBufferPosition);
+        write(_outputBuffer.data(), _outputBufferPosition);
     }
     _outputBufferPosition = 0;
 }
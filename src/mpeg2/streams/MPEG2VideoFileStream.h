@@ -30,10 +30,9 @@
  */
 class MPEG2VideoFileStream : public MPEG2ServiceStream {
 protected:
-    virtual void onPacketRecieved(const PacketElementaryStream &packetStream) override;
     virtual void onFragmentRecieved(const PacketElementaryStreamFragment &streamFragment) override;
-    void writeBuff(const vector<uint8_t> &data);
-    void write(const vector<uint8_t> &data, int size);
+    void writeBuff(const uint8_t *data, size_t size);
+    void write(const uint8_t *data, size_t size);
 
     vector<uint8_t> _outputBuffer;
     int _outputBufferPosition;
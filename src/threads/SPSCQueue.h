@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          SPSCQueue.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul s frontou bez zámků pro jednoho producenta a konzumenta.
+ *
+ ******************************************************************************/
+
+/**
+ * @file SPSCQueue.h
+ *
+ * @brief Module with the lock-free queue for one producer and one consumer.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Bounded lock-free queue which can be used by one producer thread
+ * and one consumer thread at the same time. Blocking operations spin
+ * for a while and then sleep, so waiting threads do not burn the CPU.
+ */
+template <class T>
+class SPSCQueue {
+public:
+    /**
+     * Constructs queue.
+     * @param capacity Capacity of the queue, it is rounded up to the power of two.
+     */
+    SPSCQueue(size_t capacity) : head(0), tail(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        items.resize(size);
+        mask = size - 1;
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /**
+     * Inserts item if the queue is not full, called only by the producer.
+     * @param item Item to be inserted.
+     * @return True if item has been inserted, false if queue is full.
+     */
+    bool tryPush(const T &item) {
+        size_t currTail = tail.load(memory_order_relaxed);
+        if (currTail - head.load(memory_order_acquire) > mask) {
+            return false;
+        }
+
+        items[currTail & mask] = item;
+        tail.store(currTail + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes item if the queue is not empty, called only by the consumer.
+     * @param item Removed item.
+     * @return True if item has been removed, false if queue is empty.
+     */
+    bool tryPop(T &item) {
+        size_t currHead = head.load(memory_order_relaxed);
+        if (currHead == tail.load(memory_order_acquire)) {
+            return false;
+        }
+
+        item = items[currHead & mask];
+        head.store(currHead + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * Inserts item, waits while the queue is full.
+     * @param item Item to be inserted.
+     */
+    void push(const T &item) {
+        for (unsigned int spins = 0; !tryPush(item); spins++) {
+            backoff(spins);
+        }
+    }
+
+    /**
+     * Removes item, waits while the queue is empty.
+     * @return Removed item.
+     */
+    T pop() {
+        T item;
+        for (unsigned int spins = 0; !tryPop(item); spins++) {
+            backoff(spins);
+        }
+        return item;
+    }
+
+    /**
+     * Waits before next attempt.
+     * @param spins Number of the unsuccessful attempts.
+     */
+    static void backoff(unsigned int spins) {
+        if (spins < SPIN_LIMIT) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(SLEEP_MICROSECONDS));
+        }
+    }
+
+protected:
+    const static unsigned int SPIN_LIMIT        = 64;
+    const static unsigned int SLEEP_MICROSECONDS = 50;
+    const static unsigned int CACHE_LINE_SIZE   = 64;
+
+    // Indexes are kept in the separate cache lines, so producer and consumer do not share them
+    vector<T> items;
+    size_t mask;
+    char headPadding[CACHE_LINE_SIZE];
+    atomic<size_t> head;
+    char tailPadding[CACHE_LINE_SIZE - sizeof(atomic<size_t>)];
+    atomic<size_t> tail;
+};
+
+// Constant is bound to the reference by chrono::duration, so it needs the definition
+template <class T>
+const unsigned int SPSCQueue<T>::SLEEP_MICROSECONDS;
+
+#endif // SPSCQUEUE_H
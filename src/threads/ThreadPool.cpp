@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          ThreadPool.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul se skupinou vláken, která si mezi sebou kradou úlohy.
+ *
+ ******************************************************************************/
+
+/**
+ * @file ThreadPool.cpp
+ *
+ * @brief Module with the pool of the threads which steal tasks from each other.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * Pool which owns the current thread and the index of the queue of the thread in it,
+ * threads outside of any pool have none. Pools may be nested, so the queue is used
+ * only by its own pool.
+ */
+static thread_local const ThreadPool *currentPool = 0;
+static thread_local int currentQueue = -1;
+
+/**
+ * Constructs pool and starts its threads.
+ * @param threads Number of the threads, number of the hardware threads is used if it is zero.
+ */
+ThreadPool::ThreadPool(unsigned int threads)
+    : queuedTasks(0), unfinishedTasks(0), nextQueue(0), stopping(false)
+{
+    if (threads == 0) {
+        threads = hardwareThreads();
+    }
+
+    for (unsigned int i = 0; i < threads; i++) {
+        queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+
+    for (unsigned int i = 0; i < threads; i++) {
+        this->threads.push_back(thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+/**
+ * Finishes all submitted tasks and stops the threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        unique_lock<mutex> lock(stateMutex);
+        tasksFinished.wait(lock, [this] { return unfinishedTasks == 0; });
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (thread &worker : threads) {
+        worker.join();
+    }
+}
+
+/**
+ * @return Number of the threads which can run concurrently on this machine, at least one.
+ */
+unsigned int ThreadPool::hardwareThreads() {
+    unsigned int threads = thread::hardware_concurrency();
+    return (threads > 0)? threads : 1;
+}
+
+/**
+ * @return Number of the threads of the pool.
+ */
+unsigned int ThreadPool::threadsCount() const {
+    return threads.size();
+}
+
+/**
+ * Submits the task, tasks submitted from the pool thread are put into its own queue.
+ * @param task Task to be run.
+ */
+void ThreadPool::submit(Task task) {
+    unsigned int index;
+
+    // Counters are raised first, so they never drop below the number of the queued tasks
+    {
+        lock_guard<mutex> lock(stateMutex);
+        if (currentPool == this) {
+            index = currentQueue;
+        } else {
+            index = nextQueue++ % queues.size();
+        }
+        queuedTasks++;
+        unfinishedTasks++;
+    }
+
+    {
+        lock_guard<mutex> lock(queues[index]->queueMutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+/**
+ * Waits until all submitted tasks are finished.
+ * If some task has thrown an exception, the first one is rethrown.
+ */
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(stateMutex);
+    tasksFinished.wait(lock, [this] { return unfinishedTasks == 0; });
+
+    if (taskError) {
+        exception_ptr error = taskError;
+        taskError = exception_ptr();
+        rethrow_exception(error);
+    }
+}
+
+/**
+ * Takes the newest task from the own queue or steals the oldest task from other queue.
+ * @param index Index of the own queue.
+ * @param task Taken task.
+ * @return True if some task has been taken, otherwise false.
+ */
+bool ThreadPool::takeTask(unsigned int index, Task &task) {
+    {
+        lock_guard<mutex> lock(queues[index]->queueMutex);
+        if (!queues[index]->tasks.empty()) {
+            task = move(queues[index]->tasks.back());
+            queues[index]->tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (unsigned int i = 1; i < queues.size(); i++) {
+        WorkQueue &victim = *queues[(index + i) % queues.size()];
+        lock_guard<mutex> lock(victim.queueMutex);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Body of the pool thread, runs tasks until the pool is stopped.
+ * @param index Index of the queue owned by the thread.
+ */
+void ThreadPool::workerLoop(unsigned int index) {
+    currentPool = this;
+    currentQueue = index;
+
+    while (true) {
+        Task task;
+
+        {
+            unique_lock<mutex> lock(stateMutex);
+            taskAvailable.wait(lock, [this] { return queuedTasks > 0 || stopping; });
+            if (queuedTasks == 0 && stopping) {
+                return;
+            }
+        }
+
+        // Task may not be in the queue yet, or other thread was faster
+        if (!takeTask(index, task)) {
+            this_thread::yield();
+            continue;
+        }
+
+        {
+            lock_guard<mutex> lock(stateMutex);
+            queuedTasks--;
+        }
+
+        exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = current_exception();
+        }
+
+        {
+            lock_guard<mutex> lock(stateMutex);
+            if (error && !taskError) {
+                taskError = error;
+            }
+            if (--unfinishedTasks == 0) {
+                tasksFinished.notify_all();
+            }
+        }
+    }
+}
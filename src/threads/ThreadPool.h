@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          ThreadPool.h
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Mudul se skupinou vláken, která si mezi sebou kradou úlohy.
+ *
+ ******************************************************************************/
+
+/**
+ * @file ThreadPool.h
+ *
+ * @brief Module with the pool of the threads which steal tasks from each other.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+using namespace std;
+
+/**
+ * Pool of the threads, every thread has its own queue of the tasks. Thread takes
+ * the newest task from its own queue and when the queue is empty, it steals
+ * the oldest task from the queue of the other thread.
+ */
+class ThreadPool {
+public:
+    typedef function<void()> Task;
+
+    ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(Task task);
+    void wait();
+    unsigned int threadsCount() const;
+
+    static unsigned int hardwareThreads();
+
+protected:
+    /**
+     * Queue of the tasks owned by one thread.
+     */
+    struct WorkQueue {
+        mutex queueMutex;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<WorkQueue> > queues;
+    vector<thread> threads;
+
+    mutex stateMutex;
+    condition_variable taskAvailable;
+    condition_variable tasksFinished;
+    size_t queuedTasks;
+    size_t unfinishedTasks;
+    unsigned int nextQueue;
+    bool stopping;
+    exception_ptr taskError;
+
+    void workerLoop(unsigned int index);
+    bool takeTask(unsigned int index, Task &task);
+};
+
+#endif // THREADPOOL_H
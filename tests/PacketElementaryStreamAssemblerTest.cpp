@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * Projekt:         Projekt č.2: Demultiplexing transportního streamu DVB-T
+ * Předmět:         Bezdrátové a mobilní sítě
+ * Soubor:          PacketElementaryStreamAssemblerTest.cpp
+ * Datum:           Prosinec 2013
+ * Jméno:           Radim
+ * Příjmení:        Loskot
+ * Login autora:    xlosko01
+ * E-mail:          xlosko01(at)stud.fit.vutbr.cz
+ * Popis:           Test skládání PES packetů ve streamu služby
+ *
+ ******************************************************************************/
+
+/**
+ * @file PacketElementaryStreamAssemblerTest.cpp
+ *
+ * @brief Test of the PES packets assembled by the service stream.
+ * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
+ */
+
+#include <iostream>
+#include <vector>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "../src/mpeg2/streams/MPEG2ServiceStream.h"
+
+using namespace std;
+
+const static uint16_t TEST_PID = 0x100;
+
+/**
+ * Service stream which only delivers the packets.
+ */
+class TestServiceStream : public MPEG2ServiceStream {
+public:
+    TestServiceStream() : MPEG2ServiceStream(TEST_PID) {}
+
+    virtual void open(string &) {}
+    virtual bool operator!(void) const {
+        return false;
+    }
+};
+
+/**
+ * Assembled packet copied out of the callback.
+ */
+struct ReceivedPacket {
+    uint8_t streamID;
+    bool hasPTS;
+    uint64_t PTS;
+    vector<uint8_t> data;
+};
+
+int failures = 0;
+
+/**
+ * Reports failed check.
+ * @param condition Checked condition.
+ * @param message Description of the check.
+ */
+void check(bool condition, const char *message) {
+    if (!condition) {
+        cerr << "FAILED: " << message << endl;
+        failures++;
+    }
+}
+
+/**
+ * Builds MPEG2 packet which carries the payload only.
+ * @param start True if the payload starts PES packet.
+ * @param counter Continuity counter.
+ * @param payload Bytes of the payload, rest of the packet is filled by 0xFF.
+ * @param size Size of the payload.
+ * @return Bytes of the packet.
+ */
+vector<uint8_t> makePacket(bool start, uint8_t counter, const uint8_t *payload, size_t size) {
+    vector<uint8_t> packet(MPEG2PacketView::PACKET_SIZE, 0xFF);
+    packet[0] = 0x47;
+    packet[1] = (start? 0x40 : 0x00) | (TEST_PID >> 8);
+    packet[2] = TEST_PID & 0xFF;
+    packet[3] = 0x10 | (counter & 0x0F);
+    memcpy(&packet[MPEG2PacketView::HEADER_SIZE], payload, size);
+    return packet;
+}
+
+/**
+ * Splits the PES packet into MPEG2 packets and puts them into the stream.
+ * @param stream Stream of the service.
+ * @param pes Bytes of the whole PES packet.
+ * @param counter Continuity counter of the next packet.
+ */
+void putPES(TestServiceStream &stream, const vector<uint8_t> &pes, uint8_t &counter) {
+    for (size_t offset = 0; offset < pes.size(); offset += MPEG2PacketView::PAYLOAD_MAXSIZE) {
+        size_t size = min<size_t>(pes.size() - offset, MPEG2PacketView::PAYLOAD_MAXSIZE);
+        vector<uint8_t> packet = makePacket(offset == 0, counter++, &pes[offset], size);
+        stream << MPEG2PacketView(packet.data());
+    }
+}
+
+/**
+ * Builds PES packet with the optional header.
+ * @param streamID ID of the stream.
+ * @param PTS Presentation timestamp.
+ * @param payload Payload of the PES.
+ * @param bounded True if PES_packet_length is set, otherwise it is zero.
+ * @return Bytes of the PES packet.
+ */
+vector<uint8_t> makePES(uint8_t streamID, uint64_t PTS, const vector<uint8_t> &payload, bool bounded) {
+    uint8_t header[] = {
+        0x00, 0x00, 0x01, streamID, 0x00, 0x00,
+        0x80, 0x80, 0x05,
+        (uint8_t)(0x21 | ((PTS >> 29) & 0x0E)), (uint8_t)(PTS >> 22), (uint8_t)(0x01 | ((PTS >> 14) & 0xFE)), (uint8_t)(PTS >> 7), (uint8_t)(0x01 | ((PTS << 1) & 0xFE))
+    };
+
+    size_t packetLength = (bounded)? sizeof header - 6 + payload.size() : 0;
+    header[4] = packetLength >> 8;
+    header[5] = packetLength & 0xFF;
+
+    vector<uint8_t> pes(header, header + sizeof header);
+    pes.insert(pes.end(), payload.begin(), payload.end());
+    return pes;
+}
+
+/**
+ * Builds payload with the recognizable bytes.
+ * @param size Size of the payload.
+ * @param seed First byte of the payload.
+ * @return Payload.
+ */
+vector<uint8_t> makePayload(size_t size, uint8_t seed) {
+    vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; i++) {
+        payload[i] = (uint8_t)(seed + i);
+    }
+    return payload;
+}
+
+/**
+ * PES with the known length is delivered as soon as its last byte arrives,
+ * stuffing bytes of the last MPEG2 packet are not part of the span.
+ */
+void testBoundedPacket() {
+    TestServiceStream stream;
+    vector<ReceivedPacket> received;
+    stream.setPacketCallback([&received] (const PacketElementaryStream &packet) {
+        ReceivedPacket copy = { packet.PESHeader->streamID, packet.hasPTS(), packet.PTS(), vector<uint8_t>(packet.data, packet.data + packet.size) };
+        received.push_back(copy);
+    });
+
+    vector<uint8_t> payload = makePayload(300, 0x10);
+    uint8_t counter = 0;
+    putPES(stream, makePES(0xC0, 0x123456789ULL, payload, true), counter);
+
+    check(received.size() == 1, "bounded PES is delivered without the next start");
+    if (received.size() == 1) {
+        check(received[0].streamID == 0xC0, "bounded PES keeps its stream ID");
+        check(received[0].hasPTS && received[0].PTS == 0x123456789ULL, "bounded PES keeps its PTS");
+        check(received[0].data == payload, "bounded PES span equals its payload");
+    }
+
+    stream.close();
+    check(received.size() == 1, "completed PES is not delivered again on close");
+}
+
+/**
+ * Video PES with zero length is ended by the start of the next PES or by the end of the stream.
+ */
+void testUnboundedPacket() {
+    TestServiceStream stream;
+    vector<ReceivedPacket> received;
+    stream.setPacketCallback([&received] (const PacketElementaryStream &packet) {
+        ReceivedPacket copy = { packet.PESHeader->streamID, packet.hasPTS(), packet.PTS(), vector<uint8_t>(packet.data, packet.data + packet.size) };
+        received.push_back(copy);
+    });
+
+    vector<uint8_t> first = makePayload(3 * MPEG2PacketView::PAYLOAD_MAXSIZE - 14, 0x20);
+    vector<uint8_t> second = makePayload(1000, 0x40);
+    uint8_t counter = 0;
+
+    putPES(stream, makePES(0xE0, 3600, first, false), counter);
+    check(received.empty(), "unbounded PES waits for the next start");
+
+    putPES(stream, makePES(0xE0, 7200, second, false), counter);
+    check(received.size() == 1, "unbounded PES is ended by the next start");
+
+    stream.close();
+    check(received.size() == 2, "last unbounded PES is ended by close");
+    if (received.size() == 2) {
+        check(received[0].streamID == 0xE0 && received[0].PTS == 3600, "first video PES keeps its header");
+        check(received[0].data == first, "first video PES span equals its payload");
+        check(received[1].PTS == 7200, "second video PES keeps its header");
+        check(vector<uint8_t>(received[1].data.begin(), received[1].data.begin() + second.size()) == second, "second video PES span starts with its payload");
+    }
+}
+
+/**
+ * Stream without the packet callback does not assemble anything.
+ */
+void testWithoutCallback() {
+    TestServiceStream stream;
+    uint8_t counter = 0;
+    putPES(stream, makePES(0xC0, 0, makePayload(100, 0), true), counter);
+    stream.close();
+    check(stream.packetsInStream() == 1, "packets are counted without the callback");
+}
+
+int main() {
+    testBoundedPacket();
+    testUnboundedPacket();
+    testWithoutCallback();
+
+    if (failures > 0) {
+        cerr << failures << " checks failed!" << endl;
+        return EXIT_FAILURE;
+    }
+
+    cout << "All checks passed." << endl;
+    return EXIT_SUCCESS;
+}